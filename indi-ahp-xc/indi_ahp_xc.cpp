@@ -472,11 +472,156 @@ void AHP_XC::Callback()
                 idx++;
             }
         }
+
+        if(spectraEnabled())
+            addSpectra(packet);
     }
     EnableCapture(false);
     ahp_xc_free_packet(packet);
 }
 
+bool AHP_XC::spectraEnabled()
+{
+    return spectraS[0].s == ISS_ON;
+}
+
+/**************************************************************************************
+** Lag series to spectra, averaged over the last integrations
+***************************************************************************************/
+void AHP_XC::setupSpectra()
+{
+    std::lock_guard<std::mutex> lock(spectraMutex);
+    unsigned int integrations = static_cast<unsigned int>(spectraSettingsN[0].value);
+
+    autospectra.resize(ahp_xc_get_autocorrelator_lagsize() > 1 ? ahp_xc_get_nlines() : 0);
+    for(unsigned int x = 0; x < autospectra.size(); x++)
+        autospectra[x].setup(LagSpectrum::AUTOCORRELATION, ahp_xc_get_autocorrelator_lagsize(), integrations);
+    crossspectra.resize(ahp_xc_get_crosscorrelator_lagsize() > 1 ? ahp_xc_get_nbaselines() : 0);
+    for(unsigned int x = 0; x < crossspectra.size(); x++)
+        crossspectra[x].setup(LagSpectrum::CROSSCORRELATION, ahp_xc_get_crosscorrelator_lagsize() * 2 - 1, integrations);
+    spectraPackets = 0;
+    spectraSent = getCurrentTime();
+}
+
+void AHP_XC::addSpectra(ahp_xc_packet *packet)
+{
+    std::lock_guard<std::mutex> lock(spectraMutex);
+    std::vector<double> lags;
+
+    for(unsigned int x = 0; x < autospectra.size(); x++)
+    {
+        if(lineEnableSP[x].sp[0].s != ISS_ON)
+            continue;
+        lags.resize(packet->autocorrelations[x].lag_size);
+        for(unsigned int i = 0; i < packet->autocorrelations[x].lag_size; i++)
+            lags[i] = packet->autocorrelations[x].correlations[i].coherence;
+        autospectra[x].add(lags.data(), static_cast<unsigned int>(lags.size()));
+    }
+    int idx = 0;
+    for(unsigned int x = 0; x < ahp_xc_get_nlines(); x++)
+    {
+        for(unsigned int y = x + 1; y < ahp_xc_get_nlines(); y++)
+        {
+            if(static_cast<unsigned int>(idx) < crossspectra.size() && lineEnableSP[x].sp[0].s == ISS_ON &&
+                    lineEnableSP[y].sp[0].s == ISS_ON)
+            {
+                lags.resize(packet->crosscorrelations[idx].lag_size);
+                for(unsigned int i = 0; i < packet->crosscorrelations[idx].lag_size; i++)
+                    lags[i] = packet->crosscorrelations[idx].correlations[i].coherence;
+                crossspectra[idx].add(lags.data(), static_cast<unsigned int>(lags.size()));
+            }
+            idx++;
+        }
+    }
+    spectraPackets++;
+
+    // Publish at the client cadence, or once per full average when no interval is set
+    double interval = spectraSettingsN[1].value;
+    if(interval > 0 ? (getCurrentTime() - spectraSent >= interval) :
+            (spectraPackets >= static_cast<unsigned int>(spectraSettingsN[0].value)))
+    {
+        sendSpectra();
+        spectraPackets = 0;
+        spectraSent = getCurrentTime();
+    }
+}
+
+static void *spectrumToFits(const LagSpectrum &spectrum, bool phase, size_t *memsize)
+{
+    unsigned int bins = spectrum.getBins();
+    std::vector<double> values(bins * (phase ? 2 : 1));
+    spectrum.getAverage(values.data(), phase ? values.data() + bins : nullptr);
+
+    // Magnitude on the first row, phase in radians on the second one for cross spectra
+    dsp_stream_p stream = dsp_stream_new();
+    dsp_stream_add_dim(stream, static_cast<int>(bins));
+    dsp_stream_add_dim(stream, phase ? 2 : 1);
+    dsp_stream_alloc_buffer(stream, stream->len);
+    for(int i = 0; i < stream->len; i++)
+        stream->buf[i] = static_cast<dsp_t>(values[static_cast<unsigned int>(i)]);
+    *memsize = static_cast<unsigned int>(stream->len) * sizeof(double);
+    void *fits = dsp_file_write_fits(-64, memsize, stream);
+    dsp_stream_free_buffer(stream);
+    dsp_stream_free(stream);
+    return fits;
+}
+
+void AHP_XC::sendSpectra()
+{
+    unsigned int fftsize = 0;
+    unsigned int averaged = 0;
+
+    for(unsigned int x = 0; x < autospectra.size(); x++)
+    {
+        autospectraB[x].blob = nullptr;
+        autospectraB[x].bloblen = 0;
+        if(autospectra[x].getCount() == 0)
+            continue;
+        size_t memsize = 0;
+        autospectraB[x].blob = spectrumToFits(autospectra[x], false, &memsize);
+        autospectraB[x].bloblen = (autospectraB[x].blob != nullptr ? static_cast<int>(memsize) : 0);
+        autospectraB[x].size = autospectraB[x].bloblen;
+        fftsize = autospectra[x].getFFTSize();
+        averaged = autospectra[x].getCount();
+    }
+    for(unsigned int x = 0; x < crossspectra.size(); x++)
+    {
+        crossspectraB[x].blob = nullptr;
+        crossspectraB[x].bloblen = 0;
+        if(crossspectra[x].getCount() == 0)
+            continue;
+        size_t memsize = 0;
+        crossspectraB[x].blob = spectrumToFits(crossspectra[x], true, &memsize);
+        crossspectraB[x].bloblen = (crossspectraB[x].blob != nullptr ? static_cast<int>(memsize) : 0);
+        crossspectraB[x].size = crossspectraB[x].bloblen;
+        fftsize = crossspectra[x].getFFTSize();
+        averaged = crossspectra[x].getCount();
+    }
+    if(fftsize == 0)
+        return;
+
+    if(autospectra.size() > 0)
+    {
+        autospectraBP.s = IPS_OK;
+        IDSetBLOB(&autospectraBP, nullptr);
+    }
+    if(crossspectra.size() > 0)
+    {
+        crossspectraBP.s = IPS_OK;
+        IDSetBLOB(&crossspectraBP, nullptr);
+    }
+    for(unsigned int x = 0; x < autospectra.size(); x++)
+        free(autospectraB[x].blob);
+    for(unsigned int x = 0; x < crossspectra.size(); x++)
+        free(crossspectraB[x].blob);
+
+    // Bins go from DC to half the sampling frequency
+    spectraStatusN[0].value = static_cast<double>(ahp_xc_get_frequency() >> ahp_xc_get_frequency_divider()) / fftsize;
+    spectraStatusN[1].value = averaged;
+    spectraStatusNP.s = IPS_OK;
+    IDSetNumber(&spectraStatusNP, nullptr);
+}
+
 AHP_XC::AHP_XC()
 {
     clock_divider = 0;
@@ -486,8 +631,13 @@ AHP_XC::AHP_XC()
 
     autocorrelationsB = static_cast<IBLOB*>(malloc(1));
     crosscorrelationsB = static_cast<IBLOB*>(malloc(1));
+    autospectraB = static_cast<IBLOB*>(malloc(1));
+    crossspectraB = static_cast<IBLOB*>(malloc(1));
     plotB = static_cast<IBLOB*>(malloc(1));
 
+    spectraSent = 0.0;
+    spectraPackets = 0;
+
     lineStatsN = static_cast<INumber*>(malloc(1));
     lineStatsNP = static_cast<INumberVectorProperty*>(malloc(1));
 
@@ -583,6 +733,8 @@ bool AHP_XC::saveConfigItems(FILE *fp)
         }
     }
     IUSaveConfigNumber(fp, &settingsNP);
+    IUSaveConfigSwitch(fp, &spectraSP);
+    IUSaveConfigNumber(fp, &spectraSettingsNP);
 
     INDI::Spectrograph::saveConfigItems(fp);
     return true;
@@ -607,6 +759,21 @@ bool AHP_XC::initProperties()
     IUFillNumberVector(&settingsNP, settingsN, 3, getDeviceName(), "INTERFEROMETER_SETTINGS", "AHP_XC Settings",
                        MAIN_CONTROL_TAB, IP_RW, 60, IPS_IDLE);
 
+    IUFillSwitch(&spectraS[0], "SPECTRA_ON", "On", ISS_OFF);
+    IUFillSwitch(&spectraS[1], "SPECTRA_OFF", "Off", ISS_ON);
+    IUFillSwitchVector(&spectraSP, spectraS, 2, getDeviceName(), "SPECTRA_STREAM", "Stream spectra", "Spectra", IP_RW,
+                       ISR_1OFMANY, 60, IPS_IDLE);
+
+    IUFillNumber(&spectraSettingsN[0], "SPECTRA_INTEGRATIONS", "Averaged packets", "%.0f", 1, 10000, 1, 16);
+    IUFillNumber(&spectraSettingsN[1], "SPECTRA_INTERVAL", "Publish interval (s, 0 = per average)", "%g", 0, 3600, 0.1, 0);
+    IUFillNumberVector(&spectraSettingsNP, spectraSettingsN, 2, getDeviceName(), "SPECTRA_SETTINGS", "Spectra settings",
+                       "Spectra", IP_RW, 60, IPS_IDLE);
+
+    IUFillNumber(&spectraStatusN[0], "SPECTRA_BIN_WIDTH", "Bin width (Hz)", "%g", 0, 1.0E+12, 1, 0);
+    IUFillNumber(&spectraStatusN[1], "SPECTRA_AVERAGED", "Averaged packets", "%.0f", 0, 10000, 1, 0);
+    IUFillNumberVector(&spectraStatusNP, spectraStatusN, 2, getDeviceName(), "SPECTRA_STATUS", "Spectra status", "Spectra",
+                       IP_RO, 60, IPS_IDLE);
+
     // Set minimum exposure speed to 0.001 seconds
     setMinMaxStep("SENSOR_INTEGRATION", "SENSOR_INTEGRATION_VALUE", 1.0, STELLAR_DAY, 1, false);
     setDefaultPollingPeriod(500);
@@ -638,6 +805,16 @@ void AHP_XC::ISGetProperties(const char *dev)
             defineProperty(&crosscorrelationsBP);
         defineProperty(&correlationsNP);
         defineProperty(&settingsNP);
+        if(ahp_xc_get_autocorrelator_lagsize() > 1 || ahp_xc_get_crosscorrelator_lagsize() > 1)
+        {
+            defineProperty(&spectraSP);
+            defineProperty(&spectraSettingsNP);
+            defineProperty(&spectraStatusNP);
+        }
+        if(ahp_xc_get_autocorrelator_lagsize() > 1)
+            defineProperty(&autospectraBP);
+        if(ahp_xc_get_crosscorrelator_lagsize() > 1)
+            defineProperty(&crossspectraBP);
 
         // Define our properties
     }
@@ -668,6 +845,16 @@ bool AHP_XC::updateProperties()
             defineProperty(&crosscorrelationsBP);
         defineProperty(&correlationsNP);
         defineProperty(&settingsNP);
+        if(ahp_xc_get_autocorrelator_lagsize() > 1 || ahp_xc_get_crosscorrelator_lagsize() > 1)
+        {
+            defineProperty(&spectraSP);
+            defineProperty(&spectraSettingsNP);
+            defineProperty(&spectraStatusNP);
+        }
+        if(ahp_xc_get_autocorrelator_lagsize() > 1)
+            defineProperty(&autospectraBP);
+        if(ahp_xc_get_crosscorrelator_lagsize() > 1)
+            defineProperty(&crossspectraBP);
     }
     else
         // We're disconnected
@@ -678,6 +865,16 @@ bool AHP_XC::updateProperties()
             deleteProperty(crosscorrelationsBP.name);
         deleteProperty(correlationsNP.name);
         deleteProperty(settingsNP.name);
+        if(ahp_xc_get_autocorrelator_lagsize() > 1 || ahp_xc_get_crosscorrelator_lagsize() > 1)
+        {
+            deleteProperty(spectraSP.name);
+            deleteProperty(spectraSettingsNP.name);
+            deleteProperty(spectraStatusNP.name);
+        }
+        if(ahp_xc_get_autocorrelator_lagsize() > 1)
+            deleteProperty(autospectraBP.name);
+        if(ahp_xc_get_crosscorrelator_lagsize() > 1)
+            deleteProperty(crossspectraBP.name);
         for (unsigned int x = 0; x < ahp_xc_get_nlines(); x++)
         {
             deleteProperty(lineEnableSP[x].name);
@@ -786,6 +983,19 @@ bool AHP_XC::ISNewNumber(const char *dev, const char *name, double values[], cha
         return true;
     }
 
+    if(!strcmp(spectraSettingsNP.name, name))
+    {
+        std::lock_guard<std::mutex> lock(spectraMutex);
+        IUUpdateNumber(&spectraSettingsNP, values, names, n);
+        for(unsigned int x = 0; x < autospectra.size(); x++)
+            autospectra[x].setIntegrations(static_cast<unsigned int>(spectraSettingsN[0].value));
+        for(unsigned int x = 0; x < crossspectra.size(); x++)
+            crossspectra[x].setIntegrations(static_cast<unsigned int>(spectraSettingsN[0].value));
+        spectraSettingsNP.s = IPS_OK;
+        IDSetNumber(&spectraSettingsNP, nullptr);
+        return true;
+    }
+
     return true;
 }
 
@@ -823,6 +1033,21 @@ bool AHP_XC::ISNewSwitch(const char *dev, const char *name, ISState *states, cha
         }
     }
 
+    if(!strcmp(name, spectraSP.name))
+    {
+        std::lock_guard<std::mutex> lock(spectraMutex);
+        IUUpdateSwitch(&spectraSP, states, names, n);
+        for(unsigned int x = 0; x < autospectra.size(); x++)
+            autospectra[x].reset();
+        for(unsigned int x = 0; x < crossspectra.size(); x++)
+            crossspectra[x].reset();
+        spectraPackets = 0;
+        spectraSent = getCurrentTime();
+        spectraSP.s = (spectraS[0].s == ISS_ON ? IPS_BUSY : IPS_IDLE);
+        IDSetSwitch(&spectraSP, nullptr);
+        return true;
+    }
+
     for(unsigned int x = 0; x < ahp_xc_get_nbaselines(); x++)
         baselines[x]->ISNewSwitch(dev, name, states, names, n);
 
@@ -1060,6 +1285,12 @@ bool AHP_XC::Connect()
     if(ahp_xc_get_crosscorrelator_lagsize() > 1)
         crosscorrelationsB = static_cast<IBLOB*>(realloc(crosscorrelationsB,
                              static_cast<unsigned long>(ahp_xc_get_nbaselines()) * sizeof(IBLOB) + 1));
+    if(ahp_xc_get_autocorrelator_lagsize() > 1)
+        autospectraB = static_cast<IBLOB*>(realloc(autospectraB,
+                                           static_cast<unsigned long>(ahp_xc_get_nlines()) * sizeof(IBLOB) + 1));
+    if(ahp_xc_get_crosscorrelator_lagsize() > 1)
+        crossspectraB = static_cast<IBLOB*>(realloc(crossspectraB,
+                                            static_cast<unsigned long>(ahp_xc_get_nbaselines()) * sizeof(IBLOB) + 1));
     if(nplots > 0)
         plotB = static_cast<IBLOB*>(realloc(plotB, static_cast<unsigned long>(nplots) * sizeof(IBLOB) + 1));
 
@@ -1182,6 +1413,12 @@ bool AHP_XC::Connect()
             sprintf(label, "Autocorrelations%s", prefix);
             IUFillBLOB(&autocorrelationsB[x], name, label, ".fits");
         }
+        if(ahp_xc_get_autocorrelator_lagsize() > 1)
+        {
+            sprintf(name, "AUTOSPECTRUM_%02d", x + 1);
+            sprintf(label, "Spectrum (%d)", x + 1);
+            IUFillBLOB(&autospectraB[x], name, label, ".fits");
+        }
 
         for (unsigned int y = x + 1; y < ahp_xc_get_nlines(); y++)
         {
@@ -1193,6 +1430,10 @@ bool AHP_XC::Connect()
                     sprintf(prefix, "_%03d*%03d", x + 1, y + 1);
                 sprintf(label, "Crosscorrelations%s", prefix);
                 IUFillBLOB(&crosscorrelationsB[idx], name, label, ".fits");
+
+                sprintf(name, "CROSSSPECTRUM_%02d_%02d", x + 1, y + 1);
+                sprintf(label, "Cross spectrum (%d*%d)", x + 1, y + 1);
+                IUFillBLOB(&crossspectraB[idx], name, label, ".fits");
             }
             sprintf(name, "CORRELATIONS_%0d_%0d", x + 1, y + 1);
             sprintf(label, "Correlations (%d*%d)", x + 1, y + 1);
@@ -1211,6 +1452,13 @@ bool AHP_XC::Connect()
                          "CROSSCORRELATIONS", "Crosscorrelations", "Stats", IP_RO, 60, IPS_BUSY);
     IUFillNumberVector(&correlationsNP, correlationsN, static_cast<int>(ahp_xc_get_nbaselines() * 2), getDeviceName(),
                        "CORRELATIONS", "Correlations", "Stats", IP_RO, 60, IPS_BUSY);
+    if(ahp_xc_get_autocorrelator_lagsize() > 1)
+        IUFillBLOBVector(&autospectraBP, autospectraB, static_cast<int>(ahp_xc_get_nlines()), getDeviceName(),
+                         "AUTOSPECTRA", "Spectra", "Spectra", IP_RO, 60, IPS_IDLE);
+    if(ahp_xc_get_crosscorrelator_lagsize() > 1)
+        IUFillBLOBVector(&crossspectraBP, crossspectraB, static_cast<int>(ahp_xc_get_nbaselines()), getDeviceName(),
+                         "CROSSSPECTRA", "Cross spectra", "Spectra", IP_RO, 60, IPS_IDLE);
+    setupSpectra();
 
     // Start the timer
     SetTimer(getCurrentPollingPeriod());
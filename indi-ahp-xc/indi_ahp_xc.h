@@ -22,7 +22,9 @@
 
 #include "indispectrograph.h"
 #include "indicorrelator.h"
+#include "spectrum.h"
 #include <ahp/ahp_xc.h>
+#include <mutex>
 
 class baseline : public INDI::Correlator
 {
@@ -74,6 +76,8 @@ public:
 
         free(autocorrelationsB);
         free(crosscorrelationsB);
+        free(autospectraB);
+        free(crossspectraB);
         free(plotB);
 
         free(autocorrelations_str);
@@ -171,6 +175,28 @@ private:
     dsp_stream_p *crosscorrelations_str;
     dsp_stream_p *plot_str;
 
+    IBLOB *autospectraB;
+    IBLOBVectorProperty autospectraBP;
+
+    IBLOB *crossspectraB;
+    IBLOBVectorProperty crossspectraBP;
+
+    ISwitch spectraS[2];
+    ISwitchVectorProperty spectraSP;
+
+    INumber spectraSettingsN[2];
+    INumberVectorProperty spectraSettingsNP;
+
+    INumber spectraStatusN[2];
+    INumberVectorProperty spectraStatusNP;
+
+    // Rolling averaged spectra, filled by the read thread
+    std::vector<LagSpectrum> autospectra;
+    std::vector<LagSpectrum> crossspectra;
+    std::mutex spectraMutex;
+    double spectraSent;
+    unsigned int spectraPackets;
+
     INumber settingsN[3];
     INumberVectorProperty settingsNP;
 
@@ -190,6 +216,10 @@ private:
     void SetFrequencyDivider(unsigned char divider);
     void EnableCapture(bool start);
     void sendFile(IBLOB* Blobs, IBLOBVectorProperty BlobP, unsigned int len);
+    void setupSpectra();
+    void addSpectra(ahp_xc_packet *packet);
+    void sendSpectra();
+    bool spectraEnabled();
     int getFileIndex(const char * dir, const char * prefix, const char * ext);
     // Struct to keep timing
     struct timeval ExpStart;
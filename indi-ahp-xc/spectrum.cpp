@@ -0,0 +1,154 @@
+/*
+    indi_interferometer - a telescope array driver for INDI
+    Support for AHP cross-correlators
+    Copyright (C) 2020  Ilia Platone
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "spectrum.h"
+
+#include <algorithm>
+#include <cmath>
+
+void LagSpectrum::setup(Type type, unsigned int lags, unsigned int integrations)
+{
+    this->type = type;
+    this->lags = lags;
+
+    // Half width of the lag window, lag 0 included
+    unsigned int half = (type == AUTOCORRELATION ? lags : lags / 2 + 1);
+    fftsize = 1;
+    while (fftsize < half * 2)
+        fftsize <<= 1;
+
+    window.resize(half);
+    for (unsigned int k = 0; k < half; k++)
+        window[k] = 0.5 * (1.0 + cos(M_PI * k / half));
+
+    work.resize(fftsize);
+    sum.assign(fftsize / 2 + 1, 0.0);
+    history.clear();
+    setIntegrations(integrations);
+}
+
+void LagSpectrum::setIntegrations(unsigned int integrations)
+{
+    this->integrations = (integrations > 0 ? integrations : 1);
+    while (history.size() > this->integrations)
+    {
+        for (size_t i = 0; i < sum.size(); i++)
+            sum[i] -= history.front()[i];
+        history.pop_front();
+    }
+}
+
+void LagSpectrum::reset()
+{
+    history.clear();
+    sum.assign(sum.size(), 0.0);
+}
+
+void LagSpectrum::add(const double *lags, unsigned int len)
+{
+    if (fftsize == 0)
+        return;
+
+    unsigned int half = static_cast<unsigned int>(window.size());
+    std::fill(work.begin(), work.end(), 0.0);
+
+    // Place lag k at index k modulo fftsize so that lag 0 is the origin
+    if (type == AUTOCORRELATION)
+    {
+        for (unsigned int k = 0; k < half && k < len; k++)
+        {
+            work[k] = lags[k] * window[k];
+            if (k > 0)
+                work[fftsize - k] = work[k];
+        }
+    }
+    else
+    {
+        unsigned int center = this->lags / 2;
+        for (unsigned int i = 0; i < len && i < this->lags; i++)
+        {
+            int k = static_cast<int>(i) - static_cast<int>(center);
+            unsigned int a = static_cast<unsigned int>(std::abs(k));
+            if (a >= half)
+                continue;
+            work[(k + static_cast<int>(fftsize)) % fftsize] = lags[i] * window[a];
+        }
+    }
+
+    fft(work);
+
+    // Reuse the oldest spectrum storage once the average is full
+    std::vector<std::complex<double>> spectrum;
+    if (history.size() >= integrations)
+    {
+        spectrum = std::move(history.front());
+        history.pop_front();
+        for (size_t i = 0; i < sum.size(); i++)
+            sum[i] -= spectrum[i];
+    }
+    spectrum.assign(work.begin(), work.begin() + sum.size());
+    for (size_t i = 0; i < sum.size(); i++)
+        sum[i] += spectrum[i];
+    history.push_back(std::move(spectrum));
+}
+
+void LagSpectrum::getAverage(double *magnitude, double *phase) const
+{
+    double n = (history.empty() ? 1.0 : static_cast<double>(history.size()));
+    for (size_t i = 0; i < sum.size(); i++)
+    {
+        magnitude[i] = std::abs(sum[i]) / n;
+        if (phase != nullptr)
+            phase[i] = std::arg(sum[i]);
+    }
+}
+
+void LagSpectrum::fft(std::vector<std::complex<double>> &data)
+{
+    size_t n = data.size();
+
+    // Bit reversal permutation
+    for (size_t i = 1, j = 0; i < n; i++)
+    {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(data[i], data[j]);
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1)
+    {
+        std::complex<double> wlen = std::polar(1.0, -2.0 * M_PI / len);
+        for (size_t i = 0; i < n; i += len)
+        {
+            std::complex<double> w = 1.0;
+            for (size_t j = 0; j < len / 2; j++)
+            {
+                std::complex<double> u = data[i + j];
+                std::complex<double> v = data[i + j + len / 2] * w;
+                data[i + j] = u + v;
+                data[i + j + len / 2] = u - v;
+                w *= wlen;
+            }
+        }
+    }
+}
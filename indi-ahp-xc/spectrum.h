@@ -0,0 +1,71 @@
+/*
+    indi_interferometer - a telescope array driver for INDI
+    Support for AHP cross-correlators
+    Copyright (C) 2020  Ilia Platone
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#pragma once
+
+#include <complex>
+#include <deque>
+#include <vector>
+
+/**
+ * Turns correlator lag series into spectra (Wiener-Khinchin) and keeps a
+ * rolling average of the last integrations.
+ *
+ * Autocorrelation lags are one sided (lag 0 first) and mirrored before the
+ * transform, crosscorrelation lags are two sided with lag 0 in the middle.
+ * Lags are tapered with a Hann window and zero padded to a power of two.
+ * Spectra hold the non negative frequency bins only, from DC to half the
+ * sampling frequency: crosscorrelations are real so the negative half is the
+ * complex conjugate.
+ */
+class LagSpectrum
+{
+public:
+    enum Type
+    {
+        AUTOCORRELATION,
+        CROSSCORRELATION
+    };
+
+    void setup(Type type, unsigned int lags, unsigned int integrations);
+    void setIntegrations(unsigned int integrations);
+    void reset();
+
+    void add(const double *lags, unsigned int len);
+
+    unsigned int getBins() const { return static_cast<unsigned int>(sum.size()); }
+    unsigned int getCount() const { return static_cast<unsigned int>(history.size()); }
+    unsigned int getFFTSize() const { return fftsize; }
+
+    /// Averaged spectrum magnitude, and phase (radians) when not null
+    void getAverage(double *magnitude, double *phase = nullptr) const;
+
+private:
+    static void fft(std::vector<std::complex<double>> &data);
+
+    Type type { AUTOCORRELATION };
+    unsigned int lags { 0 };
+    unsigned int fftsize { 0 };
+    unsigned int integrations { 1 };
+    std::vector<double> window;
+    std::vector<std::complex<double>> work;
+    std::vector<std::complex<double>> sum;
+    std::deque<std::vector<std::complex<double>>> history;
+};
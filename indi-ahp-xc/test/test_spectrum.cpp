@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include "spectrum.h"
+
+#include <cmath>
+#include <vector>
+
+// Bin holding the largest magnitude between first and last
+static unsigned int peakBin(const std::vector<double> &magnitude, unsigned int first, unsigned int last)
+{
+    unsigned int peak = first;
+    for (unsigned int i = first; i <= last; i++)
+        if (magnitude[i] > magnitude[peak])
+            peak = i;
+    return peak;
+}
+
+TEST(LagSpectrumTest, autocorrelation_lines)
+{
+    const unsigned int lags = 64;
+    LagSpectrum spectrum;
+    spectrum.setup(LagSpectrum::AUTOCORRELATION, lags, 1);
+    ASSERT_EQ(spectrum.getFFTSize(), 128u);
+    ASSERT_EQ(spectrum.getBins(), 65u);
+
+    // Lines at 0.2 and 0.35 of the sampling frequency
+    std::vector<double> series(lags);
+    for (unsigned int k = 0; k < lags; k++)
+        series[k] = cos(2 * M_PI * 0.2 * k) + cos(2 * M_PI * 0.35 * k);
+    spectrum.add(series.data(), lags);
+
+    std::vector<double> magnitude(spectrum.getBins());
+    spectrum.getAverage(magnitude.data());
+
+    double binwidth = 1.0 / spectrum.getFFTSize();
+    ASSERT_NEAR(peakBin(magnitude, 1, 35) * binwidth, 0.2, binwidth);
+    ASSERT_NEAR(peakBin(magnitude, 36, 64) * binwidth, 0.35, binwidth);
+    // Far from both lines the Hann taper keeps leakage low
+    ASSERT_LT(magnitude[8], magnitude[peakBin(magnitude, 1, 35)] / 100);
+}
+
+TEST(LagSpectrumTest, crosscorrelation_phase)
+{
+    const unsigned int lags = 65;
+    const double f = 0.25, delay = 1.0;
+    LagSpectrum spectrum;
+    spectrum.setup(LagSpectrum::CROSSCORRELATION, lags, 4);
+
+    // Lag 0 in the middle, the second line lags the first by one sample
+    std::vector<double> series(lags);
+    for (unsigned int i = 0; i < lags; i++)
+        series[i] = cos(2 * M_PI * f * (static_cast<double>(i) - lags / 2 - delay));
+    spectrum.add(series.data(), lags);
+
+    std::vector<double> magnitude(spectrum.getBins()), phase(spectrum.getBins());
+    spectrum.getAverage(magnitude.data(), phase.data());
+
+    unsigned int bin = static_cast<unsigned int>(f * spectrum.getFFTSize());
+    ASSERT_EQ(peakBin(magnitude, 1, spectrum.getBins() - 1), bin);
+    ASSERT_NEAR(phase[bin], remainder(-2 * M_PI * f * delay, 2 * M_PI), 1e-9);
+}
+
+TEST(LagSpectrumTest, rolling_average)
+{
+    const unsigned int lags = 16;
+    LagSpectrum spectrum;
+    spectrum.setup(LagSpectrum::AUTOCORRELATION, lags, 3);
+
+    std::vector<double> series(lags, 0.0), magnitude(spectrum.getBins());
+    for (int n = 1; n <= 5; n++)
+    {
+        series[0] = n;
+        spectrum.add(series.data(), lags);
+    }
+    // Only the last three packets are averaged: (3 + 4 + 5) / 3
+    ASSERT_EQ(spectrum.getCount(), 3u);
+    spectrum.getAverage(magnitude.data());
+    ASSERT_NEAR(magnitude[0], 4.0, 1e-9);
+
+    spectrum.setIntegrations(1);
+    ASSERT_EQ(spectrum.getCount(), 1u);
+    spectrum.getAverage(magnitude.data());
+    ASSERT_NEAR(magnitude[0], 5.0, 1e-9);
+}
@@ -43,6 +43,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
 #include <zlib.h>
 
 #include <memory>
+#include <algorithm>
 
 #ifdef OSX_EMBEDED_MODE
 #include "Alta.h"
@@ -77,6 +78,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
 #define NFLUSHES                1    /* Number of times a CCD array is flushed before an exposure */
 #define TEMP_UPDATE_THRESHOLD   0.05
 #define COOLER_UPDATE_THRESHOLD 0.05
+#define SIDEREAL_RATE           15.041067 /* Sidereal rate (arcsec/s) */
+#define TDI_POLL_MS             250  /* Row polling period while drift scanning (ms) */
+#define TDI_TAB                 "Drift Scan"
 
 static std::unique_ptr<ApogeeCCD> apogeeCCD(new ApogeeCCD());
 
@@ -131,6 +135,24 @@ bool ApogeeCCD::initProperties()
     IUFillSwitchVector(&FanStatusSP, FanStatusS, 4, getDeviceName(), "CCD_FAN", "Fan", OPTIONS_TAB, IP_RW, ISR_1OFMANY,
                        0, IPS_IDLE);
 
+    // TDI Drift Scan
+    IUFillSwitch(&TDIModeS[TDI_OFF], "TDI_OFF", "Off", ISS_ON);
+    IUFillSwitch(&TDIModeS[TDI_ON], "TDI_ON", "On", ISS_OFF);
+    IUFillSwitchVector(&TDIModeSP, TDIModeS, 2, getDeviceName(), "CCD_TDI_MODE", "Drift Scan", TDI_TAB, IP_RW,
+                       ISR_1OFMANY, 0, IPS_IDLE);
+
+    IUFillNumber(&TDISettingsN[TDI_DEC], "TDI_DEC", "Dec (deg)", "%.2f", -90, 90, 1, 0);
+    IUFillNumber(&TDISettingsN[TDI_FOCAL_LENGTH], "TDI_FOCAL_LENGTH", "Focal Length (mm)", "%.f", 10, 20000, 100, 1000);
+    IUFillNumber(&TDISettingsN[TDI_ROWS], "TDI_ROWS", "Rows", "%.f", 1, 65535, 256, 4096);
+    IUFillNumber(&TDISettingsN[TDI_STRIP_ROWS], "TDI_STRIP_ROWS", "Rows per Strip", "%.f", 1, 65535, 64, 256);
+    IUFillNumberVector(&TDISettingsNP, TDISettingsN, 4, getDeviceName(), "CCD_TDI_SETTINGS", "Settings", TDI_TAB, IP_RW,
+                       0, IPS_IDLE);
+
+    IUFillNumber(&TDIStatusN[TDI_ROW_PERIOD], "TDI_ROW_PERIOD", "Row Period (s)", "%.5f", 0, 1, 0, 0);
+    IUFillNumber(&TDIStatusN[TDI_ROWS_READ], "TDI_ROWS_READ", "Rows Read", "%.f", 0, 65535, 0, 0);
+    IUFillNumberVector(&TDIStatusNP, TDIStatusN, 2, getDeviceName(), "CCD_TDI_STATUS", "Status", TDI_TAB, IP_RO,
+                       0, IPS_IDLE);
+
     // Filter Type
     IUFillSwitch(&FilterTypeS[TYPE_UNKNOWN], "TYPE_UNKNOWN", "No CFW", ISS_ON);
     IUFillSwitch(&FilterTypeS[TYPE_FW50_9R], "TYPE_FW50_9R", "FW50 9R", ISS_OFF);
@@ -176,6 +198,11 @@ bool ApogeeCCD::updateProperties()
         defineProperty(&FanStatusSP);
         getCameraParams();
 
+        TDIStatusN[TDI_ROW_PERIOD].value = tdiRowPeriod();
+        defineProperty(&TDIModeSP);
+        defineProperty(&TDISettingsNP);
+        defineProperty(&TDIStatusNP);
+
         if (cfwFound)
         {
             INDI::FilterInterface::updateProperties();
@@ -191,6 +218,9 @@ bool ApogeeCCD::updateProperties()
         deleteProperty(ReadOutSP.name);
         deleteProperty(CamInfoTP.name);
         deleteProperty(FanStatusSP.name);
+        deleteProperty(TDIModeSP.name);
+        deleteProperty(TDISettingsNP.name);
+        deleteProperty(TDIStatusNP.name);
 
         if (cfwFound)
         {
@@ -415,6 +445,25 @@ bool ApogeeCCD::ISNewSwitch(const char *dev, const char *name, ISState *states,
             return true;
         }
 
+        // TDI Drift Scan
+        if (!strcmp(name, TDIModeSP.name))
+        {
+            if (InExposure)
+            {
+                LOG_ERROR("Cannot change drift scan mode while exposure is in progress.");
+                TDIModeSP.s = IPS_ALERT;
+                IDSetSwitch(&TDIModeSP, nullptr);
+                return true;
+            }
+
+            IUUpdateSwitch(&TDIModeSP, states, names, n);
+            if (TDIModeS[TDI_ON].s == ISS_ON)
+                LOGF_INFO("Drift scan enabled. Rows are shifted every %.5f seconds, track must be off.", tdiRowPeriod());
+            TDIModeSP.s = IPS_OK;
+            IDSetSwitch(&TDIModeSP, nullptr);
+            return true;
+        }
+
         // Fan Speed
         if (!strcmp(name, FanStatusSP.name))
         {
@@ -497,6 +546,25 @@ bool ApogeeCCD::ISNewNumber(const char *dev, const char *name, double values[],
             INDI::FilterInterface::processNumber(dev, name, values, names, n);
             return true;
         }
+
+        if (!strcmp(name, TDISettingsNP.name))
+        {
+            if (tdiActive)
+            {
+                LOG_ERROR("Cannot change drift scan settings while scanning.");
+                TDISettingsNP.s = IPS_ALERT;
+                IDSetNumber(&TDISettingsNP, nullptr);
+                return true;
+            }
+
+            IUUpdateNumber(&TDISettingsNP, values, names, n);
+            TDISettingsNP.s = IPS_OK;
+            IDSetNumber(&TDISettingsNP, nullptr);
+
+            TDIStatusN[TDI_ROW_PERIOD].value = tdiRowPeriod();
+            IDSetNumber(&TDIStatusNP, nullptr);
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewNumber(dev, name, values, names, n);
@@ -504,6 +572,16 @@ bool ApogeeCCD::ISNewNumber(const char *dev, const char *name, double values[],
 
 bool ApogeeCCD::StartExposure(float duration)
 {
+    // Each strip completes an exposure, but the camera is still busy until the scan is done
+    if (tdiActive)
+    {
+        LOG_ERROR("Drift scan in progress, abort it before starting a new exposure.");
+        return false;
+    }
+
+    if (TDIModeS[TDI_ON].s == ISS_ON)
+        return startDriftScan();
+
     ExposureRequest = duration;
 
     imageFrameType = PrimaryCCD.getFrameType();
@@ -571,10 +649,226 @@ bool ApogeeCCD::AbortExposure()
         return false;
     }
 
+    if (tdiActive)
+        stopDriftScan();
+
     InExposure = false;
     return true;
 }
 
+double ApogeeCCD::tdiRowPeriod()
+{
+    // One unbinned row spans pixel / focal length, the sky drifts by sidereal rate * cos(dec)
+    double rowArcsec = PrimaryCCD.getPixelSizeY() / TDISettingsN[TDI_FOCAL_LENGTH].value * 206.265;
+    double drift     = SIDEREAL_RATE * cos(TDISettingsN[TDI_DEC].value * M_PI / 180.0);
+
+    if (drift < 1e-6)
+        return 0;
+
+    return rowArcsec / drift;
+}
+
+bool ApogeeCCD::startDriftScan()
+{
+    double period = tdiRowPeriod();
+    if (period <= 0)
+    {
+        LOG_ERROR("Drift scan is not possible at the celestial pole.");
+        return false;
+    }
+
+    uint16_t rows = static_cast<uint16_t>(TDISettingsN[TDI_ROWS].value);
+    int binY      = PrimaryCCD.getBinY();
+
+    try
+    {
+        if (isSimulation() == false)
+        {
+            // Rows are streamed one by one only with bulk download off
+            ApgCam->SetCameraMode(Apg::CameraMode_TDI);
+            ApgCam->SetBulkDownload(false);
+            ApgCam->SetTdiRate(period);
+            ApgCam->SetTdiBinningRows(binY);
+            ApgCam->SetTdiRows(rows);
+
+            // Camera clamps the rate to what it supports
+            double actual = ApgCam->GetTdiRate();
+            if (fabs(actual - period) > period * 0.01)
+                LOGF_WARN("Row period %.5f s is out of range, camera uses %.5f s. Stars will trail.", period, actual);
+            period = actual;
+
+            ApgCam->StartExposure(period, true);
+        }
+    }
+    catch (std::runtime_error &err)
+    {
+        LOGF_ERROR("Starting drift scan failed. %s.", err.what());
+        stopDriftScan();
+        return false;
+    }
+
+    // Strips are sent with the frame resized to the strip height, restored once done.
+    // No scan is running here, so the frame is still the one the client asked for.
+    tdiFrame[0] = PrimaryCCD.getSubX();
+    tdiFrame[1] = PrimaryCCD.getSubY();
+    tdiFrame[2] = PrimaryCCD.getSubW();
+    tdiFrame[3] = PrimaryCCD.getSubH();
+
+    tdiStrip.assign(static_cast<size_t>(TDISettingsN[TDI_STRIP_ROWS].value) * imageWidth, 0);
+    tdiRowsRead   = 0;
+    tdiStripStart = 0;
+    tdiActive     = true;
+
+    // Every pixel integrates while crossing the whole sensor
+    PrimaryCCD.setExposureDuration(PrimaryCCD.getYRes() * period);
+    ExposureRequest = rows * binY * period;
+    imageFrameType  = INDI::CCDChip::LIGHT_FRAME;
+
+    TDIStatusN[TDI_ROW_PERIOD].value = period;
+    TDIStatusN[TDI_ROWS_READ].value  = 0;
+    TDIStatusNP.s = IPS_BUSY;
+    IDSetNumber(&TDIStatusNP, nullptr);
+
+    gettimeofday(&ExpStart, nullptr);
+    LOGF_INFO("Drift scanning %u rows at %.5f s per row (%.1f seconds)...", rows, period, ExposureRequest);
+
+    InExposure = true;
+    return true;
+}
+
+void ApogeeCCD::readDriftScanRows()
+{
+    uint32_t total = static_cast<uint32_t>(TDISettingsN[TDI_ROWS].value);
+    uint32_t stripRows = static_cast<uint32_t>(TDISettingsN[TDI_STRIP_ROWS].value);
+    uint32_t available = 0;
+
+    if (isSimulation())
+    {
+        double elapsed = ExposureRequest - CalcTimeLeft(ExpStart, ExposureRequest);
+        available = static_cast<uint32_t>(elapsed / (TDIStatusN[TDI_ROW_PERIOD].value * PrimaryCCD.getBinY()));
+    }
+    else
+    {
+        // Counter is 16 bits wide, track it relative to what was read
+        uint16_t counter = ApgCam->GetTdiCounter();
+        available = tdiRowsRead + static_cast<uint16_t>(counter - static_cast<uint16_t>(tdiRowsRead));
+    }
+
+    available = std::min(available, total);
+
+    std::vector<uint16_t> row;
+    while (tdiRowsRead < available)
+    {
+        uint16_t *dest = tdiStrip.data() + static_cast<size_t>(tdiRowsRead - tdiStripStart) * imageWidth;
+
+        if (isSimulation())
+        {
+            // Sky background with a sparse fixed star field drifting through
+            for (int j = 0; j < imageWidth; j++)
+            {
+                uint32_t hash = (tdiRowsRead * 7919u) ^ (j * 104729u);
+                dest[j] = 1000 + rand() % 100 + ((hash % 4999) == 0 ? 30000 : 0);
+            }
+        }
+        else
+        {
+            ApgCam->GetImage(row);
+            std::copy(row.begin(), row.begin() + std::min<size_t>(row.size(), imageWidth), dest);
+        }
+
+        tdiRowsRead++;
+
+        if (tdiRowsRead - tdiStripStart == stripRows || tdiRowsRead == total)
+            sendDriftScanStrip();
+    }
+
+    if (TDIStatusN[TDI_ROWS_READ].value != tdiRowsRead)
+    {
+        TDIStatusN[TDI_ROWS_READ].value = tdiRowsRead;
+        IDSetNumber(&TDIStatusNP, nullptr);
+    }
+}
+
+void ApogeeCCD::sendDriftScanStrip()
+{
+    uint32_t rows = tdiRowsRead - tdiStripStart;
+    int binY      = PrimaryCCD.getBinY();
+
+    std::unique_lock<std::mutex> guard(ccdBufferLock);
+    if (PrimaryCCD.getSubH() != static_cast<int>(rows) * binY)
+    {
+        PrimaryCCD.setFrame(tdiFrame[0], tdiFrame[1], tdiFrame[2], rows * binY);
+        PrimaryCCD.setFrameBufferSize(rows * imageWidth * sizeof(uint16_t));
+    }
+    memcpy(PrimaryCCD.getFrameBuffer(), tdiStrip.data(), rows * imageWidth * sizeof(uint16_t));
+    guard.unlock();
+
+    LOGF_DEBUG("Sending drift scan rows %u to %u.", tdiStripStart, tdiRowsRead - 1);
+
+    bool last = tdiRowsRead >= static_cast<uint32_t>(TDISettingsN[TDI_ROWS].value);
+    if (last)
+    {
+        PrimaryCCD.setExposureLeft(0);
+        InExposure = false;
+    }
+
+    ExposureComplete(&PrimaryCCD);
+    tdiStripStart = tdiRowsRead;
+
+    if (last)
+    {
+        LOG_INFO("Drift scan complete.");
+        stopDriftScan();
+    }
+    else
+        PrimaryCCD.setExposureLeft(CalcTimeLeft(ExpStart, ExposureRequest));
+}
+
+void ApogeeCCD::stopDriftScan()
+{
+    tdiActive = false;
+
+    try
+    {
+        if (isSimulation() == false)
+        {
+            ApgCam->SetBulkDownload(true);
+            ApgCam->SetCameraMode(Apg::CameraMode_Normal);
+        }
+    }
+    catch (std::runtime_error &err)
+    {
+        LOGF_ERROR("Restoring normal mode failed. %s.", err.what());
+    }
+
+    // Back to the frame the client asked for
+    if (tdiFrame[3] > 0)
+    {
+        std::unique_lock<std::mutex> guard(ccdBufferLock);
+        PrimaryCCD.setFrame(tdiFrame[0], tdiFrame[1], tdiFrame[2], tdiFrame[3]);
+        PrimaryCCD.setFrameBufferSize(imageWidth * imageHeight * PrimaryCCD.getBPP() / 8);
+        tdiFrame[3] = 0;
+    }
+
+    TDIStatusNP.s = IPS_IDLE;
+    IDSetNumber(&TDIStatusNP, nullptr);
+}
+
+void ApogeeCCD::addFITSKeywords(fitsfile *fptr, INDI::CCDChip *targetChip)
+{
+    INDI::CCD::addFITSKeywords(fptr, targetChip);
+
+    if (tdiActive)
+    {
+        int status = 0;
+        double period = TDIStatusN[TDI_ROW_PERIOD].value;
+        int firstRow  = tdiStripStart;
+        fits_update_key_s(fptr, TDOUBLE, "TDIRATE", &period, "TDI row period (s)", &status);
+        fits_update_key_s(fptr, TINT, "TDIROW", &firstRow, "First drift scan row of this strip", &status);
+        fits_update_key_s(fptr, TDOUBLE, "TDIDEC", &TDISettingsN[TDI_DEC].value, "Drift scan declination (deg)", &status);
+    }
+}
+
 float ApogeeCCD::CalcTimeLeft(timeval start, float req)
 {
     double timesince;
@@ -1265,7 +1559,23 @@ void ApogeeCCD::TimerHit()
     if (isConnected() == false)
         return;
 
-    if (InExposure)
+    if (InExposure && tdiActive)
+    {
+        try
+        {
+            readDriftScanRows();
+            if (InExposure)
+                PrimaryCCD.setExposureLeft(std::max(0.0f, CalcTimeLeft(ExpStart, ExposureRequest)));
+        }
+        catch (std::runtime_error &err)
+        {
+            LOGF_ERROR("Reading drift scan rows failed. %s.", err.what());
+            PrimaryCCD.setExposureFailed();
+            InExposure = false;
+            stopDriftScan();
+        }
+    }
+    else if (InExposure)
     {
         timeleft = CalcTimeLeft(ExpStart, ExposureRequest);
 
@@ -1433,7 +1743,11 @@ void ApogeeCCD::TimerHit()
         }
     }
 
-    SetTimer(getCurrentPollingPeriod());
+    // Keep up with rows while drift scanning, the camera buffers only so many
+    if (tdiActive)
+        SetTimer(std::min<uint32_t>(TDI_POLL_MS, getCurrentPollingPeriod()));
+    else
+        SetTimer(getCurrentPollingPeriod());
     return;
 }
 
@@ -1451,6 +1765,8 @@ bool ApogeeCCD::saveConfigItems(FILE *fp)
     if (FanStatusSP.s != IPS_ALERT)
         IUSaveConfigSwitch(fp, &FanStatusSP);
 
+    IUSaveConfigNumber(fp, &TDISettingsNP);
+
     if (cfwFound)
     {
         INDI::FilterInterface::saveConfigItems(fp);
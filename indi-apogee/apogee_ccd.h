@@ -61,6 +61,7 @@ class ApogeeCCD : public INDI::CCD, public INDI::FilterInterface
 
         virtual void debugTriggered(bool enabled) override;
         virtual bool saveConfigItems(FILE *fp) override;
+        virtual void addFITSKeywords(fitsfile *fptr, INDI::CCDChip *targetChip) override;
 
         virtual bool SelectFilter(int) override;
         virtual int QueryFilter() override;
@@ -119,6 +120,33 @@ class ApogeeCCD : public INDI::CCD, public INDI::FilterInterface
             TYPE_AFW31_17R
         };
 
+        // TDI Drift Scan
+        ISwitchVectorProperty TDIModeSP;
+        ISwitch TDIModeS[2];
+        enum
+        {
+            TDI_OFF,
+            TDI_ON
+        };
+
+        INumberVectorProperty TDISettingsNP;
+        INumber TDISettingsN[4];
+        enum
+        {
+            TDI_DEC,
+            TDI_FOCAL_LENGTH,
+            TDI_ROWS,
+            TDI_STRIP_ROWS
+        };
+
+        INumberVectorProperty TDIStatusNP;
+        INumber TDIStatusN[2];
+        enum
+        {
+            TDI_ROW_PERIOD,
+            TDI_ROWS_READ
+        };
+
         // Filter Information
         ITextVectorProperty FilterInfoTP;
         IText FilterInfoT[2] {};
@@ -162,6 +190,18 @@ class ApogeeCCD : public INDI::CCD, public INDI::FilterInterface
 
         float CalcTimeLeft(timeval, float);
         int grabImage();
+
+        // TDI drift scan: rows are read as they are shifted out and sent in strips
+        double tdiRowPeriod();
+        bool startDriftScan();
+        void readDriftScanRows();
+        void sendDriftScanStrip();
+        void stopDriftScan();
+        bool tdiActive {false};
+        uint32_t tdiRowsRead {0};
+        uint32_t tdiStripStart {0};
+        int tdiFrame[4] {0, 0, 0, 0};
+        std::vector<uint16_t> tdiStrip;
         bool getCameraParams();
         void activateCooler(bool enable);
 };
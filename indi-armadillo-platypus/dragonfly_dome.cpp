@@ -28,7 +28,6 @@
 #include <cstring>
 #include <cassert>
 #include <memory>
-#include <regex>
 
 #include <termios.h>
 #include <unistd.h>
@@ -180,8 +179,7 @@ bool DragonFlyDome::updateProperties()
     {
         InitPark();
 
-        updateRelays();
-        updateSensors();
+        updateIO(true, true);
 
         double parkedSensor = -1, unparkedSensor = -1;
         IUGetConfigNumber(getDeviceName(), DomeControlSensorNP.name, DomeControlSensorN[SENSOR_UNPARKED].name, &unparkedSensor);
@@ -382,21 +380,20 @@ void DragonFlyDome::TimerHit()
     if (!isConnected())
         return;
 
-    // Update all sensors
-    m_UpdateSensorCounter++;
-    if (m_UpdateSensorCounter >= SENSOR_UPDATE_THRESHOLD)
-    {
+    // Update all sensors every SENSOR_UPDATE_THRESHOLD and all relays every RELAY_UPDATE_THRESHOLD timer hit.
+    // When both are due they go out in the same pipelined exchange.
+    bool sensorsDue = ++m_UpdateSensorCounter >= SENSOR_UPDATE_THRESHOLD;
+    bool relaysDue = ++m_UpdateRelayCounter >= RELAY_UPDATE_THRESHOLD;
+    if (sensorsDue)
         m_UpdateSensorCounter = 0;
-        if (updateSensors())
-            IDSetNumber(&SensorNP, nullptr);
-    }
+    if (relaysDue)
+        m_UpdateRelayCounter = 0;
 
-    // Update all relays every RELAY_UPDATE_THRESHOLD timer hit
-    m_UpdateRelayCounter++;
-    if (m_UpdateRelayCounter >= RELAY_UPDATE_THRESHOLD)
+    if ((sensorsDue || relaysDue) && updateIO(sensorsDue, relaysDue))
     {
-        m_UpdateRelayCounter = 0;
-        if (updateRelays())
+        if (sensorsDue)
+            IDSetNumber(&SensorNP, nullptr);
+        if (relaysDue)
         {
             for (const auto &oneRelay : Relays)
                 oneRelay->sync(oneRelay->isEnabled() ? IPS_OK : IPS_IDLE);
@@ -611,17 +608,7 @@ bool DragonFlyDome::isSensorOn(uint8_t id)
 /////////////////////////////////////////////////////////////////////////////
 bool DragonFlyDome::updateSensors()
 {
-    for (uint8_t i = 0; i < 8; i++)
-    {
-        char cmd[DRIVER_LEN] = {0};
-        int32_t res = 0;
-        snprintf(cmd, DRIVER_LEN, "!relio snanrd 0 %d#", i);
-        if (!sendCommand(cmd, res))
-            return false;
-        SensorN[i].value = res;
-    }
-
-    return true;
+    return updateIO(true, false);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -629,67 +616,170 @@ bool DragonFlyDome::updateSensors()
 /////////////////////////////////////////////////////////////////////////////
 bool DragonFlyDome::updateRelays()
 {
-    for (uint8_t i = 0; i < 8; i++)
+    return updateIO(false, true);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Query sensors and/or relays in a single pipelined exchange
+/////////////////////////////////////////////////////////////////////////////
+bool DragonFlyDome::updateIO(bool sensors, bool relays)
+{
+    std::vector<std::string> cmds;
+    char cmd[DRIVER_LEN] = {0};
+
+    if (sensors)
     {
-        char cmd[DRIVER_LEN] = {0};
-        int32_t res = 0;
-        snprintf(cmd, DRIVER_LEN, "!relio rldgrd 0 %d#", i);
-        if (!sendCommand(cmd, res))
-            return false;
-        Relays[i]->setEnabled(res == 1);
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            snprintf(cmd, DRIVER_LEN, "!relio snanrd 0 %d#", i);
+            cmds.push_back(cmd);
+        }
+    }
+    if (relays)
+    {
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            snprintf(cmd, DRIVER_LEN, "!relio rldgrd 0 %d#", i);
+            cmds.push_back(cmd);
+        }
     }
 
-    return true;
+    std::vector<int32_t> res;
+    if (!sendCommands(cmds, res))
+        return false;
 
+    size_t n = 0;
+    if (sensors)
+    {
+        for (uint8_t i = 0; i < 8; i++)
+            SensorN[i].value = res[n++];
+    }
+    if (relays)
+    {
+        for (uint8_t i = 0; i < 8; i++)
+            Relays[i]->setEnabled(res[n++] == 1);
+    }
+
+    return true;
 }
 
 /////////////////////////////////////////////////////////////////////////////
 /// Send Command
 /////////////////////////////////////////////////////////////////////////////
 bool DragonFlyDome::sendCommand(const char * cmd, int32_t &res)
+{
+    std::vector<int32_t> values;
+    if (!sendCommands({cmd}, values))
+        return false;
+
+    res = values[0];
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Parse "<echoed command>:<value>". Returns false if there is no numeric value.
+/////////////////////////////////////////////////////////////////////////////
+bool DragonFlyDome::parseResponse(const char *response, std::string &key, int32_t &value)
+{
+    const char *colon = strrchr(response, ':');
+    if (colon == nullptr || colon[1] < '0' || colon[1] > '9')
+        return false;
+
+    value = 0;
+    for (const char *p = colon + 1; *p >= '0' && *p <= '9'; p++)
+        value = value * 10 + (*p - '0');
+
+    key.assign(response, colon - response);
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Send Commands
+/// All commands are written back to back and replies are matched against the
+/// in-flight commands as they arrive. The controller echoes the command before
+/// the value, which is used to pair them; a reply that does not match any echo
+/// is discarded, since after a resend it may be a late or duplicate answer.
+/// Unanswered commands are resent up to three times.
+/////////////////////////////////////////////////////////////////////////////
+bool DragonFlyDome::sendCommands(const std::vector<std::string> &cmds, std::vector<int32_t> &res)
 {
     int rc = TTY_OK;
-    for (int i = 0; i < 3; i++)
+    std::vector<bool> answered(cmds.size(), false);
+    size_t remaining = cmds.size();
+
+    res.assign(cmds.size(), 0);
+
+    for (int i = 0; i < 3 && remaining > 0; i++)
     {
-        int nbytes_written = 0, nbytes_read = 0;
-        char response[DRIVER_LEN] = {0};
+        for (size_t j = 0; j < cmds.size(); j++)
+        {
+            if (answered[j])
+                continue;
 
-        LOGF_DEBUG("CMD <%s>", cmd);
+            int nbytes_written = 0;
+            LOGF_DEBUG("CMD <%s>", cmds[j].c_str());
 
-        rc = tty_write_string(PortFD, cmd, &nbytes_written);
+            rc = tty_write_string(PortFD, cmds[j].c_str(), &nbytes_written);
 
-        if (rc != TTY_OK)
-        {
-            char errstr[MAXRBUF] = {0};
-            tty_error_msg(rc, errstr, MAXRBUF);
-            LOGF_ERROR("Serial write error: %s.", errstr);
-            return false;
+            if (rc != TTY_OK)
+            {
+                char errstr[MAXRBUF] = {0};
+                tty_error_msg(rc, errstr, MAXRBUF);
+                LOGF_ERROR("Serial write error: %s.", errstr);
+                return false;
+            }
         }
 
-        rc = tty_nread_section(PortFD, response, DRIVER_LEN, DRIVER_STOP_CHAR, DRIVER_TIMEOUT, &nbytes_read);
-
-        if (rc != TTY_OK)
+        // Collect replies until everything in flight is answered or the link goes quiet
+        size_t inflight = remaining;
+        while (inflight > 0)
         {
-            usleep(100000);
-            continue;
-        }
+            int nbytes_read = 0;
+            char response[DRIVER_LEN] = {0};
 
-        // Remove extra #
-        response[nbytes_read - 1] = 0;
-        LOGF_DEBUG("RES <%s>", response);
+            rc = tty_nread_section(PortFD, response, DRIVER_LEN, DRIVER_STOP_CHAR, DRIVER_TIMEOUT, &nbytes_read);
+            if (rc != TTY_OK)
+                break;
 
+            inflight--;
 
-        std::regex rgx(R"(.*:(\d+))");
-        std::smatch match;
-        std::string input(response);
+            // Remove extra #
+            response[nbytes_read - 1] = 0;
+            LOGF_DEBUG("RES <%s>", response);
 
-        if (std::regex_search(input, match, rgx))
-        {
-            res = std::stoi(match.str(1));
-            return true;
+            std::string key;
+            int32_t value = 0;
+            if (!parseResponse(response, key, value))
+                continue;
+
+            size_t match = cmds.size();
+            for (size_t j = 0; j < cmds.size(); j++)
+            {
+                if (answered[j])
+                    continue;
+                // Commands end with the stop char, the echo does not
+                if (cmds[j].compare(0, cmds[j].size() - 1, key) == 0)
+                {
+                    match = j;
+                    break;
+                }
+            }
+
+            if (match == cmds.size())
+            {
+                LOGF_DEBUG("Discarding reply <%s>, no outstanding command matches it.", response);
+                continue;
+            }
+
+            res[match] = value;
+            answered[match] = true;
+            remaining--;
         }
     }
 
+    if (remaining == 0)
+        return true;
+
     if (rc != TTY_OK)
     {
         char errstr[MAXRBUF] = {0};
@@ -103,11 +103,14 @@ class DragonFlyDome : public INDI::Dome
         ///////////////////////////////////////////////////////////////////////////////
         bool isSensorOn(uint8_t id);
         bool updateSensors();
+        bool updateIO(bool sensors, bool relays);
 
         ///////////////////////////////////////////////////////////////////////////////
         /// Communication Functions
         ///////////////////////////////////////////////////////////////////////////////
         bool sendCommand(const char * cmd, int32_t &res);
+        bool sendCommands(const std::vector<std::string> &cmds, std::vector<int32_t> &res);
+        bool parseResponse(const char *response, std::string &key, int32_t &value);
         void hexDump(char * buf, const char * data, int size);
         std::vector<std::string> split(const std::string &input, const std::string &regex);
 
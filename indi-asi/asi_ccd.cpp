@@ -32,12 +32,17 @@
 #include <cmath>
 #include <vector>
 #include <map>
+#include <cerrno>
+#include <cstring>
 #include <unistd.h>
 
 #define MAX_EXP_RETRIES         3
 #define VERBOSE_EXPOSURE        3
 #define TEMP_TIMER_MS           1000 /* Temperature polling time (ms) */
 #define TEMP_THRESHOLD          .25  /* Differential temperature threshold (C)*/
+#define ADAPT_WINDOW_MS         2000 /* Dropped frame statistics window while streaming (ms) */
+#define ADAPT_QUIET_WINDOWS     3    /* Windows without drops before raising USB bandwidth */
+#define ADAPT_BANDWIDTH_STEP    5    /* USB bandwidth increase step */
 
 #define CONTROL_TAB "Controls"
 
@@ -173,8 +178,20 @@ void ASICCD::workerStreamVideo(const std::atomic_bool &isAboutToQuit)
         LOGF_ERROR("Failed to start video capture (%s).", Helpers::toString(ret));
     }
 
+    mDroppedFrames = 0;
+    mQuietWindows  = 0;
+    int frames     = 0;
+    INDI::ElapsedTimer adaptTimer;
+
     while (!isAboutToQuit)
     {
+        if (adaptTimer.elapsed() >= ADAPT_WINDOW_MS)
+        {
+            adaptBandwidth(frames, adaptTimer.elapsed());
+            adaptTimer.start();
+            frames = 0;
+        }
+
         uint8_t *targetFrame = PrimaryCCD.getFrameBuffer();
         uint32_t totalBytes  = PrimaryCCD.getFrameBufferSize();
         int waitMS           = static_cast<int>((ExposureRequest * 2000.0) + 500);
@@ -198,11 +215,96 @@ void ASICCD::workerStreamVideo(const std::atomic_bool &isAboutToQuit)
                 std::swap(targetFrame[i], targetFrame[i + 2]);
 
         Streamer->newFrame(targetFrame, totalBytes);
+        frames++;
     }
 
     ASIStopVideoCapture(mCameraInfo.CameraID);
 }
 
+void ASICCD::adaptBandwidth(int frames, double elapsedMs)
+{
+    int dropped = 0;
+    if (ASIGetDroppedFrames(mCameraInfo.CameraID, &dropped) != ASI_SUCCESS)
+        return;
+
+    // Counter restarts with every video capture
+    int newDrops    = std::max(0, dropped - mDroppedFrames);
+    mDroppedFrames  = dropped;
+    double interval = frames > 0 ? elapsedMs / frames : 0;
+
+    long bandwidth  = 0;
+    ASI_BOOL isAuto = ASI_FALSE;
+    ASIGetControlValue(mCameraInfo.CameraID, ASI_BANDWIDTHOVERLOAD, &bandwidth, &isAuto);
+
+    StreamStatsNP[STATS_DROPPED].setValue(dropped);
+    StreamStatsNP[STATS_DROP_RATE].setValue(newDrops + frames > 0 ? 100.0 * newDrops / (newDrops + frames) : 0);
+    StreamStatsNP[STATS_FRAME_INTERVAL].setValue(interval);
+    StreamStatsNP[STATS_BANDWIDTH].setValue(bandwidth);
+    StreamStatsNP.setState(newDrops > 0 ? IPS_ALERT : IPS_OK);
+    StreamStatsNP.apply();
+
+    if (AdaptiveBandwidthSP[ADAPT_BANDWIDTH].getState() != ISS_ON || isAuto == ASI_TRUE)
+        return;
+
+    long minBandwidth = static_cast<long>(BandwidthLimitsNP[BANDWIDTH_MIN].getValue());
+    long maxBandwidth = static_cast<long>(BandwidthLimitsNP[BANDWIDTH_MAX].getValue());
+    bool adaptHighSpeed = AdaptiveBandwidthSP[ADAPT_HIGH_SPEED].getState() == ISS_ON &&
+                          findControlCaps(ASI_HIGH_SPEED_MODE) != nullptr;
+    long highSpeed = 0;
+    if (adaptHighSpeed)
+        ASIGetControlValue(mCameraInfo.CameraID, ASI_HIGH_SPEED_MODE, &highSpeed, &isAuto);
+
+    long newBandwidth = bandwidth;
+    long newHighSpeed = highSpeed;
+
+    if (newDrops > 0)
+    {
+        // Back off quickly, the bus is shared with someone else
+        mQuietWindows = 0;
+        if (bandwidth > minBandwidth)
+            newBandwidth = std::max(minBandwidth, std::min(bandwidth - 1, bandwidth * 4 / 5));
+        else if (adaptHighSpeed && highSpeed)
+            newHighSpeed = 0;
+    }
+    else if (++mQuietWindows >= ADAPT_QUIET_WINDOWS)
+    {
+        // Probe for more throughput only while frames arrive slower than requested
+        mQuietWindows = 0;
+        double targetInterval = 1000.0 / Streamer->getTargetFPS();
+        if (interval > targetInterval * 1.1)
+        {
+            if (bandwidth < maxBandwidth)
+                newBandwidth = std::min(maxBandwidth, bandwidth + ADAPT_BANDWIDTH_STEP);
+            else if (adaptHighSpeed && !highSpeed)
+                newHighSpeed = 1;
+        }
+    }
+
+    if (newBandwidth != bandwidth)
+    {
+        LOGF_DEBUG("Adapting USB bandwidth %ld -> %ld (%d dropped, %.1f ms/frame).", bandwidth, newBandwidth, newDrops,
+                   interval);
+        ASISetControlValue(mCameraInfo.CameraID, ASI_BANDWIDTHOVERLOAD, newBandwidth, ASI_FALSE);
+    }
+
+    if (newHighSpeed != highSpeed)
+    {
+        LOGF_INFO("%s high speed mode to keep up with USB bandwidth.", newHighSpeed ? "Enabling" : "Disabling");
+        ASISetControlValue(mCameraInfo.CameraID, ASI_HIGH_SPEED_MODE, newHighSpeed, ASI_FALSE);
+    }
+
+    if (newBandwidth != bandwidth || newHighSpeed != highSpeed)
+        updateControls();
+}
+
+const ASI_CONTROL_CAPS *ASICCD::findControlCaps(ASI_CONTROL_TYPE type) const
+{
+    for (const auto &cap : mControlCaps)
+        if (cap.ControlType == type)
+            return &cap;
+    return nullptr;
+}
+
 void ASICCD::workerBlinkExposure(const std::atomic_bool &isAboutToQuit, int blinks, float duration)
 {
     if (blinks <= 0)
@@ -305,6 +407,8 @@ void ASICCD::workerExposure(const std::atomic_bool &isAboutToQuit, float duratio
         return;
     }
 
+    mTiming.mark(ExposureTiming::PHASE_ARM);
+
     INDI::ElapsedTimer exposureTimer;
 
     if (duration > VERBOSE_EXPOSURE)
@@ -371,6 +475,8 @@ void ASICCD::workerExposure(const std::atomic_bool &isAboutToQuit, float duratio
     }
     while (status != ASI_EXP_SUCCESS);
 
+    mTiming.mark(ExposureTiming::PHASE_EXPOSURE);
+
     // Reset exposure retry
     mExposureRetry = 0;
     PrimaryCCD.setExposureLeft(0.0);
@@ -427,6 +533,42 @@ bool ASICCD::initProperties()
 
     IUSaveText(&BayerT[2], getBayerString());
 
+    AdaptiveBandwidthSP[ADAPT_BANDWIDTH ].fill("ADAPT_BANDWIDTH",  "Bandwidth",       ISS_OFF);
+    AdaptiveBandwidthSP[ADAPT_HIGH_SPEED].fill("ADAPT_HIGH_SPEED", "High Speed Mode", ISS_OFF);
+    AdaptiveBandwidthSP.fill(getDeviceName(), "ADAPTIVE_BANDWIDTH", "Adaptive USB", CONTROL_TAB, IP_RW, ISR_NOFMANY, 60, IPS_IDLE);
+
+    BandwidthLimitsNP[BANDWIDTH_MIN].fill("BANDWIDTH_MIN", "Min Bandwidth", "%.0f", 0, 100, 1, 40);
+    BandwidthLimitsNP[BANDWIDTH_MAX].fill("BANDWIDTH_MAX", "Max Bandwidth", "%.0f", 0, 100, 1, 100);
+    BandwidthLimitsNP.fill(getDeviceName(), "ADAPTIVE_BANDWIDTH_LIMITS", "USB Limits", CONTROL_TAB, IP_RW, 60, IPS_IDLE);
+
+    StreamStatsNP[STATS_DROPPED       ].fill("DROPPED",        "Dropped Frames",    "%.0f", 0, 1e9, 1, 0);
+    StreamStatsNP[STATS_DROP_RATE     ].fill("DROP_RATE",      "Drop Rate (%)",     "%.1f", 0, 100, 1, 0);
+    StreamStatsNP[STATS_FRAME_INTERVAL].fill("FRAME_INTERVAL", "Frame Interval (ms)", "%.1f", 0, 1e6, 1, 0);
+    StreamStatsNP[STATS_BANDWIDTH     ].fill("BANDWIDTH",      "USB Bandwidth",     "%.0f", 0, 100, 1, 0);
+    StreamStatsNP.fill(getDeviceName(), "STREAM_STATS", "Stream Stats", STREAM_TAB, IP_RO, 60, IPS_IDLE);
+
+    TimingSP[TIMING_STATS].fill("TIMING_STATS", "Statistics", ISS_OFF);
+    TimingSP[TIMING_TRACE].fill("TIMING_TRACE", "CSV Trace",  ISS_OFF);
+    TimingSP.fill(getDeviceName(), "EXPOSURE_TIMING", "Phase Timing", OPTIONS_TAB, IP_RW, ISR_NOFMANY, 60, IPS_IDLE);
+
+    std::string tracePath = std::string("~/.indi/") + getDeviceName() + "_timing.csv";
+    std::replace(tracePath.begin(), tracePath.end(), ' ', '_');
+    TimingTraceTP[0].fill("TRACE_FILE", "File", tracePath.c_str());
+    TimingTraceTP.fill(getDeviceName(), "EXPOSURE_TIMING_TRACE", "Timing Trace", OPTIONS_TAB, IP_RW, 60, IPS_IDLE);
+
+    TimingStatsNP[TIMING_FRAMES       ].fill("FRAMES",        "Frames",             "%.0f",    0, 1e9, 1, 0);
+    TimingStatsNP[TIMING_ARM_MEAN     ].fill("ARM_MEAN",      "Arm (ms)",           "%.1f",    0, 1e9, 1, 0);
+    TimingStatsNP[TIMING_ARM_MAX      ].fill("ARM_MAX",       "Arm max (ms)",       "%.1f",    0, 1e9, 1, 0);
+    TimingStatsNP[TIMING_EXPOSURE_MEAN].fill("EXPOSURE_MEAN", "Overrun (ms)",       "%.1f", -1e9, 1e9, 1, 0);
+    TimingStatsNP[TIMING_EXPOSURE_MAX ].fill("EXPOSURE_MAX",  "Overrun max (ms)",   "%.1f", -1e9, 1e9, 1, 0);
+    TimingStatsNP[TIMING_DOWNLOAD_MEAN].fill("DOWNLOAD_MEAN", "Download (ms)",      "%.1f",    0, 1e9, 1, 0);
+    TimingStatsNP[TIMING_DOWNLOAD_MAX ].fill("DOWNLOAD_MAX",  "Download max (ms)",  "%.1f",    0, 1e9, 1, 0);
+    TimingStatsNP[TIMING_PROCESS_MEAN ].fill("PROCESS_MEAN",  "Process (ms)",       "%.1f",    0, 1e9, 1, 0);
+    TimingStatsNP[TIMING_PROCESS_MAX  ].fill("PROCESS_MAX",   "Process max (ms)",   "%.1f",    0, 1e9, 1, 0);
+    TimingStatsNP[TIMING_COMPLETE_MEAN].fill("COMPLETE_MEAN", "Complete (ms)",      "%.1f",    0, 1e9, 1, 0);
+    TimingStatsNP[TIMING_COMPLETE_MAX ].fill("COMPLETE_MAX",  "Complete max (ms)",  "%.1f",    0, 1e9, 1, 0);
+    TimingStatsNP.fill(getDeviceName(), "EXPOSURE_TIMING_STATS", "Phase Stats", OPTIONS_TAB, IP_RO, 60, IPS_IDLE);
+
     ADCDepthNP[0].fill("BITS", "Bits", "%2.0f", 0, 32, 1, mCameraInfo.BitDepth);
     ADCDepthNP.fill(getDeviceName(), "ADC_DEPTH", "ADC Depth", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
 
@@ -537,6 +679,27 @@ bool ASICCD::updateProperties()
         defineProperty(BlinkNP);
         defineProperty(ADCDepthNP);
         defineProperty(SDKVersionSP);
+
+        auto bandwidthCaps = findControlCaps(ASI_BANDWIDTHOVERLOAD);
+        if (bandwidthCaps != nullptr)
+        {
+            for (auto &limit : BandwidthLimitsNP)
+                limit.setMinMax(bandwidthCaps->MinValue, bandwidthCaps->MaxValue);
+            BandwidthLimitsNP[BANDWIDTH_MIN].setValue(bandwidthCaps->MinValue);
+            BandwidthLimitsNP[BANDWIDTH_MAX].setValue(bandwidthCaps->MaxValue);
+
+            defineProperty(AdaptiveBandwidthSP);
+            defineProperty(BandwidthLimitsNP);
+            defineProperty(StreamStatsNP);
+            loadConfig(true, AdaptiveBandwidthSP.getName());
+            loadConfig(true, BandwidthLimitsNP.getName());
+        }
+
+        defineProperty(TimingSP);
+        defineProperty(TimingTraceTP);
+        defineProperty(TimingStatsNP);
+        loadConfig(true, TimingTraceTP.getName());
+        loadConfig(true, TimingSP.getName());
     }
     else
     {
@@ -560,6 +723,17 @@ bool ASICCD::updateProperties()
         deleteProperty(BlinkNP.getName());
         deleteProperty(SDKVersionSP.getName());
         deleteProperty(ADCDepthNP.getName());
+
+        if (findControlCaps(ASI_BANDWIDTHOVERLOAD) != nullptr)
+        {
+            deleteProperty(AdaptiveBandwidthSP.getName());
+            deleteProperty(BandwidthLimitsNP.getName());
+            deleteProperty(StreamStatsNP.getName());
+        }
+
+        deleteProperty(TimingSP.getName());
+        deleteProperty(TimingTraceTP.getName());
+        deleteProperty(TimingStatsNP.getName());
     }
 
     return true;
@@ -830,6 +1004,33 @@ bool ASICCD::ISNewNumber(const char *dev, const char *name, double values[], cha
             BlinkNP.apply();
             return true;
         }
+
+        if (BandwidthLimitsNP.isNameMatch(name))
+        {
+            // Check the new limits first, the streaming worker must never see min above max
+            double newMin = BandwidthLimitsNP[BANDWIDTH_MIN].getValue();
+            double newMax = BandwidthLimitsNP[BANDWIDTH_MAX].getValue();
+            for (int i = 0; i < n; i++)
+            {
+                if (BandwidthLimitsNP[BANDWIDTH_MIN].isNameMatch(names[i]))
+                    newMin = values[i];
+                else if (BandwidthLimitsNP[BANDWIDTH_MAX].isNameMatch(names[i]))
+                    newMax = values[i];
+            }
+
+            if (newMin > newMax || BandwidthLimitsNP.update(values, names, n) == false)
+            {
+                if (newMin > newMax)
+                    LOG_ERROR("Minimum bandwidth must not exceed the maximum.");
+                BandwidthLimitsNP.setState(IPS_ALERT);
+                BandwidthLimitsNP.apply();
+                return true;
+            }
+
+            BandwidthLimitsNP.setState(IPS_OK);
+            BandwidthLimitsNP.apply();
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewNumber(dev, name, values, names, n);
@@ -897,6 +1098,20 @@ bool ASICCD::ISNewSwitch(const char *dev, const char *name, ISState *states, cha
             return true;
         }
 
+        if (AdaptiveBandwidthSP.isNameMatch(name))
+        {
+            AdaptiveBandwidthSP.setState(AdaptiveBandwidthSP.update(states, names, n) ? IPS_OK : IPS_ALERT);
+            AdaptiveBandwidthSP.apply();
+            return true;
+        }
+
+        if (TimingSP.isNameMatch(name))
+        {
+            TimingSP.update(states, names, n);
+            setupTiming();
+            return true;
+        }
+
         if (VideoFormatSP.isNameMatch(name))
         {
             if (Streamer->isBusy())
@@ -925,6 +1140,61 @@ bool ASICCD::ISNewSwitch(const char *dev, const char *name, ISState *states, cha
     return INDI::CCD::ISNewSwitch(dev, name, states, names, n);
 }
 
+bool ASICCD::ISNewText(const char *dev, const char *name, char *texts[], char *names[], int n)
+{
+    if (dev != nullptr && !strcmp(dev, getDeviceName()))
+    {
+        if (TimingTraceTP.isNameMatch(name))
+        {
+            TimingTraceTP.update(texts, names, n);
+            TimingTraceTP.setState(IPS_OK);
+            TimingTraceTP.apply();
+
+            // Reopen the trace under its new name
+            if (TimingSP[TIMING_TRACE].getState() == ISS_ON)
+                setupTiming();
+            return true;
+        }
+    }
+
+    return INDI::CCD::ISNewText(dev, name, texts, names, n);
+}
+
+bool ASICCD::setupTiming()
+{
+    bool trace = (TimingSP[TIMING_TRACE].getState() == ISS_ON);
+    bool ok    = true;
+
+    mTiming.closeTrace();
+    if (trace && !mTiming.openTrace(TimingTraceTP[0].getText()))
+    {
+        LOGF_ERROR("Failed to open timing trace %s (%s).", TimingTraceTP[0].getText(), strerror(errno));
+        TimingSP[TIMING_TRACE].setState(ISS_OFF);
+        trace = false;
+        ok    = false;
+    }
+
+    bool enabled = trace || TimingSP[TIMING_STATS].getState() == ISS_ON;
+    mTiming.setEnabled(enabled);
+
+    TimingSP.setState(ok ? (enabled ? IPS_OK : IPS_IDLE) : IPS_ALERT);
+    TimingSP.apply();
+    return ok;
+}
+
+void ASICCD::updateTimingStats()
+{
+    TimingStatsNP[TIMING_FRAMES].setValue(mTiming.getFrames());
+    for (int i = 0; i < ExposureTiming::PHASE_N; i++)
+    {
+        auto phase = static_cast<ExposureTiming::Phase>(i);
+        TimingStatsNP[TIMING_ARM_MEAN + 2 * i].setValue(mTiming.getMean(phase));
+        TimingStatsNP[TIMING_ARM_MAX  + 2 * i].setValue(mTiming.getMax(phase));
+    }
+    TimingStatsNP.setState(IPS_OK);
+    TimingStatsNP.apply();
+}
+
 bool ASICCD::setVideoFormat(uint8_t index)
 {
     if (index == VideoFormatSP.findOnSwitchIndex())
@@ -1004,6 +1274,7 @@ bool ASICCD::activateCooler(bool enable)
 bool ASICCD::StartExposure(float duration)
 {
     mExposureRetry = 0;
+    mTiming.start(duration);
     mWorker.start(std::bind(&ASICCD::workerExposure, this, std::placeholders::_1, duration));
     return true;
 }
@@ -1175,6 +1446,8 @@ int ASICCD::grabImage(float duration)
         return -1;
     }
 
+    mTiming.mark(ExposureTiming::PHASE_DOWNLOAD);
+
     if (type == ASI_IMG_RGB24)
     {
         uint8_t *dstR = image;
@@ -1195,6 +1468,8 @@ int ASICCD::grabImage(float duration)
     }
     guard.unlock();
 
+    mTiming.mark(ExposureTiming::PHASE_PROCESS);
+
     PrimaryCCD.setNAxis(type == ASI_IMG_RGB24 ? 3 : 2);
 
     // If mono camera or we're sending Luma or RGB, turn off bayering
@@ -1207,6 +1482,9 @@ int ASICCD::grabImage(float duration)
         LOG_INFO("Download complete.");
 
     ExposureComplete(&PrimaryCCD);
+
+    if (mTiming.mark(ExposureTiming::PHASE_COMPLETE))
+        updateTimingStats();
     return 0;
 }
 
@@ -1536,5 +1814,14 @@ bool ASICCD::saveConfigItems(FILE *fp)
 
     BlinkNP.save(fp);
 
+    if (findControlCaps(ASI_BANDWIDTHOVERLOAD) != nullptr)
+    {
+        AdaptiveBandwidthSP.save(fp);
+        BandwidthLimitsNP.save(fp);
+    }
+
+    TimingSP.save(fp);
+    TimingTraceTP.save(fp);
+
     return true;
 }
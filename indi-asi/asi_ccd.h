@@ -29,6 +29,8 @@
 #include "indipropertytext.h"
 #include "indisinglethreadpool.h"
 
+#include "exposure_timing.h"
+
 #include <vector>
 
 #include <indiccd.h>
@@ -73,6 +75,8 @@ protected:
     // ASI specific keywords
     virtual void addFITSKeywords(fitsfile *fptr, INDI::CCDChip *targetChip) override;
 
+    virtual bool ISNewText(const char *dev, const char *name, char *texts[], char *names[], int n) override;
+
     // Save config
     virtual bool saveConfigItems(FILE *fp) override;
 
@@ -126,6 +130,18 @@ private:
     /** Get if MonoBin is active, thus Bayer is irrelevant */
     bool isMonoBinActive();
 
+    /** Get control capabilities, nullptr if the camera does not support it */
+    const ASI_CONTROL_CAPS *findControlCaps(ASI_CONTROL_TYPE type) const;
+
+    /** Update dropped frame statistics and adapt USB bandwidth while streaming */
+    void adaptBandwidth(int frames, double elapsedMs);
+
+    /** Enable exposure phase timing and the CSV trace as selected */
+    bool setupTiming();
+
+    /** Publish the exposure phase statistics */
+    void updateTimingStats();
+
 private:
     /** Additional Properties to INDI::CCD */
     INDI::PropertyNumber  CoolerNP {1};
@@ -144,10 +160,58 @@ private:
         BLINK_DURATION
     };
 
+    INDI::PropertySwitch  AdaptiveBandwidthSP {2};
+    enum {
+        ADAPT_BANDWIDTH,
+        ADAPT_HIGH_SPEED
+    };
+
+    INDI::PropertyNumber  BandwidthLimitsNP {2};
+    enum {
+        BANDWIDTH_MIN,
+        BANDWIDTH_MAX
+    };
+
+    INDI::PropertyNumber  StreamStatsNP {4};
+    enum {
+        STATS_DROPPED,
+        STATS_DROP_RATE,
+        STATS_FRAME_INTERVAL,
+        STATS_BANDWIDTH
+    };
+
+    INDI::PropertySwitch  TimingSP {2};
+    enum {
+        TIMING_STATS,
+        TIMING_TRACE
+    };
+
+    INDI::PropertyText    TimingTraceTP {1};
+
+    INDI::PropertyNumber  TimingStatsNP {11};
+    enum {
+        TIMING_FRAMES,
+        TIMING_ARM_MEAN,
+        TIMING_ARM_MAX,
+        TIMING_EXPOSURE_MEAN,
+        TIMING_EXPOSURE_MAX,
+        TIMING_DOWNLOAD_MEAN,
+        TIMING_DOWNLOAD_MAX,
+        TIMING_PROCESS_MEAN,
+        TIMING_PROCESS_MAX,
+        TIMING_COMPLETE_MEAN,
+        TIMING_COMPLETE_MAX
+    };
+
 private:
     std::string mCameraName;
     uint8_t mExposureRetry {0};
 
+    int mDroppedFrames {0};
+    int mQuietWindows {0};
+
+    ExposureTiming mTiming;
+
     ASI_IMG_TYPE                  mCurrentVideoFormat;
     std::vector<ASI_CONTROL_CAPS> mControlCaps;
     ASI_CAMERA_INFO               mCameraInfo;
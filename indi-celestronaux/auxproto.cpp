@@ -285,6 +285,7 @@ int AUXCommand::response_data_size()
                 return 4;
             case MC_SLEW_DONE:
             case MC_POLL_CORDWRAP:
+            case MC_AUX_GUIDE_ACTIVE:
                 return 1;
             case MC_GOTO_FAST:
             case MC_SET_POSITION:
@@ -297,6 +298,7 @@ int AUXCommand::response_data_size()
             case MC_ENABLE_CORDWRAP:
             case MC_DISABLE_CORDWRAP:
             case MC_SET_CORDWRAP_POS:
+            case MC_AUX_GUIDE:
                 return 0;
             case MC_SEEK_INDEX:
                 return -1;
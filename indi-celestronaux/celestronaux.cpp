@@ -115,6 +115,7 @@ bool CelestronAUX::Abort()
 {
     AxisStatusAZ = AxisStatusALT = STOPPED;
     TrackState = SCOPE_IDLE;
+    resetGuidePulses();
     Track(0, 0);
     AUXBuffer b(1);
     b[0] = 0;
@@ -1008,9 +1009,7 @@ IPState CelestronAUX::GuideNorth(uint32_t ms)
 
     int8_t rate = static_cast<int8_t>(GuideRateN[AXIS_DE].value);
 
-    GuidePulse(AXIS_DE, ms, rate);
-
-    return IPS_BUSY;
+    return GuidePulse(AXIS_DE, ms, rate);
 }
 
 IPState CelestronAUX::GuideSouth(uint32_t ms)
@@ -1019,9 +1018,7 @@ IPState CelestronAUX::GuideSouth(uint32_t ms)
 
     int8_t rate = static_cast<int8_t>(GuideRateN[AXIS_DE].value);
 
-    GuidePulse(AXIS_DE, ms, -rate);
-
-    return IPS_BUSY;
+    return GuidePulse(AXIS_DE, ms, -rate);
 }
 
 IPState CelestronAUX::GuideEast(uint32_t ms)
@@ -1030,9 +1027,7 @@ IPState CelestronAUX::GuideEast(uint32_t ms)
 
     int8_t rate = static_cast<int8_t>(GuideRateN[AXIS_RA].value);
 
-    GuidePulse(AXIS_RA, ms, -rate);
-
-    return IPS_BUSY;
+    return GuidePulse(AXIS_RA, ms, -rate);
 }
 
 IPState CelestronAUX::GuideWest(uint32_t ms)
@@ -1041,19 +1036,153 @@ IPState CelestronAUX::GuideWest(uint32_t ms)
 
     int8_t rate = static_cast<int8_t>(GuideRateN[AXIS_RA].value);
 
-    GuidePulse(AXIS_RA, ms, rate);
+    return GuidePulse(AXIS_RA, ms, rate);
+}
 
-    return IPS_BUSY;
+IPState CelestronAUX::GuidePulse(INDI_EQ_AXIS axis, uint32_t ms, int8_t rate)
+{
+    GuidePulseState &pulse = m_GuidePulse[axis];
+
+    // Queue the request, the sign of the accumulated time is the direction.
+    // Opposite pulses on the same axis cancel out.
+    pulse.pendingMs += (rate < 0) ? -static_cast<int32_t>(ms) : static_cast<int32_t>(ms);
+    pulse.rate = static_cast<uint8_t>(std::abs(rate));
+
+    // A chunk is running on this axis, the rest goes out once it is done
+    if (pulse.active)
+        return IPS_BUSY;
+
+    return sendGuideChunk(axis);
 }
 
-bool CelestronAUX::GuidePulse(INDI_EQ_AXIS axis, uint32_t ms, int8_t rate)
+/////////////////////////////////////////////////////////////////////////////////////
+/// Send the next MC_AUX_GUIDE chunk of the queued time on the axis.
+/// Returns IPS_OK when less than half a tick is left (kept for the next pulse),
+/// IPS_BUSY when a chunk is running and IPS_ALERT if it could not be sent.
+/////////////////////////////////////////////////////////////////////////////////////
+IPState CelestronAUX::sendGuideChunk(INDI_EQ_AXIS axis)
 {
-    uint8_t ticks = std::min(uint32_t(255), ms / 10);
+    GuidePulseState &pulse = m_GuidePulse[axis];
+
+    uint32_t ticks = std::min(static_cast<uint32_t>(GUIDE_MAX_TICKS),
+                              (static_cast<uint32_t>(std::abs(pulse.pendingMs)) + GUIDE_TICK_MS / 2) / GUIDE_TICK_MS);
+    if (ticks == 0)
+        return IPS_OK;
+
+    int32_t chunkMs = static_cast<int32_t>(ticks * GUIDE_TICK_MS);
+    int8_t rate = static_cast<int8_t>(pulse.rate);
+    if (pulse.pendingMs < 0)
+    {
+        rate = -rate;
+        pulse.pendingMs += chunkMs;
+    }
+    else
+        pulse.pendingMs -= chunkMs;
+
     AUXBuffer data(2);
     data[0] = rate;
     data[1] = ticks;
     AUXCommand cmd(MC_AUX_GUIDE, APP, axis == AXIS_DE ? ALT : AZM, data);
-    return sendAUXCommand(cmd);
+    if (!sendAUXCommand(cmd))
+    {
+        LOGF_ERROR("Failed to send %s guide pulse.", axis == AXIS_DE ? "N/S" : "W/E");
+        pulse.pendingMs = 0;
+        return IPS_ALERT;
+    }
+
+    DEBUGF(DBG_CAUX, "Guide pulse %s: %d ms at rate %d, %d ms queued",
+           axis == AXIS_DE ? "N/S" : "W/E", chunkMs, rate, pulse.pendingMs);
+
+    // Ask the motor controller whether it is done once the chunk should be over
+    pulse.active   = true;
+    pulse.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(chunkMs + GUIDE_DONE_TIMEOUT_MS);
+    pulse.timerID  = IEAddTimer(chunkMs, axis == AXIS_DE ? pollGuidePulseNSHelper : pollGuidePulseWEHelper, this);
+    return IPS_BUSY;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+///
+/////////////////////////////////////////////////////////////////////////////////////
+void CelestronAUX::finishGuideChunk(INDI_EQ_AXIS axis)
+{
+    GuidePulseState &pulse = m_GuidePulse[axis];
+
+    if (!pulse.active)
+        return;
+
+    pulse.active = false;
+    if (pulse.timerID >= 0)
+    {
+        IERmTimer(pulse.timerID);
+        pulse.timerID = -1;
+    }
+
+    // Chain the next chunk of a long or queued pulse, else report completion
+    if (sendGuideChunk(axis) != IPS_BUSY)
+        GuideComplete(axis);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+///
+/////////////////////////////////////////////////////////////////////////////////////
+void CelestronAUX::pollGuidePulse(INDI_EQ_AXIS axis)
+{
+    GuidePulseState &pulse = m_GuidePulse[axis];
+
+    pulse.timerID = -1;
+    if (!pulse.active)
+        return;
+
+    // The answer ends up in HandleGuidePulseDone which chains or completes
+    AUXCommand cmd(MC_AUX_GUIDE_ACTIVE, APP, axis == AXIS_DE ? ALT : AZM);
+    if (sendAUXCommand(cmd))
+        readAUXResponse(cmd);
+
+    // Still running and nothing rearmed the timer
+    if (pulse.active && pulse.timerID < 0)
+    {
+        if (std::chrono::steady_clock::now() > pulse.deadline)
+        {
+            LOGF_WARN("%s guide pulse completion not reported, assuming done.", axis == AXIS_DE ? "N/S" : "W/E");
+            finishGuideChunk(axis);
+        }
+        else
+            pulse.timerID = IEAddTimer(GUIDE_POLL_MS, axis == AXIS_DE ? pollGuidePulseNSHelper : pollGuidePulseWEHelper,
+                                       this);
+    }
+}
+
+void CelestronAUX::pollGuidePulseNSHelper(void *context)
+{
+    static_cast<CelestronAUX *>(context)->pollGuidePulse(AXIS_DE);
+}
+
+void CelestronAUX::pollGuidePulseWEHelper(void *context)
+{
+    static_cast<CelestronAUX *>(context)->pollGuidePulse(AXIS_RA);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+/// Drop queued guide time and stop waiting for running chunks.
+/////////////////////////////////////////////////////////////////////////////////////
+void CelestronAUX::resetGuidePulses()
+{
+    INDI_EQ_AXIS axes[2] = { AXIS_RA, AXIS_DE };
+    for (auto axis : axes)
+    {
+        GuidePulseState &pulse = m_GuidePulse[axis];
+        if (pulse.timerID >= 0)
+        {
+            IERmTimer(pulse.timerID);
+            pulse.timerID = -1;
+        }
+        pulse.pendingMs = 0;
+        if (pulse.active)
+        {
+            pulse.active = false;
+            GuideComplete(axis);
+        }
+    }
 }
 
 
@@ -1087,7 +1216,7 @@ bool CelestronAUX::HandleGuidePulse(INDI_EQ_AXIS axis)
 bool CelestronAUX::HandleGuidePulseDone(INDI_EQ_AXIS axis, bool done)
 {
     if (done)
-        GuideComplete(axis);
+        finishGuideChunk(axis);
 
     return true;
 }
@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <indicom.h>
 #include <libindi/indiguiderinterface.h>
 #include <inditelescope.h>
@@ -109,7 +110,13 @@ class CelestronAUX :
         bool Track(int32_t altRate, int32_t azRate);
         bool SetTrackEnabled(bool enabled) override;
         bool TimerTick(double dt);
-        bool GuidePulse(INDI_EQ_AXIS axis, uint32_t ms, int8_t rate);
+        IPState GuidePulse(INDI_EQ_AXIS axis, uint32_t ms, int8_t rate);
+        IPState sendGuideChunk(INDI_EQ_AXIS axis);
+        void finishGuideChunk(INDI_EQ_AXIS axis);
+        void pollGuidePulse(INDI_EQ_AXIS axis);
+        void resetGuidePulses();
+        static void pollGuidePulseNSHelper(void *context);
+        static void pollGuidePulseWEHelper(void *context);
 
 
     private:
@@ -217,6 +224,20 @@ class CelestronAUX :
 
         bool m_Tracking {false};
         bool m_SlewingAlt {false}, m_SlewingAz {false};
+
+        // Guide pulse bookkeeping, indexed by INDI_EQ_AXIS.
+        // Requested time is accumulated as signed ms and sent to the motor
+        // controller in chunks of at most GUIDE_MAX_TICKS. What does not fit
+        // in whole ticks stays in pendingMs for the next pulse.
+        struct GuidePulseState
+        {
+            int32_t pendingMs {0};
+            uint8_t rate {0};
+            bool active {false};
+            int timerID {-1};
+            std::chrono::steady_clock::time_point deadline;
+        };
+        GuidePulseState m_GuidePulse[2];
         bool gpsemu;
         bool cw_base_sky = false ;
 
@@ -312,6 +333,13 @@ class CelestronAUX :
         static constexpr uint8_t FIND_SLEW_RATE {7};
         static constexpr uint8_t CENTERING_SLEW_RATE {3};
         static constexpr uint8_t GUIDE_SLEW_RATE {2};
+        // MC_AUX_GUIDE duration resolution in ms and longest single pulse in ticks
+        static constexpr uint32_t GUIDE_TICK_MS {10};
+        static constexpr uint32_t GUIDE_MAX_TICKS {255};
+        // ms between MC_AUX_GUIDE_ACTIVE polls once a chunk should have ended
+        static constexpr uint32_t GUIDE_POLL_MS {20};
+        // ms past the chunk end before we stop waiting for completion
+        static constexpr uint32_t GUIDE_DONE_TIMEOUT_MS {1000};
         static constexpr uint32_t BUFFER_SIZE {10240};
         // seconds
         static constexpr uint8_t READ_TIMEOUT {1};
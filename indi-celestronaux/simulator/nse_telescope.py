@@ -52,6 +52,8 @@ commands={
           'MC_MAXRATE_ENABLED':0x23,
           'MC_MOVE_POS':0x24,
           'MC_MOVE_NEG':0x25,
+          'MC_AUX_GUIDE':0x26,
+          'MC_AUX_GUIDE_ACTIVE':0x27,
           'MC_ENABLE_CORDWRAP':0x38,
           'MC_DISABLE_CORDWRAP':0x39,
           'MC_SET_CORDWRAP_POS':0x3a,
@@ -212,6 +214,16 @@ class NexStarScope:
         self.goto=False
         self.alt_guiderate=0.0
         self.azm_guiderate=0.0
+        # MC_AUX_GUIDE pulses: rate (rot/sec) and time left (sec)
+        self.alt_pulse_rate=0.0
+        self.azm_pulse_rate=0.0
+        self.alt_pulse_left=0.0
+        self.azm_pulse_left=0.0
+        # Requested and delivered pulse totals (signed sec)
+        self.alt_pulse_req=0.0
+        self.azm_pulse_req=0.0
+        self.alt_pulse_done=0.0
+        self.azm_pulse_done=0.0
         self.alt_maxrate=4000
         self.azm_maxrate=4000
         self.use_maxrate=False
@@ -250,6 +262,8 @@ class NexStarScope:
           0x23 : NexStarScope.maxrate_enabled,
           0x24 : NexStarScope.move_pos,
           0x25 : NexStarScope.move_neg,
+          0x26 : NexStarScope.aux_guide,
+          0x27 : NexStarScope.aux_guide_active,
           0x38 : NexStarScope.enable_cordwrap,
           0x39 : NexStarScope.disable_cordwrap,
           0x3a : NexStarScope.set_cordwrap_pos,
@@ -462,6 +476,28 @@ class NexStarScope:
             self.azm_rate = -r
         return b''
 
+    def aux_guide(self, data, snd, rcv):
+        # data: signed rate in % of sidereal, duration in 10ms ticks
+        rate=struct.unpack('!b',data[:1])[0]
+        t=data[1]/100
+        r=rate/100/86164.0905 # (transform to rot/sec)
+        s=1 if rate>=0 else -1
+        if trg_names[rcv] == 'ALT':
+            self.alt_pulse_rate=r
+            self.alt_pulse_left=t
+            self.alt_pulse_req+=s*t
+        else :
+            self.azm_pulse_rate=r
+            self.azm_pulse_left=t
+            self.azm_pulse_req+=s*t
+        return b''
+
+    def aux_guide_active(self, data, snd, rcv):
+        if trg_names[rcv] == 'ALT':
+            return b'\x01' if self.alt_pulse_left > 0 else b'\x00'
+        else :
+            return b'\x01' if self.azm_pulse_left > 0 else b'\x00'
+
     def enable_cordwrap(self, data, snd, rcv):
         self.cordwrap = True
         return b''
@@ -534,8 +570,8 @@ class NexStarScope:
             self.trg_w.border()
             self.rate_w=curses.newwin(4,25,5,0)
             self.guide_w=curses.newwin(4,25,5,25)
-            self.other_w=curses.newwin(8,50,9,0)
-            self.msg_w=curses.newwin(self.msg_log.maxlen+2,50,17,0)
+            self.other_w=curses.newwin(9,50,9,0)
+            self.msg_w=curses.newwin(self.msg_log.maxlen+2,50,18,0)
             stdscr.refresh()
 
     def update_dsp(self):
@@ -582,6 +618,9 @@ class NexStarScope:
             self.other_w.addstr(5,3,'Max rate ALT:%.2f  AZM:%.2f' % (self.alt_maxrate/1e3, self.azm_maxrate/1e3))
             self.other_w.addstr(6,3,'Cordwrap: %3s' % ('On' if self.cordwrap else 'Off'))
             self.other_w.addstr(6,20,'Pos: ' + repr_angle(self.cordwrap_pos))
+            self.other_w.addstr(7,3,'Pulses ALT:%+.2f/%+.2fs AZM:%+.2f/%+.2fs' % (
+                    self.alt_pulse_done, self.alt_pulse_req,
+                    self.azm_pulse_done, self.azm_pulse_req))
             self.other_w.refresh()
             self.cmd_log_w.clear()
             self.cmd_log_w.border()
@@ -618,6 +657,17 @@ class NexStarScope:
 
         self.alt += (self.alt_rate + self.alt_guiderate)*interval
         self.azm += (self.azm_rate + self.azm_guiderate)*interval
+        # Guide pulses, account for the time actually delivered
+        if self.alt_pulse_left > 0 :
+            dt=min(interval, self.alt_pulse_left)
+            self.alt += self.alt_pulse_rate*dt
+            self.alt_pulse_left -= dt
+            self.alt_pulse_done += dt if self.alt_pulse_rate>=0 else -dt
+        if self.azm_pulse_left > 0 :
+            dt=min(interval, self.azm_pulse_left)
+            self.azm += self.azm_pulse_rate*dt
+            self.azm_pulse_left -= dt
+            self.azm_pulse_done += dt if self.azm_pulse_rate>=0 else -dt
         if self.slewing and self.goto:
             # AZM
             r=self.trg_azm - self.azm
@@ -34,6 +34,7 @@
 
 #include <indicontroller.h>
 
+#include <algorithm>
 #include <memory>
 #include <sys/stat.h>
 
@@ -94,184 +95,44 @@ void indiduino::TimerHit()
 
     sf->OnIdle();
 
-    for (const auto &it: *getProperties())
+    // Only revisit the properties wired to pins the Firmata handlers reported as changed
+    std::vector<void *> touched;
+    for (int pin = 0; pin < MAX_IO_PIN; pin++)
     {
-        const char *name = it->getName();
-        INDI_PROPERTY_TYPE type = it->getType();
+        if (!sf->dirty_pins.test(pin))
+            continue;
 
-        //DIGITAL INPUT
-        if (type == INDI_LIGHT)
+        for (const auto &ref : pinProperties[pin])
         {
-            bool changed = false;
-            ILightVectorProperty *lvp = getLight(name);
-            if (lvp->aux != (void *)indiduino_id)
+            if (std::find(touched.begin(), touched.end(), ref.vp) != touched.end())
                 continue;
+            touched.push_back(ref.vp);
 
-            for (int i = 0; i < lvp->nlp; i++)
+            switch (ref.type)
             {
-                ILight *lqp = &lvp->lp[i];
-                if (!lqp)
-                    return;
-
-                IO *pin_config = (IO *)lqp->aux;
-                if (pin_config == nullptr)
-                    continue;
-                if (pin_config->IOType == DI)
-                {
-                    int pin = pin_config->pin;
-                    if (sf->pin_info[pin].mode == FIRMATA_MODE_INPUT)
-                    {
-                        if ((sf->pin_info[pin].value == 1) && (lqp->s != IPS_OK))
-                        {
-                            //LOGF_DEBUG("%s.%s on pin %u change to  ON",lvp->name,lqp->name,pin);
-                            //IDSetLight (lvp, "%s.%s change to ON\n",lvp->name,lqp->name);
-                            lqp->s = IPS_OK;
-                            changed = true;
-
-                        }
-                        else if ((sf->pin_info[pin].value == 0) && (lqp->s != IPS_IDLE))
-                        {
-                            //LOGF_DEBUG("%s.%s on pin %u change to  OFF",lvp->name,lqp->name,pin);
-                            //IDSetLight (lvp, "%s.%s change to OFF\n",lvp->name,lqp->name);
-                            lqp->s = IPS_IDLE;
-                            changed = true;
-                        }
-                    }
-                }
+                case INDI_LIGHT:
+                    updateLightPins(static_cast<ILightVectorProperty *>(ref.vp));
+                    break;
+                case INDI_SWITCH:
+                    updateSwitchPins(static_cast<ISwitchVectorProperty *>(ref.vp));
+                    break;
+                case INDI_NUMBER:
+                    updateNumberPins(static_cast<INumberVectorProperty *>(ref.vp));
+                    break;
+                default:
+                    break;
             }
-            if (changed) IDSetLight(lvp, nullptr);
         }
+    }
+    sf->dirty_pins.reset();
 
-        //read back DIGITAL OUTPUT values as reported by the board (FIRMATA_PIN_STATE_RESPONSE)
-        if (type == INDI_SWITCH)
-        {
-            bool changed = false;
-            int n_on = 0;
-            ISwitchVectorProperty *svp = getSwitch(name);
-
-            if (svp->aux != (void *)indiduino_id)
-                continue;
-
-            for (int i = 0; i < svp->nsp; i++)
-            {
-                ISwitch *sqp = &svp->sp[i];
-                if (!sqp)
-                    return;
-
-                IO *pin_config = (IO *)sqp->aux;
-                if (pin_config == nullptr)
-                    continue;
-                if ((pin_config->IOType == DO) || (pin_config->IOType == DI))
-                {
-                    int pin = pin_config->pin;
-                    if ((sf->pin_info[pin].mode == FIRMATA_MODE_OUTPUT) || (sf->pin_info[pin].mode == FIRMATA_MODE_INPUT))
-                    {
-                        if (sf->pin_info[pin].value == 1)
-                        {
-                            changed = changed || (sqp->s != ISS_ON);
-                            sqp->s = ISS_ON;
-                            n_on++;
-                        }
-                        else
-                        {
-                            changed = changed || (sqp->s != ISS_OFF);
-                            sqp->s = ISS_OFF;
-                        }
-                    }
-                }
-            }
-            if (changed)
-            {
-                if (svp->r == ISR_1OFMANY) // make sure that 1 switch is on
-                {
-                    for (int i = 0; i < svp->nsp; i++)
-                    {
-                        ISwitch *sqp = &svp->sp[i];
-
-                        if ((IO *)sqp->aux != nullptr)
-                            continue;
-                        if (n_on > 0)
-                        {
-                            sqp->s = ISS_OFF;
-                        }
-                        else
-                        {
-                            sqp->s = ISS_ON;
-                            n_on++;
-                        }
-                    }
-                }
-                IDSetSwitch(svp, nullptr);
-            }
-        }
-
-        //ANALOG
-        if (type == INDI_NUMBER)
-        {
-            bool changed = false;
-            INumberVectorProperty *nvp = getNumber(name);
-
-            if (nvp->aux != (void *)indiduino_id)
-                continue;
-
-            for (int i = 0; i < nvp->nnp; i++)
-            {
-                INumber *eqp = &nvp->np[i];
-                if (!eqp)
-                    return;
-
-                IO *pin_config = (IO *)eqp->aux0;
-                if (pin_config == nullptr)
-                    continue;
-
-                if (pin_config->IOType == AI)
-                {
-                    int pin = pin_config->pin;
-                    if (sf->pin_info[pin].mode == FIRMATA_MODE_ANALOG)
-                    {
-                        double new_value = pin_config->MulScale * (double)(sf->pin_info[pin].value) + pin_config->AddScale;
-                        changed = changed || (eqp->value != new_value);
-                        eqp->value = new_value;
-                        //LOGF_DEBUG("%f",eqp->value);
-                    }
-                }
-                if (pin_config->IOType == AO) // read back ANALOG OUTPUT values as reported by the board (FIRMATA_PIN_STATE_RESPONSE)
-                {
-                    int pin = pin_config->pin;
-                    if (sf->pin_info[pin].mode == FIRMATA_MODE_PWM)
-                    {
-                        double new_value = ((double)(sf->pin_info[pin].value) - pin_config->AddScale) / pin_config->MulScale;
-                        changed = changed || (eqp->value != new_value);
-                        eqp->value = new_value;
-                        //LOGF_DEBUG("%f",eqp->value);
-                    }
-                }
-            }
-            if (changed) IDSetNumber(nvp, nullptr);
-        }
-
-        //TEXT
-        if (type == INDI_TEXT)
-        {
-            ITextVectorProperty *tvp = getText(name);
-            if (tvp->aux != (void *)indiduino_id)
-                continue;
-
-            for (int i=0;i<tvp->ntp;i++) {
-                IText *eqp = &tvp->tp[i];
-                if (!eqp)
-                    return;
-
-                if (eqp->aux0 == nullptr) continue;
-                if (strcmp(eqp->text, (char*)eqp->aux0) != 0)
-                {
-                    IUSaveText(eqp, (char*)eqp->aux0);
-                    //LOGF_DEBUG("%s.%s TEXT: %s ",tvp->name,eqp->name,eqp->text);
-                    IDSetText(tvp, nullptr);
-                }
-            }
-        }
+    if (sf->string_dirty)
+    {
+        sf->string_dirty = false;
+        for (auto tvp : textProperties)
+            updateTextBuffer(tvp);
     }
+
     // START: Switch of for debugging!
     time_t sec_since_reply = sf->secondsSinceVersionReply();
     time_t max_delay = static_cast<time_t>(5*getCurrentPollingPeriod() < 30000 ? 30 : 5*getCurrentPollingPeriod()/1000);
@@ -311,6 +172,169 @@ void indiduino::TimerHit()
     SetTimer(getCurrentPollingPeriod());
 }
 
+/**************************************************************************************
+** DIGITAL INPUT
+***************************************************************************************/
+void indiduino::updateLightPins(ILightVectorProperty *lvp)
+{
+    bool changed = false;
+    for (int i = 0; i < lvp->nlp; i++)
+    {
+        ILight *lqp = &lvp->lp[i];
+        if (!lqp)
+            return;
+
+        IO *pin_config = (IO *)lqp->aux;
+        if (pin_config == nullptr)
+            continue;
+        if (pin_config->IOType == DI)
+        {
+            int pin = pin_config->pin;
+            if (sf->pin_info[pin].mode == FIRMATA_MODE_INPUT)
+            {
+                if ((sf->pin_info[pin].value == 1) && (lqp->s != IPS_OK))
+                {
+                    //LOGF_DEBUG("%s.%s on pin %u change to  ON",lvp->name,lqp->name,pin);
+                    //IDSetLight (lvp, "%s.%s change to ON\n",lvp->name,lqp->name);
+                    lqp->s = IPS_OK;
+                    changed = true;
+
+                }
+                else if ((sf->pin_info[pin].value == 0) && (lqp->s != IPS_IDLE))
+                {
+                    //LOGF_DEBUG("%s.%s on pin %u change to  OFF",lvp->name,lqp->name,pin);
+                    //IDSetLight (lvp, "%s.%s change to OFF\n",lvp->name,lqp->name);
+                    lqp->s = IPS_IDLE;
+                    changed = true;
+                }
+            }
+        }
+    }
+    if (changed) IDSetLight(lvp, nullptr);
+}
+
+/**************************************************************************************
+** Read back DIGITAL OUTPUT values as reported by the board (FIRMATA_PIN_STATE_RESPONSE)
+***************************************************************************************/
+void indiduino::updateSwitchPins(ISwitchVectorProperty *svp)
+{
+    bool changed = false;
+    int n_on = 0;
+    for (int i = 0; i < svp->nsp; i++)
+    {
+        ISwitch *sqp = &svp->sp[i];
+        if (!sqp)
+            return;
+
+        IO *pin_config = (IO *)sqp->aux;
+        if (pin_config == nullptr)
+            continue;
+        if ((pin_config->IOType == DO) || (pin_config->IOType == DI))
+        {
+            int pin = pin_config->pin;
+            if ((sf->pin_info[pin].mode == FIRMATA_MODE_OUTPUT) || (sf->pin_info[pin].mode == FIRMATA_MODE_INPUT))
+            {
+                if (sf->pin_info[pin].value == 1)
+                {
+                    changed = changed || (sqp->s != ISS_ON);
+                    sqp->s = ISS_ON;
+                    n_on++;
+                }
+                else
+                {
+                    changed = changed || (sqp->s != ISS_OFF);
+                    sqp->s = ISS_OFF;
+                }
+            }
+        }
+    }
+    if (changed)
+    {
+        if (svp->r == ISR_1OFMANY) // make sure that 1 switch is on
+        {
+            for (int i = 0; i < svp->nsp; i++)
+            {
+                ISwitch *sqp = &svp->sp[i];
+
+                if ((IO *)sqp->aux != nullptr)
+                    continue;
+                if (n_on > 0)
+                {
+                    sqp->s = ISS_OFF;
+                }
+                else
+                {
+                    sqp->s = ISS_ON;
+                    n_on++;
+                }
+            }
+        }
+        IDSetSwitch(svp, nullptr);
+    }
+}
+
+/**************************************************************************************
+** ANALOG
+***************************************************************************************/
+void indiduino::updateNumberPins(INumberVectorProperty *nvp)
+{
+    bool changed = false;
+    for (int i = 0; i < nvp->nnp; i++)
+    {
+        INumber *eqp = &nvp->np[i];
+        if (!eqp)
+            return;
+
+        IO *pin_config = (IO *)eqp->aux0;
+        if (pin_config == nullptr)
+            continue;
+
+        if (pin_config->IOType == AI)
+        {
+            int pin = pin_config->pin;
+            if (sf->pin_info[pin].mode == FIRMATA_MODE_ANALOG)
+            {
+                double new_value = pin_config->MulScale * (double)(sf->pin_info[pin].value) + pin_config->AddScale;
+                changed = changed || (eqp->value != new_value);
+                eqp->value = new_value;
+                //LOGF_DEBUG("%f",eqp->value);
+            }
+        }
+        if (pin_config->IOType == AO) // read back ANALOG OUTPUT values as reported by the board (FIRMATA_PIN_STATE_RESPONSE)
+        {
+            int pin = pin_config->pin;
+            if (sf->pin_info[pin].mode == FIRMATA_MODE_PWM)
+            {
+                double new_value = ((double)(sf->pin_info[pin].value) - pin_config->AddScale) / pin_config->MulScale;
+                changed = changed || (eqp->value != new_value);
+                eqp->value = new_value;
+                //LOGF_DEBUG("%f",eqp->value);
+            }
+        }
+    }
+    if (changed) IDSetNumber(nvp, nullptr);
+}
+
+/**************************************************************************************
+** TEXT
+***************************************************************************************/
+void indiduino::updateTextBuffer(ITextVectorProperty *tvp)
+{
+    for (int i=0;i<tvp->ntp;i++) {
+        IText *eqp = &tvp->tp[i];
+        if (!eqp)
+            return;
+
+        if (eqp->aux0 == nullptr) continue;
+        if (strcmp(eqp->text, (char*)eqp->aux0) != 0)
+        {
+            IUSaveText(eqp, (char*)eqp->aux0);
+            //LOGF_DEBUG("%s.%s TEXT: %s ",tvp->name,eqp->name,eqp->text);
+            IDSetText(tvp, nullptr);
+        }
+    }
+}
+
 /**************************************************************************************
 ** Initialize all properties & set default values.
 **************************************************************************************/
@@ -743,6 +767,10 @@ bool indiduino::setPinModesFromSKEL()
 
     LOG_INFO("Setting pins behaviour from <indiduino> tags");
 
+    for (auto &refs : pinProperties)
+        refs.clear();
+    textProperties.clear();
+
     for (const auto &it: *getProperties())
     {
         const char *name = it->getName();
@@ -789,6 +817,7 @@ bool indiduino::setPinModesFromSKEL()
                     iopin[numiopin].defVectorName = svp->name;
                     iopin[numiopin].defName       = sqp->name;
                     int pin                       = iopin[numiopin].pin;
+                    indexPinProperty(pin, INDI_SWITCH, svp);
                     if (iopin[numiopin].IOType == DO)
                     {
                         LOGF_DEBUG("%s.%s  pin %u set as DIGITAL OUTPUT", svp->name, sqp->name, pin);
@@ -839,6 +868,8 @@ bool indiduino::setPinModesFromSKEL()
                     }
                     tvp->aux                      = (void *)indiduino_id;
                     tqp->aux0                     = (void *)&sf->string_buffer;
+                    if (std::find(textProperties.begin(), textProperties.end(), tvp) == textProperties.end())
+                        textProperties.push_back(tvp);
                     iopin[numiopin].defVectorName = tvp->name;
                     iopin[numiopin].defName       = tqp->name;
                     LOGF_DEBUG("%s.%s ARDUINO TEXT", tvp->name, tqp->name);
@@ -875,6 +906,7 @@ bool indiduino::setPinModesFromSKEL()
                     iopin[numiopin].defVectorName = lvp->name;
                     iopin[numiopin].defName       = lqp->name;
                     int pin                       = iopin[numiopin].pin;
+                    indexPinProperty(pin, INDI_LIGHT, lvp);
                     LOGF_DEBUG("%s.%s  pin %u set as DIGITAL INPUT", lvp->name, lqp->name, pin);
                     sf->setPinMode(pin, FIRMATA_MODE_INPUT);
                     LOGF_DEBUG("numiopin:%u", numiopin);
@@ -911,6 +943,7 @@ bool indiduino::setPinModesFromSKEL()
                     iopin[numiopin].defVectorName = nvp->name;
                     iopin[numiopin].defName       = eqp->name;
                     int pin                       = iopin[numiopin].pin;
+                    indexPinProperty(pin, INDI_NUMBER, nvp);
                     if (iopin[numiopin].IOType == AO)
                     {
                         LOGF_DEBUG("%s.%s  pin %u set as ANALOG OUTPUT", nvp->name, eqp->name, pin);
@@ -935,9 +968,25 @@ bool indiduino::setPinModesFromSKEL()
     sf->setSamplingInterval(getCurrentPollingPeriod() / 2);
     sf->reportAnalogPorts(1);
     sf->reportDigitalPorts(1);
+
+    // Refresh every mapped property once on the first poll
+    sf->dirty_pins.set();
+    sf->string_dirty = true;
     return true;
 }
 
+void indiduino::indexPinProperty(int pin, INDI_PROPERTY_TYPE type, void *vp)
+{
+    if (pin < 0 || pin >= MAX_IO_PIN)
+        return;
+
+    for (const auto &ref : pinProperties[pin])
+        if (ref.vp == vp)
+            return;
+
+    pinProperties[pin].push_back({type, vp});
+}
+
 bool indiduino::readInduinoXml(XMLEle *ioep, int npin)
 {
     char *propertyTag;
@@ -26,6 +26,8 @@
 
 #include <defaultdevice.h>
 
+#include <vector>
+
 namespace Connection
 {
 class Serial;
@@ -98,8 +100,23 @@ class indiduino : public INDI::DefaultDevice
     char skelFileName[MAX_SKELTON_FILE_NAME_LEN];
     IO iopin[MAX_IO_PIN];
 
+    /* Vector properties wired to a Firmata pin, indexed by pin number when
+       the skeleton is mapped so TimerHit only visits changed pins */
+    typedef struct
+    {
+        INDI_PROPERTY_TYPE type;
+        void *vp;
+    } PinProperty;
+    std::vector<PinProperty> pinProperties[MAX_IO_PIN];
+    std::vector<ITextVectorProperty *> textProperties;
+
     bool setPinModesFromSKEL();
     bool readInduinoXml(XMLEle *ioep, int npin);
+    void indexPinProperty(int pin, INDI_PROPERTY_TYPE type, void *vp);
+    void updateLightPins(ILightVectorProperty *lvp);
+    void updateSwitchPins(ISwitchVectorProperty *svp);
+    void updateNumberPins(INumberVectorProperty *nvp);
+    void updateTextBuffer(ITextVectorProperty *tvp);
     Firmata *sf;
     INDI::Controller *controller;
 
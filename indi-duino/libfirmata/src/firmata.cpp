@@ -269,6 +269,7 @@ int Firmata::askPinStateWaitForReply(int pin)
     }
     if (pin_info[pin].mode == 0xff) {
         pin_info[pin].mode = FIRMATA_MODE_INPUT;
+        dirty_pins.set(pin);
         return -1;
     }
     return 0;
@@ -407,6 +408,8 @@ void Firmata::DoMessage(void)
         {
             if (pin_info[pin].analog_channel == analog_ch)
             {
+                if (pin_info[pin].value != static_cast<uint64_t>(analog_val))
+                    dirty_pins.set(pin);
                 pin_info[pin].value = analog_val;
                 LOGF_DEBUG("ANALOG_MESSAGE: pin %d is A%d = %d", pin, analog_ch, analog_val);
                 return;
@@ -429,6 +432,7 @@ void Firmata::DoMessage(void)
                 {
                     LOGF_DEBUG("pin %d is %d", pin, val);
                     pin_info[pin].value = val;
+                    dirty_pins.set(pin);
                 }
             }
         }
@@ -512,6 +516,7 @@ void Firmata::DoMessage(void)
                 pin_info[pin].value |= (parse_buf[5] << 7);
             if (parse_count > 7)
                 pin_info[pin].value |= (parse_buf[6] << 14);
+            dirty_pins.set(pin);
             LOGF_DEBUG("PIN_STATE_RESPONSE: pin:%u. Mode:%u. Value:%llu", pin, pin_info[pin].mode, static_cast<unsigned long long>(pin_info[pin].value));
             if (pin_info[pin].mode == FIRMATA_MODE_OUTPUT)
                 updateDigitalPort(pin, pin_info[pin].value ? ARDUINO_HIGH : ARDUINO_LOW);
@@ -532,6 +537,7 @@ void Firmata::DoMessage(void)
             }
             name[len++] = 0;
             strcpy(string_buffer, name);
+            string_dirty = true;
             LOGF_DEBUG("STRING_DATA: %s", name);
         }
         else if (parse_buf[1] == FIRMATA_EXTENDED_ANALOG)
@@ -548,6 +554,8 @@ void Firmata::DoMessage(void)
             {
                 if (pin_info[pin].analog_channel == analog_ch)
                 {
+                    if (pin_info[pin].value != analog_val)
+                        dirty_pins.set(pin);
                     pin_info[pin].value = analog_val;
                     LOGF_DEBUG("EXTENDED_ANALOG: pin %d is A%d = %lu", pin, analog_ch, analog_val);
                     break;
@@ -11,6 +11,7 @@
    Firmata C++ library. 
 */
 
+#include <bitset>
 #include <vector>
 #include <stdint.h>
 #include <arduino.h>
@@ -117,6 +118,9 @@ class Firmata
     void print_state();
     char firmata_name[140];
     char string_buffer[MAX_STRING_DATA_LEN];
+    // Set by the message handlers when a pin's mode or value (or the string buffer) changed; cleared by the consumer
+    bitset<128> dirty_pins;
+    bool string_dirty { false };
     int OnIdle();
     bool portOpen;
 
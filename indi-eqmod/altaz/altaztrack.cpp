@@ -0,0 +1,148 @@
+/* This file is part of the Skywatcher Protocol INDI driver.
+
+    The Skywatcher Protocol INDI driver is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Skywatcher Protocol INDI driver is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Skywatcher Protocol INDI driver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "altaztrack.h"
+
+#include <math.h>
+
+#define ALTAZ_SIDEREAL_RATIO 1.00273790935 /* sidereal seconds per solar second */
+
+static inline double altazRadians(double degrees)
+{
+    return degrees * M_PI / 180.0;
+}
+
+static inline double altazDegrees(double radians)
+{
+    return radians * 180.0 / M_PI;
+}
+
+// Not named range360: unity builds may merge this file with ones including indicom.h
+static inline double altazRange360(double angle)
+{
+    angle = fmod(angle, 360.0);
+    return (angle < 0.0) ? angle + 360.0 : angle;
+}
+
+static inline double altazRange180(double angle)
+{
+    return remainder(angle, 360.0);
+}
+
+void AltAzTrack::equatorialToHorizontal(double ha, double dec, double latitude, double *az, double *alt)
+{
+    double h = altazRadians(ha * 15.0), d = altazRadians(dec), l = altazRadians(latitude);
+
+    *alt = altazDegrees(asin(sin(d) * sin(l) + cos(d) * cos(l) * cos(h)));
+    *az  = altazRange360(altazDegrees(atan2(-cos(d) * sin(h), sin(d) * cos(l) - cos(d) * sin(l) * cos(h))));
+}
+
+void AltAzTrack::horizontalToEquatorial(double az, double alt, double latitude, double *ha, double *dec)
+{
+    double a = altazRadians(az), e = altazRadians(alt), l = altazRadians(latitude);
+
+    *dec = altazDegrees(asin(sin(e) * sin(l) + cos(e) * cos(l) * cos(a)));
+    *ha  = altazRange360(altazDegrees(atan2(-cos(e) * sin(a), sin(e) * cos(l) - cos(e) * sin(l) * cos(a)))) / 15.0;
+}
+
+void AltAzTrack::setTarget(double ra, double dec)
+{
+    targetRA   = ra;
+    targetDE   = dec;
+    targetSet  = true;
+    azRate     = 0.0;
+    altRate    = 0.0;
+    keyhole    = false;
+    error      = 0.0;
+    errorSum2  = 0.0;
+    errorMax   = 0.0;
+    errorCount = 0;
+}
+
+void AltAzTrack::moveTarget(double dra, double ddec)
+{
+    targetRA = fmod(targetRA + dra / 3600.0 / 15.0 + 24.0, 24.0);
+    targetDE += ddec / 3600.0;
+    if (targetDE > 90.0)
+        targetDE = 90.0;
+    else if (targetDE < -90.0)
+        targetDE = -90.0;
+}
+
+void AltAzTrack::guideRates(double lst, double raRate, double decRate, double *azRate, double *altRate) const
+{
+    // Horizontal motion over one second, guide rates are a small fraction of the sky's
+    double az0, alt0, az1, alt1;
+    equatorialToHorizontal(lst - targetRA, targetDE, latitude, &az0, &alt0);
+    equatorialToHorizontal(lst - targetRA - raRate / 3600.0 / 15.0, targetDE + decRate / 3600.0, latitude, &az1, &alt1);
+
+    *azRate  = altazRange180(az1 - az0) * 3600.0;
+    *altRate = (alt1 - alt0) * 3600.0;
+}
+
+void AltAzTrack::clearTarget()
+{
+    targetSet = false;
+    azRate    = 0.0;
+    altRate   = 0.0;
+    keyhole   = false;
+}
+
+void AltAzTrack::update(double lst, double az, double alt)
+{
+    if (!targetSet)
+        return;
+
+    // Where the target is now and at the next update
+    double az0, alt0, az1, alt1;
+    equatorialToHorizontal(lst - targetRA, targetDE, latitude, &az0, &alt0);
+    equatorialToHorizontal(lst + period * ALTAZ_SIDEREAL_RATIO / 3600.0 - targetRA, targetDE, latitude, &az1, &alt1);
+
+    double ffaz  = altazRange180(az1 - az0) * 3600.0 / period;
+    double ffalt = (alt1 - alt0) * 3600.0 / period;
+
+    double erraz  = altazRange180(az0 - az);
+    double erralt = alt0 - alt;
+
+    keyhole = (alt0 >= keyholeAltitude) || (fabs(ffaz) > maxRate);
+    if (keyhole && (fabs(erraz) > 90.0) && (erraz * ffaz < 0.0))
+        erraz += (erraz < 0.0) ? 360.0 : -360.0;
+
+    azRate  = ffaz + gain * erraz * 3600.0 / period;
+    altRate = ffalt + gain * erralt * 3600.0 / period;
+
+    if (fabs(azRate) > maxRate)
+    {
+        azRate  = copysign(maxRate, azRate);
+        keyhole = true;
+    }
+    if (fabs(altRate) > maxRate)
+        altRate = copysign(maxRate, altRate);
+
+    // Great circle distance between target and axes
+    double s1 = sin(altazRadians(alt0 - alt) / 2.0), s2 = sin(altazRadians(az0 - az) / 2.0);
+    double h  = s1 * s1 + cos(altazRadians(alt0)) * cos(altazRadians(alt)) * s2 * s2;
+    error     = altazDegrees(2.0 * asin(fmin(1.0, sqrt(h)))) * 3600.0;
+    errorSum2 += error * error;
+    errorCount += 1;
+    if (error > errorMax)
+        errorMax = error;
+}
+
+double AltAzTrack::getErrorRMS() const
+{
+    return (errorCount > 0) ? sqrt(errorSum2 / errorCount) : 0.0;
+}
@@ -0,0 +1,89 @@
+/* This file is part of the Skywatcher Protocol INDI driver.
+
+    The Skywatcher Protocol INDI driver is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Skywatcher Protocol INDI driver is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Skywatcher Protocol INDI driver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/*
+ * Tracking controller for mounts set up in alt-az.
+ *
+ * The target is held as fixed RA/Dec. Each update gives the azimuth and
+ * altitude axis rates to hold until the next one: the feed-forward part is the
+ * target's mean horizontal motion over the coming period, so the change of rate
+ * along the period is already accounted for, and the feedback part removes a
+ * fraction of the current position error.
+ *
+ * Close to the zenith the azimuth rate grows without bound. Rates are limited
+ * to what the axis can track, and inside the keyhole the azimuth error is made
+ * to follow the direction the target turns, so the mount catches up after the
+ * transit instead of turning back the long way.
+ *
+ * Angles are in degrees, azimuth from north through east, hour angle and LST
+ * in hours. Rates are in arcsecs/s of axis motion.
+ */
+class AltAzTrack
+{
+  public:
+    static void equatorialToHorizontal(double ha, double dec, double latitude, double *az, double *alt);
+    static void horizontalToEquatorial(double az, double alt, double latitude, double *ha, double *dec);
+
+    void setLatitude(double latitude) { this->latitude = latitude; }
+    void setPeriod(double seconds) { period = seconds; }
+    void setGain(double gain) { this->gain = gain; }
+    void setMaxRate(double rate) { maxRate = rate; }
+    void setKeyhole(double altitude) { keyholeAltitude = altitude; }
+
+    void setTarget(double ra, double dec);
+    // Shift the target, dra in arcsecs of RA axis motion (15 per second of time), ddec in arcsecs
+    void moveTarget(double dra, double ddec);
+    // Axis rates moving the pointing at the target by the given RA axis and Dec rates, arcsecs/s
+    void guideRates(double lst, double raRate, double decRate, double *azRate, double *altRate) const;
+    void clearTarget();
+    bool hasTarget() const { return targetSet; }
+    double getTargetRA() const { return targetRA; }
+    double getTargetDE() const { return targetDE; }
+
+    // Compute the axis rates from the axis position read at the given LST
+    void update(double lst, double az, double alt);
+
+    double getAzRate() const { return azRate; }
+    double getAltRate() const { return altRate; }
+    bool inKeyhole() const { return keyhole; }
+
+    // Pointing error at the last update and since the target was set, arcsecs on the sky
+    double getError() const { return error; }
+    double getErrorRMS() const;
+    double getErrorMax() const { return errorMax; }
+
+  private:
+    double latitude { 0.0 };
+    double period { 1.0 };
+    double gain { 0.5 };
+    double maxRate { 1504.1 };
+    double keyholeAltitude { 87.0 };
+
+    bool targetSet { false };
+    double targetRA { 0.0 };
+    double targetDE { 0.0 };
+
+    double azRate { 0.0 };
+    double altRate { 0.0 };
+    bool keyhole { false };
+
+    double error { 0.0 };
+    double errorSum2 { 0.0 };
+    double errorMax { 0.0 };
+    unsigned int errorCount { 0 };
+};
@@ -43,3 +43,9 @@ bool AZGTIBase::initProperties()
 
     return true;
 }
+
+bool AZGTIBase::HasAltAzMode()
+{
+    // The AZ-GTi may be set up in alt-az as well as on a wedge
+    return AltAzModeSP && AltAzSettingsNP && AltAzStatusNP;
+}
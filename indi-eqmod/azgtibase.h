@@ -27,5 +27,6 @@ class AZGTIBase : public EQMod
     protected:
         virtual const char *getDefaultName();
         virtual bool initProperties();
+        virtual bool HasAltAzMode();
 };
 
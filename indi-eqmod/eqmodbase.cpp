@@ -34,6 +34,7 @@
 
 #include "mach_gettime.h"
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <cstring>
@@ -65,6 +66,12 @@ using namespace INDI::AlignmentSubsystem;
 #define RAGOTORESOLUTION     5 /* GOTO Resolution in arcsecs */
 #define DEGOTORESOLUTION     5 /* GOTO Resolution in arcsecs */
 
+#define SOFTPEC_RATE_STEP      0.005 /* Resend RA rate when software PEC changes by this (arcsecs/s) */
+#define SOFTPEC_MAX_RATE_RATIO 0.5   /* Software PEC rate limit as a fraction of the tracking rate */
+
+#define ALTAZ_RATE_STEP 0.01                              /* Resend an alt-az axis rate when it changes by this (arcsecs/s) */
+#define ALTAZ_MIN_RATE  (0.05 * SKYWATCHER_STELLAR_SPEED) /* Slowest axis rate, the axis is stopped below (arcsecs/s) */
+
 /* Preset Slew Speeds */
 #define SLEWMODES 11
 double slewspeeds[SLEWMODES - 1] = { 1.0, 2.0, 4.0, 8.0, 32.0, 64.0, 128.0, 600.0, 700.0, 800.0 };
@@ -431,6 +438,14 @@ bool EQMod::loadProperties()
     LEDBrightnessNP     = getNumber("LED_BRIGHTNESS");
     SNAPPORT1SP         = getSwitch("SNAPPORT1");
     SNAPPORT2SP         = getSwitch("SNAPPORT2");
+    SoftPECTrainingSP   = getSwitch("SOFTPEC_TRAINING");
+    SoftPECSP           = getSwitch("SOFTPEC");
+    SoftPECSettingsNP   = getNumber("SOFTPEC_SETTINGS");
+    SoftPECStatusNP     = getNumber("SOFTPEC_STATUS");
+    SoftPECFileTP       = getText("SOFTPEC_FILE");
+    AltAzModeSP         = getSwitch("ALTAZ_MODE");
+    AltAzSettingsNP     = getNumber("ALTAZ_SETTINGS");
+    AltAzStatusNP       = getNumber("ALTAZ_STATUS");
 #ifdef WITH_ALIGN_GEEHALEL
     align->initProperties();
 #endif
@@ -567,6 +582,23 @@ bool EQMod::updateProperties()
                     IDSetSwitch(DEPPECSP, nullptr);
                 }
             }
+            else if (HasSoftPEC())
+            {
+                defineProperty(SoftPECTrainingSP);
+                defineProperty(SoftPECSP);
+                defineProperty(SoftPECSettingsNP);
+                defineProperty(SoftPECStatusNP);
+                defineProperty(SoftPECFileTP);
+                setupSoftPEC();
+            }
+
+            if (HasAltAzMode())
+            {
+                defineProperty(AltAzModeSP);
+                defineProperty(AltAzSettingsNP);
+                defineProperty(AltAzStatusNP);
+                setupAltAz();
+            }
 
             if (mount->HasPolarLed())
             {
@@ -590,6 +622,16 @@ bool EQMod::updateProperties()
 
             mount->Init();
 
+            // The software PEC worm phase is taken from the RA encoder, which only keeps it
+            // across a power cycle when the mount was parked
+            if (HasSoftPEC() && softpec.hasCurve() && !mount->WasInitialized() && !isParked())
+            {
+                SoftPECStatusNP->s = IPS_ALERT;
+                IDSetNumber(SoftPECStatusNP, nullptr);
+                LOG_WARN("Mount was powered up unparked, the software PEC curve is out of phase with the worm. "
+                         "Retrain software PEC before turning it on.");
+            }
+
             zeroRAEncoder  = mount->GetRAEncoderZero();
             totalRAEncoder = mount->GetRAEncoderTotal();
             homeRAEncoder  = mount->GetRAEncoderHome();
@@ -664,6 +706,32 @@ bool EQMod::updateProperties()
             deleteProperty(DEPPECTrainingSP->name);
             deleteProperty(DEPPECSP->name);
         }
+        else if (HasSoftPEC())
+        {
+            IUResetSwitch(SoftPECTrainingSP);
+            SoftPECTrainingSP->sp[0].s = ISS_ON;
+            SoftPECTrainingSP->s       = IPS_IDLE;
+            IUResetSwitch(SoftPECSP);
+            SoftPECSP->sp[0].s = ISS_ON;
+            SoftPECSP->s       = IPS_IDLE;
+            deleteProperty(SoftPECTrainingSP->name);
+            deleteProperty(SoftPECSP->name);
+            deleteProperty(SoftPECSettingsNP->name);
+            deleteProperty(SoftPECStatusNP->name);
+            deleteProperty(SoftPECFileTP->name);
+        }
+        if (HasAltAzMode())
+        {
+            if (AltAzTimerID != -1)
+            {
+                IERmTimer(AltAzTimerID);
+                AltAzTimerID = -1;
+            }
+            altaz.clearTarget();
+            deleteProperty(AltAzModeSP->name);
+            deleteProperty(AltAzSettingsNP->name);
+            deleteProperty(AltAzStatusNP->name);
+        }
         if (mount->HasSnapPort1())
         {
             deleteProperty(SNAPPORT1SP->name);
@@ -1131,6 +1199,8 @@ bool EQMod::ReadScopeStatus()
                 }
             }
         }
+        else if (HasSoftPEC())
+            updateSoftPEC();
 
         if (AutohomeState == AUTO_HOME_CONFIRM)
         {
@@ -1473,6 +1543,19 @@ void EQMod::EncodersToRADec(uint32_t rastep, uint32_t destep, double lst, double
 {
     double RACurrent = 0.0, DECurrent = 0.0, HACurrent = 0.0;
     TelescopePierSide p;
+    if (AltAzMode())
+    {
+        double az, alt;
+        EncodersToAltAz(rastep, destep, &az, &alt);
+        AltAzTrack::horizontalToEquatorial(az, alt, getLatitude(), &HACurrent, &DECurrent);
+        *ra = range24(lst - HACurrent);
+        *de = DECurrent;
+        if (ha)
+            *ha = rangeHA(-HACurrent);
+        if (pierSide)
+            *pierSide = PIER_UNKNOWN;
+        return;
+    }
     HACurrent = EncoderToHours(rastep, zeroRAEncoder, totalRAEncoder, Hemisphere);
     RACurrent = HACurrent + lst;
     DECurrent = EncoderToDegrees(destep, zeroDEEncoder, totalDEEncoder, Hemisphere);
@@ -1646,6 +1729,17 @@ void EQMod::EncoderTarget(GotoParams *g)
     juliandate = getJulianDate();
     lst        = getLst(juliandate, getLongitude());
 
+    if (AltAzMode())
+    {
+        double az, alt;
+        AltAzTrack::equatorialToHorizontal(lst - r, d, getLatitude(), &az, &alt);
+        EncodersFromAltAz(az, alt, &targetraencoder, &targetdecencoder);
+        g->outsidelimits   = g->checklimits && (alt < 0.0);
+        g->ratargetencoder = targetraencoder;
+        g->detargetencoder = targetdecencoder;
+        return;
+    }
+
     if (g->pier_side == PIER_UNKNOWN)
     {
         // decide pier side and keep it consistent in iterative calls
@@ -1688,6 +1782,8 @@ double EQMod::GetRATrackRate()
 {
     double rate = 0.0;
     ISwitch *sw;
+    if (AltAzMode())
+        return altazLastRate[0];
     sw = IUFindOnSwitch(&TrackModeSP);
     if (!sw)
         return 0.0;
@@ -1711,13 +1807,15 @@ double EQMod::GetRATrackRate()
         return 0.0;
     if (RAInverted)
         rate = -rate;
-    return rate;
+    return rate + GetSoftPECRate(rate);
 }
 
 double EQMod::GetDETrackRate()
 {
     double rate = 0.0;
     ISwitch *sw;
+    if (AltAzMode())
+        return altazLastRate[1];
     sw = IUFindOnSwitch(&TrackModeSP);
     if (!sw)
         return 0.0;
@@ -1748,6 +1846,8 @@ double EQMod::GetDefaultRATrackRate()
 {
     double rate = 0.0;
     ISwitch *sw;
+    if (AltAzMode())
+        return altazLastRate[0];
     sw = IUFindOnSwitch(TrackDefaultSP);
     if (!sw)
         return 0.0;
@@ -1778,6 +1878,8 @@ double EQMod::GetDefaultDETrackRate()
 {
     double rate = 0.0;
     ISwitch *sw;
+    if (AltAzMode())
+        return altazLastRate[1];
     sw = IUFindOnSwitch(TrackDefaultSP);
     if (!sw)
         return 0.0;
@@ -1804,6 +1906,401 @@ double EQMod::GetDefaultDETrackRate()
     return rate;
 }
 
+bool EQMod::HasSoftPEC()
+{
+    // Older skeleton files do not define the software PEC properties
+    return SoftPECTrainingSP && SoftPECSP && SoftPECSettingsNP && SoftPECStatusNP && SoftPECFileTP;
+}
+
+void EQMod::setupSoftPEC()
+{
+    uint32_t stepsworm = static_cast<uint32_t>(IUFindNumber(SoftPECSettingsNP, "SOFTPEC_WORM_STEPS")->value);
+    char filename[256];
+    char devname[MAXINDIDEVICE];
+
+    if (stepsworm == 0)
+    {
+        mount->InquireRAPECPeriod();
+        stepsworm = mount->GetRAStepsPEC();
+    }
+    softpec.setGeometry(mount->GetRAEncoderTotal(), stepsworm);
+
+    if (!softpec.hasGeometry())
+    {
+        LOG_WARN("Mount does not report its worm period, set SOFTPEC_WORM_STEPS to use software PEC.");
+        IUSaveText(&SoftPECFileTP->tp[0], "");
+        IDSetText(SoftPECFileTP, nullptr);
+        updateSoftPECStatus();
+        return;
+    }
+
+    strncpy(devname, getDeviceName(), MAXINDIDEVICE - 1);
+    devname[MAXINDIDEVICE - 1] = '\0';
+    for (char *c = devname; *c; c++)
+        if (*c == ' ')
+            *c = '_';
+    snprintf(filename, sizeof(filename), "~/.indi/%s_SoftPEC_%u_%u.txt", devname, softpec.getStepsTotal(),
+             softpec.getStepsWorm());
+    IUSaveText(&SoftPECFileTP->tp[0], filename);
+    IDSetText(SoftPECFileTP, nullptr);
+
+    LOGF_INFO("Software PEC worm period is %u microsteps.", softpec.getStepsWorm());
+    if (!softpec.hasCurve())
+    {
+        if (softpec.load(filename))
+            LOGF_INFO("Loaded software PEC curve from %s (%.1f arcsecs peak to peak).", filename, softpec.amplitude());
+        else
+            LOGF_DEBUG("No software PEC curve in %s.", filename);
+    }
+    updateSoftPECStatus();
+}
+
+void EQMod::updateSoftPEC()
+{
+    if (SoftPECTrainingSP->s == IPS_BUSY)
+    {
+        if (TrackState != SCOPE_TRACKING)
+        {
+            LOG_WARN("Scope stopped tracking, ending software PEC training.");
+            stopSoftPECTraining();
+            return;
+        }
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        softpec.addSample(now.tv_sec + now.tv_nsec / 1e9, currentRAEncoder, softpecCorrection);
+        updateSoftPECStatus();
+        return;
+    }
+
+    if ((SoftPECSP->s != IPS_BUSY) || (TrackState != SCOPE_TRACKING) || (pulseInProgress & 2) || gotoInProgress() ||
+            AltAzMode())
+        return;
+
+    // Only resend the rate when the correction moved enough to matter
+    double rate = GetRATrackRate();
+    if (fabs(rate - softpecLastRate) < SOFTPEC_RATE_STEP)
+        return;
+    try
+    {
+        mount->StartRATracking(rate);
+        softpecLastRate = rate;
+    }
+    catch (EQModError e)
+    {
+        LOG_WARN("Unable to update RA tracking rate for software PEC.");
+    }
+}
+
+void EQMod::stopSoftPECTraining()
+{
+    unsigned int nharmonics = static_cast<unsigned int>(IUFindNumber(SoftPECSettingsNP, "SOFTPEC_HARMONICS")->value);
+
+    IUResetSwitch(SoftPECTrainingSP);
+    SoftPECTrainingSP->sp[0].s = ISS_ON;
+    if (softpec.fit(nharmonics))
+    {
+        SoftPECTrainingSP->s = IPS_OK;
+        LOGF_INFO("Software PEC training done: %.1f arcsecs peak to peak over %.1f worm periods.", softpec.amplitude(),
+                  softpec.trainedPeriods());
+        if (!softpec.save(SoftPECFileTP->tp[0].text))
+            LOGF_WARN("Unable to save software PEC curve to %s.", SoftPECFileTP->tp[0].text);
+    }
+    else
+    {
+        SoftPECTrainingSP->s = IPS_ALERT;
+        LOGF_WARN("Software PEC training stopped after %.2f worm periods, at least one full period is needed.",
+                  softpec.trainedPeriods());
+    }
+    IDSetSwitch(SoftPECTrainingSP, nullptr);
+    updateSoftPECStatus();
+}
+
+void EQMod::updateSoftPECStatus()
+{
+    IUFindNumber(SoftPECStatusNP, "SOFTPEC_PERIODS")->value   = softpec.trainedPeriods();
+    IUFindNumber(SoftPECStatusNP, "SOFTPEC_AMPLITUDE")->value = softpec.amplitude();
+    SoftPECStatusNP->s = (SoftPECTrainingSP->s == IPS_BUSY) ? IPS_BUSY : IPS_IDLE;
+    IDSetNumber(SoftPECStatusNP, nullptr);
+}
+
+void EQMod::recordSoftPECGuide(double rateshift, uint32_t ms)
+{
+    if (!HasSoftPEC() || (SoftPECTrainingSP->s != IPS_BUSY))
+        return;
+    // Cumulated correction in arcsecs, signed as the RA tracking rate
+    softpecCorrection += rateshift * ms / 1000.0;
+}
+
+double EQMod::GetSoftPECRate(double trackrate)
+{
+    if (!HasSoftPEC() || (SoftPECSP->s != IPS_BUSY) || (trackrate == 0.0))
+        return 0.0;
+    double rate  = IUFindNumber(SoftPECSettingsNP, "SOFTPEC_GAIN")->value * softpec.rateAt(currentRAEncoder, trackrate);
+    double limit = SOFTPEC_MAX_RATE_RATIO * fabs(trackrate);
+    return std::max(-limit, std::min(limit, rate));
+}
+
+bool EQMod::HasAltAzMode()
+{
+    // Only mounts which may be set up in alt-az offer the mode
+    return false;
+}
+
+bool EQMod::AltAzMode()
+{
+    return HasAltAzMode() && (AltAzModeSP->sp[1].s == ISS_ON);
+}
+
+void EQMod::EncodersToAltAz(uint32_t rastep, uint32_t destep, double *az, double *alt)
+{
+    double altsign = (ReverseDECSP->sp[0].s == ISS_ON) ? -1.0 : 1.0;
+    *az  = range360(altazOffset[0] + static_cast<int32_t>(rastep - zeroRAEncoder) * 360.0 / totalRAEncoder);
+    *alt = altazOffset[1] + altsign * static_cast<int32_t>(destep - zeroDEEncoder) * 360.0 / totalDEEncoder;
+}
+
+void EQMod::EncodersFromAltAz(double az, double alt, uint32_t *rastep, uint32_t *destep)
+{
+    // Zero encoders are the level north home position, azimuth turns at most half a revolution from there
+    double altsign = (ReverseDECSP->sp[0].s == ISS_ON) ? -1.0 : 1.0;
+    *rastep = zeroRAEncoder + static_cast<int32_t>(round(remainder(az - altazOffset[0], 360.0) * totalRAEncoder / 360.0));
+    *destep = zeroDEEncoder + static_cast<int32_t>(round(altsign * (alt - altazOffset[1]) * totalDEEncoder / 360.0));
+}
+
+void EQMod::setupAltAz()
+{
+    altaz.clearTarget();
+    altazLastRate[0] = 0.0;
+    altazLastRate[1] = 0.0;
+    if (AltAzTimerID == -1)
+        AltAzTimerID = IEAddTimer(static_cast<int>(IUFindNumber(AltAzSettingsNP, "ALTAZ_PERIOD")->value * 1000),
+                                  (IE_TCF *)altazTimerCallback, this);
+    updateAltAzStatus();
+}
+
+void EQMod::altazTimerCallback(void *userpointer)
+{
+    EQMod *p = static_cast<EQMod *>(userpointer);
+    p->updateAltAzTracking();
+    if (p->isConnected())
+        p->AltAzTimerID = IEAddTimer(static_cast<int>(IUFindNumber(p->AltAzSettingsNP, "ALTAZ_PERIOD")->value * 1000),
+                                     (IE_TCF *)altazTimerCallback, p);
+    else
+        p->AltAzTimerID = -1;
+}
+
+void EQMod::updateAltAzTracking()
+{
+    // Gotos, slews and parking drive the axes themselves
+    if (!AltAzMode() || (TrackState != SCOPE_TRACKING) || gotoInProgress())
+    {
+        if (altaz.hasTarget())
+            stopAltAzTracking();
+        return;
+    }
+    // Rates are held while pulses run, the target moves when they end
+    if (pulseInProgress != 0)
+        return;
+
+    try
+    {
+        double lst = getLst(getJulianDate(), getLongitude());
+        double az, alt;
+        EncodersToAltAz(mount->GetRAEncoder(), mount->GetDEEncoder(), &az, &alt);
+
+        altaz.setLatitude(getLatitude());
+        altaz.setPeriod(IUFindNumber(AltAzSettingsNP, "ALTAZ_PERIOD")->value);
+        altaz.setGain(IUFindNumber(AltAzSettingsNP, "ALTAZ_GAIN")->value);
+        altaz.setMaxRate(IUFindNumber(AltAzSettingsNP, "ALTAZ_MAX_RATE")->value * TRACKRATE_SIDEREAL);
+        altaz.setKeyhole(IUFindNumber(AltAzSettingsNP, "ALTAZ_KEYHOLE")->value);
+        if (!altaz.hasTarget())
+        {
+            double ha, dec;
+            AltAzTrack::horizontalToEquatorial(az, alt, getLatitude(), &ha, &dec);
+            altaz.setTarget(range24(lst - ha), dec);
+            LOGF_INFO("Alt-az tracking from Az %.3f Alt %.3f.", az, alt);
+        }
+
+        bool keyhole = altaz.inKeyhole();
+        altaz.update(lst, az, alt);
+        if (altaz.inKeyhole() != keyhole)
+        {
+            if (altaz.inKeyhole())
+                LOG_WARN("Target in the zenith keyhole, azimuth rate is limited.");
+            else
+                LOG_INFO("Target out of the zenith keyhole.");
+        }
+
+        sendAltAzRates();
+        updateAltAzStatus();
+    }
+    catch (EQModError &e)
+    {
+        e.DefaultHandleException(this);
+    }
+}
+
+void EQMod::sendAltAzRates()
+{
+    double maxrate  = IUFindNumber(AltAzSettingsNP, "ALTAZ_MAX_RATE")->value * TRACKRATE_SIDEREAL;
+    double altsign  = (ReverseDECSP->sp[0].s == ISS_ON) ? -1.0 : 1.0;
+    double rates[2] = { altaz.getAzRate() + altazPulseAxisRate[0][0] + altazPulseAxisRate[1][0],
+                        altsign * (altaz.getAltRate() + altazPulseAxisRate[0][1] + altazPulseAxisRate[1][1])
+                      };
+    for (int axis = 0; axis < 2; axis++)
+    {
+        double rate = (fabs(rates[axis]) < ALTAZ_MIN_RATE) ? 0.0 : rates[axis];
+        if (fabs(rate) > maxrate)
+            rate = copysign(maxrate, rate);
+        if (fabs(rate - altazLastRate[axis]) < ALTAZ_RATE_STEP)
+            continue;
+        // Motors only change direction once stopped
+        if (rate * altazLastRate[axis] < 0.0)
+        {
+            if (axis == 0)
+                mount->StopRA();
+            else
+                mount->StopDE();
+        }
+        if (axis == 0)
+            mount->StartRATracking(rate);
+        else
+            mount->StartDETracking(rate);
+        altazLastRate[axis] = rate;
+    }
+}
+
+void EQMod::stopAltAzTracking()
+{
+    altaz.clearTarget();
+    altazLastRate[0] = 0.0;
+    altazLastRate[1] = 0.0;
+    for (int i = 0; i < 2; i++)
+    {
+        altazPulseAxisRate[i][0] = 0.0;
+        altazPulseAxisRate[i][1] = 0.0;
+    }
+    updateAltAzStatus();
+}
+
+void EQMod::updateAltAzStatus()
+{
+    IUFindNumber(AltAzStatusNP, "ALTAZ_AZ_RATE")->value   = altaz.getAzRate();
+    IUFindNumber(AltAzStatusNP, "ALTAZ_ALT_RATE")->value  = altaz.getAltRate();
+    IUFindNumber(AltAzStatusNP, "ALTAZ_ERROR")->value     = altaz.getError();
+    IUFindNumber(AltAzStatusNP, "ALTAZ_ERROR_RMS")->value = altaz.getErrorRMS();
+    IUFindNumber(AltAzStatusNP, "ALTAZ_ERROR_MAX")->value = altaz.getErrorMax();
+    if (!altaz.hasTarget())
+        AltAzStatusNP->s = IPS_IDLE;
+    else
+        AltAzStatusNP->s = altaz.inKeyhole() ? IPS_ALERT : IPS_BUSY;
+    IDSetNumber(AltAzStatusNP, nullptr);
+}
+
+void EQMod::syncAltAz(double ra, double dec, double lst, uint32_t raencoder, uint32_t deencoder)
+{
+    // Move the axes zero rather than the sky, the offset then holds all over the sky
+    double az, alt, targetaz, targetalt;
+    EncodersToAltAz(raencoder, deencoder, &az, &alt);
+    AltAzTrack::equatorialToHorizontal(lst - ra, dec, getLatitude(), &targetaz, &targetalt);
+    altazOffset[0] = range360(altazOffset[0] + targetaz - az);
+    altazOffset[1] += targetalt - alt;
+    altaz.clearTarget();
+    LOGF_INFO("Alt-az axes synced: zero encoders at Az %.4f Alt %.4f.", altazOffset[0], altazOffset[1]);
+}
+
+IPState EQMod::guideAltAz(double rate, uint32_t ms, INDI_EQ_AXIS axis)
+{
+    // Pulses only apply on top of tracking
+    if (!altaz.hasTarget())
+        return IPS_IDLE;
+
+    int i = (axis == AXIS_RA) ? 0 : 1;
+    if (i == 0 && (pulseInProgress & 2))
+    {
+        IERmTimer(GuideTimerWE);
+        endGuideAltAz(AXIS_RA);
+    }
+    else if (i == 1 && (pulseInProgress & 1))
+    {
+        IERmTimer(GuideTimerNS);
+        endGuideAltAz(AXIS_DE);
+    }
+
+    // The pulse is a rate offset on both axes for its length, as in equatorial mode
+    double lst = getLst(getJulianDate(), getLongitude());
+    altazPulseRate[i] = rate;
+    altaz.guideRates(lst, (i == 0) ? rate : 0.0, (i == 1) ? rate : 0.0, &altazPulseAxisRate[i][0],
+                     &altazPulseAxisRate[i][1]);
+    clock_gettime(CLOCK_MONOTONIC, &altazPulseStart[i]);
+    if (i == 0)
+    {
+        pulseInProgress |= 2;
+        GuideTimerWE = IEAddTimer(ms, (IE_TCF *)altazGuideWECallback, this);
+    }
+    else
+    {
+        pulseInProgress |= 1;
+        GuideTimerNS = IEAddTimer(ms, (IE_TCF *)altazGuideNSCallback, this);
+    }
+
+    try
+    {
+        sendAltAzRates();
+    }
+    catch (EQModError &e)
+    {
+        e.DefaultHandleException(this);
+        return IPS_ALERT;
+    }
+    return IPS_BUSY;
+}
+
+void EQMod::endGuideAltAz(INDI_EQ_AXIS axis)
+{
+    int i = (axis == AXIS_RA) ? 0 : 1;
+    pulseInProgress &= (i == 0) ? ~2 : ~1;
+
+    // The axes moved the pointing for as long as the offset was applied, the target follows
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double shift = altazPulseRate[i] * ((now.tv_sec - altazPulseStart[i].tv_sec) +
+                                        (now.tv_nsec - altazPulseStart[i].tv_nsec) / 1000000000.0);
+    altazPulseRate[i]        = 0.0;
+    altazPulseAxisRate[i][0] = 0.0;
+    altazPulseAxisRate[i][1] = 0.0;
+
+    if (altaz.hasTarget())
+    {
+        altaz.moveTarget((i == 0) ? shift : 0.0, (i == 1) ? shift : 0.0);
+        if (AltAzMode() && (TrackState == SCOPE_TRACKING))
+        {
+            try
+            {
+                sendAltAzRates();
+            }
+            catch (EQModError &e)
+            {
+                e.DefaultHandleException(this);
+            }
+        }
+    }
+    GuideComplete(axis);
+}
+
+void EQMod::altazGuideNSCallback(void *userpointer)
+{
+    EQMod *p = static_cast<EQMod *>(userpointer);
+    p->endGuideAltAz(AXIS_DE);
+    DEBUGDEVICE(p->getDeviceName(), INDI::Logger::DBG_DEBUG, "End Timed guide North/South");
+}
+
+void EQMod::altazGuideWECallback(void *userpointer)
+{
+    EQMod *p = static_cast<EQMod *>(userpointer);
+    p->endGuideAltAz(AXIS_RA);
+    DEBUGDEVICE(p->getDeviceName(), INDI::Logger::DBG_DEBUG, "End Timed guide West/East");
+}
+
 bool EQMod::gotoInProgress()
 {
     return (!gotoparams.completed);
@@ -2107,8 +2604,21 @@ bool EQMod::Sync(double ra, double dec)
     {
         pier_side = TargetPier;
     }
-    tmpsyncdata.targetRAEncoder  = EncoderFromRA(ra, pier_side, lst, zeroRAEncoder, totalRAEncoder, Hemisphere);
-    tmpsyncdata.targetDECEncoder = EncoderFromDec(dec, pier_side, zeroDEEncoder, totalDEEncoder, Hemisphere);
+    if (AltAzMode())
+    {
+        double az, alt;
+#if defined WITH_ALIGN_GEEHALEL || defined WITH_ALIGN
+        if (isStandardSync())
+#endif
+            syncAltAz(ra, dec, lst, tmpsyncdata.telescopeRAEncoder, tmpsyncdata.telescopeDECEncoder);
+        AltAzTrack::equatorialToHorizontal(lst - ra, dec, getLatitude(), &az, &alt);
+        EncodersFromAltAz(az, alt, &tmpsyncdata.targetRAEncoder, &tmpsyncdata.targetDECEncoder);
+    }
+    else
+    {
+        tmpsyncdata.targetRAEncoder  = EncoderFromRA(ra, pier_side, lst, zeroRAEncoder, totalRAEncoder, Hemisphere);
+        tmpsyncdata.targetDECEncoder = EncoderFromDec(dec, pier_side, zeroDEEncoder, totalDEEncoder, Hemisphere);
+    }
 
     try
     {
@@ -2207,6 +2717,9 @@ IPState EQMod::GuideNorth(uint32_t ms)
     double rateshift = TRACKRATE_SIDEREAL * IUFindNumber(GuideRateNP, "GUIDE_RATE_NS")->value;
     LOGF_DEBUG("Timed guide North %d ms at rate %g %s", ms, rateshift, DEInverted ? "(Inverted)" : "");
 
+    if (AltAzMode())
+        return guideAltAz(rateshift, ms, AXIS_DE);
+
     IPState pulseState = IPS_BUSY;
 
     if (DEInverted)
@@ -2290,6 +2803,9 @@ IPState EQMod::GuideSouth(uint32_t ms)
     rateshift        = TRACKRATE_SIDEREAL * IUFindNumber(GuideRateNP, "GUIDE_RATE_NS")->value;
     LOGF_DEBUG("Timed guide South %d ms at rate %g %s", ms, rateshift, DEInverted ? "(Inverted)" : "");
 
+    if (AltAzMode())
+        return guideAltAz(-rateshift, ms, AXIS_DE);
+
     IPState pulseState = IPS_BUSY;
 
     if (DEInverted)
@@ -2372,10 +2888,14 @@ IPState EQMod::GuideEast(uint32_t ms)
     rateshift        = TRACKRATE_SIDEREAL * IUFindNumber(GuideRateNP, "GUIDE_RATE_WE")->value;
     LOGF_DEBUG("Timed guide East %d ms at rate %g %s", ms, rateshift, RAInverted ? "(Inverted)" : "");
 
+    if (AltAzMode())
+        return guideAltAz(rateshift, ms, AXIS_RA);
+
     IPState pulseState = IPS_BUSY;
 
     if (RAInverted)
         rateshift = -rateshift;
+    recordSoftPECGuide(-rateshift, ms);
     try
     {
         if (mount->HasPPEC())
@@ -2455,10 +2975,14 @@ IPState EQMod::GuideWest(uint32_t ms)
     rateshift        = TRACKRATE_SIDEREAL * IUFindNumber(GuideRateNP, "GUIDE_RATE_WE")->value;
     LOGF_DEBUG("Timed guide West %d ms at rate %g %s", ms, rateshift, RAInverted ? "(Inverted)" : "");
 
+    if (AltAzMode())
+        return guideAltAz(-rateshift, ms, AXIS_RA);
+
     IPState pulseState = IPS_BUSY;
 
     if (RAInverted)
         rateshift = -rateshift;
+    recordSoftPECGuide(rateshift, ms);
     try
     {
         if (mount->HasPPEC())
@@ -2615,6 +3139,24 @@ bool EQMod::ISNewNumber(const char *dev, const char *name, double values[], char
             return true;
         }
 
+        if (SoftPECSettingsNP && strcmp(name, SoftPECSettingsNP->name) == 0)
+        {
+            IUUpdateNumber(SoftPECSettingsNP, values, names, n);
+            SoftPECSettingsNP->s = IPS_OK;
+            IDSetNumber(SoftPECSettingsNP, nullptr);
+            if (isConnected() && HasSoftPEC() && !mount->HasPPEC())
+                setupSoftPEC();
+            return true;
+        }
+
+        if (AltAzSettingsNP && strcmp(name, AltAzSettingsNP->name) == 0)
+        {
+            IUUpdateNumber(AltAzSettingsNP, values, names, n);
+            AltAzSettingsNP->s = IPS_OK;
+            IDSetNumber(AltAzSettingsNP, nullptr);
+            return true;
+        }
+
         if (mount->HasPolarLed())
         {
             if (strcmp(name, "LED_BRIGHTNESS") == 0)
@@ -2805,6 +3347,9 @@ bool EQMod::ISNewSwitch(const char *dev, const char *name, ISState *states, char
             {
                 bzero(&syncdata, sizeof(syncdata));
                 bzero(&syncdata2, sizeof(syncdata2));
+                altazOffset[0] = 0.0;
+                altazOffset[1] = 0.0;
+                altaz.clearTarget();
                 IUFindNumber(StandardSyncNP, "STANDARDSYNC_RA")->value = syncdata.deltaRA;
                 IUFindNumber(StandardSyncNP, "STANDARDSYNC_DE")->value = syncdata.deltaDEC;
                 IDSetNumber(StandardSyncNP, nullptr);
@@ -3104,6 +3649,117 @@ bool EQMod::ISNewSwitch(const char *dev, const char *name, ISState *states, char
                 return true;
             }
         }
+        else if (HasSoftPEC())
+        {
+            if (strcmp(name, SoftPECTrainingSP->name) == 0)
+            {
+                IUUpdateSwitch(SoftPECTrainingSP, states, names, n);
+                if (SoftPECTrainingSP->sp[1].s == ISS_ON)
+                {
+                    if ((TrackState != SCOPE_TRACKING) || !softpec.hasGeometry())
+                    {
+                        if (TrackState != SCOPE_TRACKING)
+                            LOG_WARN("Can not start software PEC training. Scope not tracking");
+                        else
+                            LOG_WARN("Can not start software PEC training. Worm period unknown, set SOFTPEC_WORM_STEPS");
+                        SoftPECTrainingSP->s = IPS_IDLE;
+                        IUResetSwitch(SoftPECTrainingSP);
+                        SoftPECTrainingSP->sp[0].s = ISS_ON;
+                    }
+                    else
+                    {
+                        if (SoftPECSP->s == IPS_BUSY)
+                        {
+                            // Learn the raw periodic error, not what is left of it
+                            IUResetSwitch(SoftPECSP);
+                            SoftPECSP->sp[0].s = ISS_ON;
+                            SoftPECSP->s       = IPS_IDLE;
+                            IDSetSwitch(SoftPECSP, nullptr);
+                            try
+                            {
+                                mount->StartRATracking(GetRATrackRate());
+                            }
+                            catch (EQModError e)
+                            {
+                                LOG_WARN("Unable to restore RA tracking rate.");
+                            }
+                        }
+                        softpec.startTraining();
+                        softpecCorrection    = 0.0;
+                        SoftPECTrainingSP->s = IPS_BUSY;
+                        LOGF_INFO("Turning software PEC training on. Guide for at least one worm period (%.0f s).",
+                                  (softpec.getStepsWorm() * 1296000.0) / (softpec.getStepsTotal() * TRACKRATE_SIDEREAL));
+                    }
+                    IDSetSwitch(SoftPECTrainingSP, nullptr);
+                }
+                else
+                    stopSoftPECTraining();
+                return true;
+            }
+            if (strcmp(name, SoftPECSP->name) == 0)
+            {
+                IUUpdateSwitch(SoftPECSP, states, names, n);
+                if (SoftPECSP->sp[1].s == ISS_ON)
+                {
+                    if (!softpec.hasCurve() || (SoftPECTrainingSP->s == IPS_BUSY))
+                    {
+                        if (SoftPECTrainingSP->s == IPS_BUSY)
+                            LOG_WARN("Can not turn software PEC on while training.");
+                        else
+                            LOG_WARN("Can not turn software PEC on. No curve recorded for this mount.");
+                        SoftPECSP->s = IPS_IDLE;
+                        IUResetSwitch(SoftPECSP);
+                        SoftPECSP->sp[0].s = ISS_ON;
+                    }
+                    else
+                    {
+                        SoftPECSP->s    = IPS_BUSY;
+                        softpecLastRate = 0.0;
+                        LOG_INFO("Turning software PEC on.");
+                    }
+                }
+                else
+                {
+                    SoftPECSP->s = IPS_IDLE;
+                    LOG_INFO("Turning software PEC off.");
+                    if ((TrackState == SCOPE_TRACKING) && !(pulseInProgress & 2))
+                    {
+                        try
+                        {
+                            mount->StartRATracking(GetRATrackRate());
+                        }
+                        catch (EQModError e)
+                        {
+                            LOG_WARN("Unable to restore RA tracking rate.");
+                        }
+                    }
+                }
+                IDSetSwitch(SoftPECSP, nullptr);
+                return true;
+            }
+        }
+
+        if (HasAltAzMode() && strcmp(name, AltAzModeSP->name) == 0)
+        {
+            if ((TrackState == SCOPE_SLEWING) || (TrackState == SCOPE_TRACKING) || (TrackState == SCOPE_PARKING))
+            {
+                LOG_WARN("Stop the mount before changing the mount mode.");
+                AltAzModeSP->s = IPS_ALERT;
+                IDSetSwitch(AltAzModeSP, nullptr);
+                return false;
+            }
+            IUUpdateSwitch(AltAzModeSP, states, names, n);
+            // Syncs were taken in the other frame
+            bzero(&syncdata, sizeof(syncdata));
+            bzero(&syncdata2, sizeof(syncdata2));
+            altazOffset[0] = 0.0;
+            altazOffset[1] = 0.0;
+            stopAltAzTracking();
+            AltAzModeSP->s = IPS_OK;
+            IDSetSwitch(AltAzModeSP, nullptr);
+            LOGF_INFO("Mount mode set to %s, sync data cleared.", IUFindOnSwitch(AltAzModeSP)->label);
+            return true;
+        }
 
         if (mount->HasSnapPort1())
         {
@@ -3780,6 +4436,13 @@ bool EQMod::saveConfigItems(FILE *fp)
         IUSaveConfigSwitch(fp, ReverseDECSP);
     if (LEDBrightnessNP)
         IUSaveConfigNumber(fp, LEDBrightnessNP);
+    if (SoftPECSettingsNP)
+        IUSaveConfigNumber(fp, SoftPECSettingsNP);
+    if (HasAltAzMode())
+    {
+        IUSaveConfigSwitch(fp, AltAzModeSP);
+        IUSaveConfigNumber(fp, AltAzSettingsNP);
+    }
     if (HasPECState())
     {
         IUSaveConfigSwitch(fp, RAPPECSP);
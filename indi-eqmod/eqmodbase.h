@@ -23,6 +23,8 @@
 #include "align/align.h"
 #endif
 #include "simulator/simulator.h"
+#include "pec/softpec.h"
+#include "altaz/altaztrack.h"
 #ifdef WITH_SCOPE_LIMITS
 #include "scope-limits/scope-limits.h"
 #endif
@@ -130,6 +132,16 @@ class EQMod : public INDI::Telescope, public INDI::GuiderInterface
         ISwitchVectorProperty *RAPPECSP         = nullptr;
         ISwitchVectorProperty *DEPPECSP         = nullptr;
 
+        ISwitchVectorProperty *SoftPECTrainingSP = nullptr;
+        ISwitchVectorProperty *SoftPECSP         = nullptr;
+        INumberVectorProperty *SoftPECSettingsNP = nullptr;
+        INumberVectorProperty *SoftPECStatusNP   = nullptr;
+        ITextVectorProperty *SoftPECFileTP       = nullptr;
+
+        ISwitchVectorProperty *AltAzModeSP     = nullptr;
+        INumberVectorProperty *AltAzSettingsNP = nullptr;
+        INumberVectorProperty *AltAzStatusNP   = nullptr;
+
         ISwitchVectorProperty *SNAPPORT1SP      = nullptr;
         ISwitchVectorProperty *SNAPPORT2SP      = nullptr;
 
@@ -211,6 +223,42 @@ class EQMod : public INDI::Telescope, public INDI::GuiderInterface
         // One bit for each axis
         uint8_t pulseInProgress;
 
+        // Software PEC for mounts without PPEC
+        SoftPEC softpec;
+        double softpecCorrection { 0.0 }; // RA guide corrections cumulated while training
+        double softpecLastRate { 0.0 };   // RA rate last sent by software PEC
+        bool HasSoftPEC();
+        void setupSoftPEC();
+        void updateSoftPEC();
+        void stopSoftPECTraining();
+        void updateSoftPECStatus();
+        void recordSoftPECGuide(double rateshift, uint32_t ms);
+        double GetSoftPECRate(double trackrate);
+
+        // Alt-az tracking for mounts which may be set up in alt-az
+        AltAzTrack altaz;
+        double altazOffset[2] { 0.0, 0.0 };   // azimuth and altitude at the zero encoders, moved by syncs
+        double altazLastRate[2] { 0.0, 0.0 }; // azimuth and altitude axis rates last sent
+        double altazPulseRate[2] { 0.0, 0.0 };      // RA axis and Dec rates of the pulses in progress
+        double altazPulseAxisRate[2][2] { };        // their azimuth and altitude rate offsets
+        struct timespec altazPulseStart[2] { };
+        int AltAzTimerID { -1 };
+        virtual bool HasAltAzMode();
+        bool AltAzMode();
+        void EncodersToAltAz(uint32_t rastep, uint32_t destep, double *az, double *alt);
+        void EncodersFromAltAz(double az, double alt, uint32_t *rastep, uint32_t *destep);
+        void setupAltAz();
+        void updateAltAzTracking();
+        void stopAltAzTracking();
+        void updateAltAzStatus();
+        void syncAltAz(double ra, double dec, double lst, uint32_t raencoder, uint32_t deencoder);
+        void sendAltAzRates();
+        IPState guideAltAz(double rate, uint32_t ms, INDI_EQ_AXIS axis);
+        void endGuideAltAz(INDI_EQ_AXIS axis);
+        static void altazTimerCallback(void *userpointer);
+        static void altazGuideNSCallback(void *userpointer);
+        static void altazGuideWECallback(void *userpointer);
+
     public:
         EQMod();
         virtual ~EQMod();
@@ -0,0 +1,262 @@
+/* This file is part of the Skywatcher Protocol INDI driver.
+
+    The Skywatcher Protocol INDI driver is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Skywatcher Protocol INDI driver is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Skywatcher Protocol INDI driver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "softpec.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <wordexp.h>
+
+#define ARCSECS_PER_REVOLUTION 1296000.0
+
+SoftPEC::SoftPEC()
+{
+    clearCurve();
+}
+
+void SoftPEC::setGeometry(uint32_t stepstotal, uint32_t stepsworm)
+{
+    if ((stepstotal != stepsTotal) || (stepsworm != stepsWorm))
+    {
+        // A curve learnt on another gear train means nothing here
+        clearCurve();
+        samples.clear();
+        travel = 0.0;
+    }
+    stepsTotal = stepstotal;
+    stepsWorm  = stepsworm;
+}
+
+double SoftPEC::phase(uint32_t encoder) const
+{
+    if (stepsWorm == 0)
+        return 0.0;
+    return static_cast<double>(encoder % stepsWorm) / stepsWorm;
+}
+
+void SoftPEC::startTraining()
+{
+    samples.clear();
+    travel = 0.0;
+}
+
+void SoftPEC::addSample(double time, uint32_t encoder, double correction)
+{
+    Sample s;
+    s.time       = time;
+    s.phase      = phase(encoder);
+    s.correction = correction;
+
+    if (!samples.empty())
+    {
+        // Unwrapped phase travel, whatever the tracking direction
+        double delta = fabs(s.phase - samples.back().phase);
+        if (delta > 0.5)
+            delta = 1.0 - delta;
+        travel += delta;
+    }
+    s.travel = travel;
+    samples.push_back(s);
+}
+
+bool SoftPEC::fit(unsigned int nharmonics)
+{
+    if (!hasGeometry() || (travel < 1.0) || (samples.size() < 2) || (nharmonics == 0))
+        return false;
+    if (nharmonics > MAX_HARMONICS)
+        nharmonics = MAX_HARMONICS;
+
+    // Linear drift (polar misalignment, rate error): the periodic error cancels between
+    // samples one worm period apart, a plain regression would also absorb part of it
+    double slope = 0.0;
+    unsigned int pairs = 0;
+    for (size_t i = 0, j = 0; i < samples.size(); i++)
+    {
+        while ((j < samples.size()) && (samples[j].travel - samples[i].travel < 1.0))
+            j++;
+        if (j == samples.size())
+            break;
+        if (samples[j].time > samples[i].time)
+        {
+            slope += (samples[j].correction - samples[i].correction) / (samples[j].time - samples[i].time);
+            pairs++;
+        }
+    }
+    if (pairs > 0)
+        slope /= pairs;
+
+    // Average the periodic residual over worm phase
+    double sum[PHASE_BINS] = { 0.0 };
+    unsigned int count[PHASE_BINS] = { 0 };
+    for (const Sample &s : samples)
+    {
+        unsigned int bin = static_cast<unsigned int>(s.phase * PHASE_BINS) % PHASE_BINS;
+        sum[bin] += s.correction - slope * s.time;
+        count[bin] += 1;
+    }
+
+    unsigned int filled = 0;
+    for (unsigned int i = 0; i < PHASE_BINS; i++)
+        if (count[i] > 0)
+        {
+            sum[i] /= count[i];
+            filled++;
+        }
+    if (filled < PHASE_BINS / 2)
+        return false;
+
+    // Fill empty bins linearly from their nearest filled neighbours
+    double value[PHASE_BINS];
+    for (unsigned int i = 0; i < PHASE_BINS; i++)
+    {
+        if (count[i] > 0)
+        {
+            value[i] = sum[i];
+            continue;
+        }
+        unsigned int before = 1, after = 1;
+        while (count[(i + PHASE_BINS - before) % PHASE_BINS] == 0)
+            before++;
+        while (count[(i + after) % PHASE_BINS] == 0)
+            after++;
+        double vb = sum[(i + PHASE_BINS - before) % PHASE_BINS];
+        double va = sum[(i + after) % PHASE_BINS];
+        value[i]  = vb + (va - vb) * before / (before + after);
+    }
+
+    // Keep the first harmonics only, this smooths the curve and drops the mean
+    for (unsigned int k = 1; k <= nharmonics; k++)
+    {
+        double a = 0.0, b = 0.0;
+        for (unsigned int i = 0; i < PHASE_BINS; i++)
+        {
+            double angle = 2.0 * M_PI * k * (i + 0.5) / PHASE_BINS;
+            a += value[i] * cos(angle);
+            b += value[i] * sin(angle);
+        }
+        cosTerms[k] = 2.0 * a / PHASE_BINS;
+        sinTerms[k] = 2.0 * b / PHASE_BINS;
+    }
+    harmonics = nharmonics;
+    return true;
+}
+
+void SoftPEC::clearCurve()
+{
+    harmonics = 0;
+    memset(cosTerms, 0, sizeof(cosTerms));
+    memset(sinTerms, 0, sizeof(sinTerms));
+}
+
+double SoftPEC::curveAt(double phase) const
+{
+    double c = 0.0;
+    for (unsigned int k = 1; k <= harmonics; k++)
+        c += cosTerms[k] * cos(2.0 * M_PI * k * phase) + sinTerms[k] * sin(2.0 * M_PI * k * phase);
+    return c;
+}
+
+double SoftPEC::rateAt(uint32_t encoder, double trackrate) const
+{
+    if (!hasCurve() || !hasGeometry())
+        return 0.0;
+
+    // d(curve)/dt = d(curve)/d(phase) * d(phase)/dt
+    double p = phase(encoder), dcurve = 0.0;
+    for (unsigned int k = 1; k <= harmonics; k++)
+        dcurve += 2.0 * M_PI * k * (sinTerms[k] * cos(2.0 * M_PI * k * p) - cosTerms[k] * sin(2.0 * M_PI * k * p));
+    double dphase = trackrate * (stepsTotal / ARCSECS_PER_REVOLUTION) / stepsWorm;
+    return dcurve * dphase;
+}
+
+double SoftPEC::amplitude() const
+{
+    if (!hasCurve())
+        return 0.0;
+    double cmin = curveAt(0.0), cmax = cmin;
+    for (unsigned int i = 1; i < 360; i++)
+    {
+        double c = curveAt(i / 360.0);
+        cmin     = fmin(cmin, c);
+        cmax     = fmax(cmax, c);
+    }
+    return cmax - cmin;
+}
+
+bool SoftPEC::save(const char *filename) const
+{
+    wordexp_t wexp;
+    FILE *fp;
+
+    if (!hasCurve() || wordexp(filename, &wexp, 0))
+        return false;
+    fp = fopen(wexp.we_wordv[0], "w");
+    wordfree(&wexp);
+    if (!fp)
+        return false;
+
+    fprintf(fp, "# EQMod software PEC curve, corrections in arcsecs\n");
+    fprintf(fp, "STEPS_TOTAL %u\n", stepsTotal);
+    fprintf(fp, "STEPS_WORM %u\n", stepsWorm);
+    fprintf(fp, "HARMONICS %u\n", harmonics);
+    for (unsigned int k = 1; k <= harmonics; k++)
+        fprintf(fp, "%u %.9g %.9g\n", k, cosTerms[k], sinTerms[k]);
+    fclose(fp);
+    return true;
+}
+
+bool SoftPEC::load(const char *filename)
+{
+    wordexp_t wexp;
+    FILE *fp;
+    char line[128];
+    unsigned int total = 0, worm = 0, nharmonics = 0, k = 0, read = 0;
+    double a, b, ca[MAX_HARMONICS + 1] = { 0.0 }, sa[MAX_HARMONICS + 1] = { 0.0 };
+
+    if (wordexp(filename, &wexp, 0))
+        return false;
+    fp = fopen(wexp.we_wordv[0], "r");
+    wordfree(&wexp);
+    if (!fp)
+        return false;
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        if (line[0] == '#')
+            continue;
+        if (sscanf(line, "STEPS_TOTAL %u", &total) == 1 || sscanf(line, "STEPS_WORM %u", &worm) == 1 ||
+                sscanf(line, "HARMONICS %u", &nharmonics) == 1)
+            continue;
+        if ((sscanf(line, "%u %lf %lf", &k, &a, &b) == 3) && (k >= 1) && (k <= MAX_HARMONICS))
+        {
+            ca[k] = a;
+            sa[k] = b;
+            read++;
+        }
+    }
+    fclose(fp);
+
+    // Refuse curves from another gear train
+    if ((nharmonics == 0) || (nharmonics > MAX_HARMONICS) || (read < nharmonics) || (total != stepsTotal) ||
+            (worm != stepsWorm))
+        return false;
+
+    harmonics = nharmonics;
+    memcpy(cosTerms, ca, sizeof(cosTerms));
+    memcpy(sinTerms, sa, sizeof(sinTerms));
+    return true;
+}
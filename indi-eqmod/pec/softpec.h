@@ -0,0 +1,89 @@
+/* This file is part of the Skywatcher Protocol INDI driver.
+
+    The Skywatcher Protocol INDI driver is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Skywatcher Protocol INDI driver is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Skywatcher Protocol INDI driver.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+/*
+ * Software periodic error correction for the RA axis.
+ *
+ * While training, the driver feeds the cumulated guide correction together
+ * with the RA encoder position. Once at least one worm period is recorded,
+ * the linear drift is removed, the residual is averaged over worm phase bins
+ * and reduced to its first harmonics. The derivative of that curve is the
+ * rate to add to tracking so the corrections are applied ahead of the guider.
+ *
+ * Corrections and rates share the unit of the rate handed to StartRATracking
+ * (arcsecs/s, signed as the mount moves), so inverted axes need no special care.
+ *
+ * The worm phase is the RA encoder position modulo the worm period. Skywatcher
+ * encoders are reset at power up, so a saved curve only keeps its phase when
+ * the mount was parked across the power cycle.
+ */
+class SoftPEC
+{
+  public:
+    static const unsigned int PHASE_BINS    = 128;
+    static const unsigned int MAX_HARMONICS = 8;
+
+    SoftPEC();
+
+    void setGeometry(uint32_t stepstotal, uint32_t stepsworm);
+    uint32_t getStepsWorm() const { return stepsWorm; }
+    uint32_t getStepsTotal() const { return stepsTotal; }
+    bool hasGeometry() const { return (stepsWorm > 0) && (stepsTotal > 0); }
+
+    // Worm phase in [0, 1)
+    double phase(uint32_t encoder) const;
+
+    // Training
+    void startTraining();
+    void addSample(double time, uint32_t encoder, double correction);
+    double trainedPeriods() const { return travel; }
+    unsigned int sampleCount() const { return samples.size(); }
+    bool fit(unsigned int nharmonics);
+
+    // Playback
+    bool hasCurve() const { return harmonics > 0; }
+    void clearCurve();
+    double curveAt(double phase) const;
+    double rateAt(uint32_t encoder, double trackrate) const;
+    double amplitude() const;
+
+    bool save(const char *filename) const;
+    bool load(const char *filename);
+
+  private:
+    struct Sample
+    {
+        double time;
+        double phase;
+        double correction;
+        double travel;
+    };
+
+    uint32_t stepsTotal { 0 };
+    uint32_t stepsWorm { 0 };
+
+    std::vector<Sample> samples;
+    double travel { 0.0 };
+
+    unsigned int harmonics { 0 };
+    double cosTerms[MAX_HARMONICS + 1];
+    double sinTerms[MAX_HARMONICS + 1];
+};
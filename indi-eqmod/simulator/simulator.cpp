@@ -79,6 +79,7 @@ void EQModSimulator::Connect()
             }
         }
     }
+    sksim->setupPeriodicError(IUFindNumber(SimPENP, "SIM_PE_AMPLITUDE")->value);
 }
 
 void EQModSimulator::receive_cmd(const char *cmd, int *received)
@@ -103,6 +104,7 @@ bool EQModSimulator::initProperties()
     SimWormNP      = telescope->getNumber("SIMULATORWORM");
     SimRatioNP     = telescope->getNumber("SIMULATORRATIO");
     SimMotorNP     = telescope->getNumber("SIMULATORMOTOR");
+    SimPENP        = telescope->getNumber("SIMULATORPE");
     SimModeSP      = telescope->getSwitch("SIMULATORMODE");
     SimHighSpeedSP = telescope->getSwitch("SIMULATORHIGHSPEED");
     SimMCVersionTP = telescope->getText("SIMULATORMCVERSION");
@@ -118,6 +120,7 @@ bool EQModSimulator::updateProperties(bool enable)
         telescope->defineProperty(SimWormNP);
         telescope->defineProperty(SimRatioNP);
         telescope->defineProperty(SimMotorNP);
+        telescope->defineProperty(SimPENP);
         telescope->defineProperty(SimHighSpeedSP);
         telescope->defineProperty(SimMCVersionTP);
 
@@ -133,6 +136,7 @@ bool EQModSimulator::updateProperties(bool enable)
         telescope->deleteProperty(SimWormNP->name);
         telescope->deleteProperty(SimRatioNP->name);
         telescope->deleteProperty(SimMotorNP->name);
+        telescope->deleteProperty(SimPENP->name);
         telescope->deleteProperty(SimHighSpeedSP->name);
         telescope->deleteProperty(SimMCVersionTP->name);
     }
@@ -147,6 +151,16 @@ bool EQModSimulator::ISNewNumber(const char *dev, const char *name, double value
     if (strcmp(dev, telescope->getDeviceName()) == 0)
     {
         INumberVectorProperty *nvp = telescope->getNumber(name);
+        if (nvp && (nvp == SimPENP))
+        {
+            // Periodic error may be changed while running
+            nvp->s = IPS_OK;
+            IUUpdateNumber(nvp, values, names, n);
+            if (sksim)
+                sksim->setupPeriodicError(IUFindNumber(SimPENP, "SIM_PE_AMPLITUDE")->value);
+            IDSetNumber(nvp, nullptr);
+            return true;
+        }
         if ((nvp != SimWormNP) && (nvp != SimRatioNP) & (nvp != SimMotorNP))
             return false;
         if (telescope->isConnected())
@@ -32,6 +32,7 @@ class EQModSimulator
     INumberVectorProperty *SimWormNP      = NULL;
     INumberVectorProperty *SimRatioNP     = NULL;
     INumberVectorProperty *SimMotorNP     = NULL;
+    INumberVectorProperty *SimPENP        = NULL;
     ISwitchVectorProperty *SimModeSP      = NULL;
     ISwitchVectorProperty *SimHighSpeedSP = NULL;
     ITextVectorProperty *SimMCVersionTP   = NULL;
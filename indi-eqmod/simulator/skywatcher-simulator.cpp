@@ -3,6 +3,7 @@
 
 #include <indidevapi.h>
 
+#include <math.h>
 #include <string.h>
 #include <stdint.h>
 
@@ -128,6 +129,18 @@ void SkywatcherSimulator::setupDE(unsigned int nb_teeth, unsigned int gear_ratio
     //IDLog("Simulator setupDE %d %d\n", de_steps_360, de_steps_worm);
 }
 
+void SkywatcherSimulator::setupPeriodicError(double amplitude)
+{
+    ra_pe_amplitude = amplitude;
+}
+
+int SkywatcherSimulator::ra_periodic_error()
+{
+    // Sine over one worm revolution, amplitude given in arcsecs
+    double phase = static_cast<double>(ra_position % ra_steps_worm) / ra_steps_worm;
+    return static_cast<int>(ra_pe_amplitude * ra_steps_360 / 1296000.0 * sin(2.0 * M_PI * phase));
+}
+
 void SkywatcherSimulator::compute_timer_ra(unsigned int wormperiod)
 {
     uint32_t n = (wormperiod * MUL_RA);
@@ -326,6 +339,20 @@ void SkywatcherSimulator::process_command(const char *cmd, int *received)
             else
                 goto cant_do;
             break;
+        case 's': // Get number of microsteps per worm revolution
+            if (cmd[2] == '1')
+            {
+                send_byte('=');
+                send_u24(ra_steps_worm);
+            }
+            else if (cmd[2] == '2')
+            {
+                send_byte('=');
+                send_u24(de_steps_worm);
+            }
+            else
+                goto cant_do;
+            break;
         case 'D': // Get Worm period
             if (cmd[2] == '1')
             {
@@ -359,7 +386,7 @@ void SkywatcherSimulator::process_command(const char *cmd, int *received)
             {
                 compute_ra_position();
                 send_byte('=');
-                send_u24(ra_position);
+                send_u24(ra_position + ra_periodic_error());
             }
             else if (cmd[2] == '2')
             {
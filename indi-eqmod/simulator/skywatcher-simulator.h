@@ -42,6 +42,7 @@ class SkywatcherSimulator
                  unsigned int nb_microsteps, unsigned int highspeed);
     void setupDE(unsigned int nb_teeth, unsigned int gear_ratio_num, unsigned int gear_ratio_den, unsigned int nb_steps,
                  unsigned int nb_microsteps, unsigned int highspeed);
+    void setupPeriodicError(double amplitude);
 
     void process_command(const char *cmd, int *received);
     void get_reply(char *buf, int *len);
@@ -77,6 +78,9 @@ class SkywatcherSimulator
     unsigned int ra_steps_worm;
     unsigned int de_steps_worm;
 
+    // RA periodic error amplitude in arcsecs, seen on the reported position only
+    double ra_pe_amplitude = 0.0;
+
     unsigned int ra_position;
     unsigned char ra_microstep;
     unsigned char ra_pwmindex;
@@ -119,6 +123,7 @@ class SkywatcherSimulator
     void compute_timer_ra(unsigned int wormperiod);
     void compute_timer_de(unsigned int wormperiod);
     void compute_ra_position();
+    int ra_periodic_error();
     void compute_de_position();
     void ra_resume();
     void de_resume();
@@ -549,6 +549,26 @@ void Skywatcher::InquireFeatures()
     AxisFeatures[Axis2].hasWifi                = defeatures & 0x00008000;
 }
 
+void Skywatcher::InquireRAPECPeriod()
+{
+    try
+    {
+        dispatch_command(InquirePECPeriod, Axis1, nullptr);
+        RAStepsPEC = Revu24str2long(response + 1);
+    }
+    catch (EQModError e)
+    {
+        LOGF_DEBUG("%s(): Mount does not report its PEC period (%c command)", __FUNCTION__,
+                   InquirePECPeriod);
+        RAStepsPEC = 0;
+    }
+}
+
+uint32_t Skywatcher::GetRAStepsPEC()
+{
+    return RAStepsPEC;
+}
+
 bool Skywatcher::HasHomeIndexers()
 {
     return (AxisFeatures[Axis1].hasHomeIndexer) && (AxisFeatures[Axis2].hasHomeIndexer);
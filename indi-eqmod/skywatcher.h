@@ -64,6 +64,8 @@ class Skywatcher
         bool HasSnapPort1();
         bool HasSnapPort2();
         bool HasPolarLed();
+        // False when the motors were found unpowered by Init(), the encoders were then reset
+        bool WasInitialized() const { return wasinitialized; }
 
         uint32_t GetRAEncoder();
         uint32_t GetDEEncoder();
@@ -79,6 +81,8 @@ class Skywatcher
         void GetDEMotorStatus(ILightVectorProperty *motorLP);
         void InquireBoardVersion(ITextVectorProperty *boardTP);
         void InquireFeatures();
+        void InquireRAPECPeriod();
+        uint32_t GetRAStepsPEC();
         void InquireRAEncoderInfo(INumberVectorProperty *encoderNP);
         void InquireDEEncoderInfo(INumberVectorProperty *encoderNP);
         void Init();
@@ -295,6 +299,7 @@ class Skywatcher
         uint32_t DESteps360;
         uint32_t RAStepsWorm;
         uint32_t DEStepsWorm;
+        uint32_t RAStepsPEC {0}; // Steps per worm revolution, 0 if not reported
         // Motor controller multiplies speed values by this ratio when in low speed mode
         uint32_t RAHighspeedRatio;
         // This is a reflect of either using a timer interrupt with an interrupt count greater than 1 for low speed
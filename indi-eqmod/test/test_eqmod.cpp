@@ -4,6 +4,10 @@
 #include "config.h"
 #include "eqmodbase.h"
 
+#include <algorithm>
+#include <cmath>
+#include <unistd.h>
+
 
 using ::testing::_;
 using ::testing::StrEq;
@@ -453,6 +457,151 @@ TEST(EqmodTest, scope_limits_altaz)
 }
 #endif
 
+TEST(SoftPECTest, fit_playback_and_file)
+{
+    const uint32_t total = 9024000, worm = 50133;
+    const double steps_per_second = TRACKRATE_SIDEREAL * total / 1296000.0;
+    auto pe = [](double phase)
+    {
+        return 10.0 * sin(2.0 * M_PI * phase) + 3.0 * cos(4.0 * M_PI * phase);
+    };
+
+    SoftPEC softpec;
+    softpec.setGeometry(total, worm);
+    ASSERT_TRUE(softpec.hasGeometry());
+    ASSERT_FALSE(softpec.hasCurve());
+
+    // Guider cancels the periodic error plus a slow drift, one sample per second over two worm periods
+    softpec.startTraining();
+    const uint32_t start = 123456;
+    for (double t = 0; t < 2.0 * worm / steps_per_second; t += 1.0)
+    {
+        uint32_t encoder = start + static_cast<uint32_t>(t * steps_per_second);
+        softpec.addSample(t, encoder, -pe(softpec.phase(encoder)) + 0.02 * t);
+    }
+    ASSERT_GT(softpec.trainedPeriods(), 1.9);
+    ASSERT_TRUE(softpec.fit(4));
+
+    // Correction left to the guider once the curve is played back
+    double residual = 0.0, pemin = pe(0.0), pemax = pe(0.0);
+    for (double phase = 0.0; phase < 1.0; phase += 0.01)
+    {
+        residual = std::max(residual, fabs(pe(phase) + softpec.curveAt(phase)));
+        pemin    = std::min(pemin, pe(phase));
+        pemax    = std::max(pemax, pe(phase));
+    }
+    ASSERT_LT(residual, 1.0);
+    ASSERT_NEAR(softpec.amplitude(), pemax - pemin, 1.0);
+
+    // Rate is the curve derivative along the worm at tracking speed
+    const uint32_t encoder = start + worm / 3;
+    const double dt = 1.0;
+    const double expected = -(pe(softpec.phase(encoder + static_cast<uint32_t>(steps_per_second * dt))) -
+                              pe(softpec.phase(encoder))) / dt;
+    ASSERT_NEAR(softpec.rateAt(encoder, TRACKRATE_SIDEREAL), expected, 0.02);
+
+    // Curves are only reloaded on the same gear train
+    const char *filename = "/tmp/test_eqmod_softpec.txt";
+    ASSERT_TRUE(softpec.save(filename));
+    SoftPEC loaded;
+    loaded.setGeometry(total, worm);
+    ASSERT_TRUE(loaded.load(filename));
+    ASSERT_NEAR(loaded.curveAt(0.25), softpec.curveAt(0.25), 1e-6);
+    SoftPEC other;
+    other.setGeometry(total, worm + 1);
+    ASSERT_FALSE(other.load(filename));
+    unlink(filename);
+}
+
+TEST(AltAzTrackTest, conversions)
+{
+    double az, alt, ha, dec;
+
+    AltAzTrack::equatorialToHorizontal(0.0, 0.0, 45.0, &az, &alt);
+    ASSERT_NEAR(az, 180.0, 1e-9);
+    ASSERT_NEAR(alt, 45.0, 1e-9);
+    AltAzTrack::equatorialToHorizontal(6.0, 0.0, 45.0, &az, &alt);
+    ASSERT_NEAR(az, 270.0, 1e-9);
+    ASSERT_NEAR(alt, 0.0, 1e-9);
+
+    for (double latitude = -60.0; latitude <= 60.0; latitude += 30.0)
+        for (double h = 0.5; h < 24.0; h += 1.0)
+            for (double d = -80.0; d <= 80.0; d += 20.0)
+            {
+                AltAzTrack::equatorialToHorizontal(h, d, latitude, &az, &alt);
+                AltAzTrack::horizontalToEquatorial(az, alt, latitude, &ha, &dec);
+                ASSERT_NEAR(ha, h, 1e-9);
+                ASSERT_NEAR(dec, d, 1e-9);
+            }
+}
+
+TEST(AltAzTrackTest, guide_rates)
+{
+    const double latitude = 45.0, lst = 2.0, ra = 0.5, dec = 60.0, rate = 7.5;
+    AltAzTrack altaz;
+    altaz.setLatitude(latitude);
+    altaz.setTarget(ra, dec);
+
+    // RA offsets are axis motion, a second of RA whatever the declination
+    altaz.moveTarget(15.0, 0.0);
+    ASSERT_NEAR(altaz.getTargetRA(), ra + 1.0 / 3600.0, 1e-12);
+    altaz.moveTarget(-15.0, 0.0);
+
+    // A Dec pulse moves the pointing by its rate on the sky, an RA axis pulse by its rate times cos(dec)
+    double az, alt, azrate, altrate;
+    AltAzTrack::equatorialToHorizontal(lst - ra, dec, latitude, &az, &alt);
+    altaz.guideRates(lst, 0.0, rate, &azrate, &altrate);
+    ASSERT_NEAR(hypot(azrate * cos(alt * M_PI / 180.0), altrate), rate, 1e-3);
+    altaz.guideRates(lst, rate, 0.0, &azrate, &altrate);
+    ASSERT_NEAR(hypot(azrate * cos(alt * M_PI / 180.0), altrate), rate * cos(dec * M_PI / 180.0), 1e-3);
+}
+
+// Drive both axes with the controller rates for an hour of sky, one rate update per second
+static void trackHour(double dec, double *errormax, double *errorout)
+{
+    const double latitude = 45.0, ra = 0.5, minrate = 0.05 * TRACKRATE_SIDEREAL;
+    AltAzTrack altaz;
+    altaz.setLatitude(latitude);
+    altaz.setPeriod(1.0);
+    altaz.setMaxRate(100 * TRACKRATE_SIDEREAL);
+
+    double az, alt;
+    AltAzTrack::equatorialToHorizontal(-ra, dec, latitude, &az, &alt);
+    altaz.setTarget(ra, dec);
+    *errorout = 0.0;
+    for (int t = 0; t < 3600; t++)
+    {
+        altaz.update(t * 1.00273790935 / 3600.0, az, alt);
+        if (!altaz.inKeyhole())
+            *errorout = std::max(*errorout, altaz.getError());
+        // Axes stop below the slowest motor rate
+        double azrate  = (fabs(altaz.getAzRate()) < minrate) ? 0.0 : altaz.getAzRate();
+        double altrate = (fabs(altaz.getAltRate()) < minrate) ? 0.0 : altaz.getAltRate();
+        az  = fmod(az + azrate / 3600.0 + 360.0, 360.0);
+        alt = alt + altrate / 3600.0;
+    }
+    *errormax = altaz.getErrorMax();
+}
+
+TEST(AltAzTrackTest, hour_of_sky)
+{
+    double errormax, errorout;
+
+    // Meridian transit, the altitude rate changes sign
+    trackHour(20.0, &errormax, &errorout);
+    ASSERT_LT(errormax, 2.0);
+
+    // Passing 0.5 degree from the zenith is still followed
+    trackHour(44.5, &errormax, &errorout);
+    ASSERT_LT(errormax, 2.0);
+
+    // Passing 0.1 degree from the zenith the azimuth rate is limited, then the error is caught up
+    trackHour(44.9, &errormax, &errorout);
+    ASSERT_GT(errormax, 60.0);
+    ASSERT_LT(errormax, 1800.0);
+    ASSERT_LT(errorout, 2.0);
+}
+
 int main(int argc, char **argv)
 {
     INDI::Logger::getInstance().configure("", INDI::Logger::file_off,
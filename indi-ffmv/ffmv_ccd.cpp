@@ -22,13 +22,28 @@
 #include <arpa/inet.h>
 #include <math.h>
 #include <sys/time.h>
+#include <poll.h>
 #include <dc1394/dc1394.h>
 #include <indiapi.h>
 #include <iostream>
+#include <functional>
 
 #include "ffmv_ccd.h"
 #include "config.h"
 
+/* Number of frames in the DMA ring, enough to ride out event loop stalls while streaming */
+#define DMA_BUFFERS     16
+/* How often the capture worker wakes up to check for a stop request (ms) */
+#define CAPTURE_POLL_MS 100
+/* How often the main loop checks for the last sub once the exposure is due (ms) */
+#define COMPLETE_POLL_MS 20
+
+enum
+{
+    CAPTURE_SINGLE,
+    CAPTURE_CONTINUOUS
+};
+
 std::unique_ptr<FFMVCCD> ffmvCCD(new FFMVCCD());
 
 /**
@@ -80,9 +95,15 @@ FFMVCCD::FFMVCCD()
     InExposure = false;
     capturing  = false;
 
+    last_exposure_length = -1;
+    sub_length           = 0;
+    subs_pending         = 0;
+    subs_done            = false;
+    subs_not_before      = 0;
+
     setVersion(FFMV_VERSION_MAJOR, FFMV_VERSION_MINOR);
 
-    SetCCDCapability(CCD_CAN_ABORT);
+    SetCCDCapability(CCD_CAN_ABORT | CCD_HAS_STREAMING);
 }
 
 /**************************************************************************************
@@ -247,7 +268,12 @@ bool FFMVCCD::Connect()
         return false;
     }
 
-    err = dc1394_capture_setup(dcam, 10, DC1394_CAPTURE_FLAGS_DEFAULT);
+    err = dc1394_capture_setup(dcam, DMA_BUFFERS, DC1394_CAPTURE_FLAGS_DEFAULT);
+    if (err != DC1394_SUCCESS)
+    {
+        LOG_ERROR("Unable to set up DMA capture!");
+        return false;
+    }
 
     LOGF_INFO("Detected camera model: %s vendor: %s (%#04X:%#04X)", dcam->model, dcam->model, dcam->vendor_id, dcam->model_id);
 
@@ -259,6 +285,8 @@ bool FFMVCCD::Connect()
 ***************************************************************************************/
 bool FFMVCCD::Disconnect()
 {
+    stopCapture();
+
     if (dcam)
     {
         dc1394_capture_stop(dcam);
@@ -294,6 +322,12 @@ bool FFMVCCD::initProperties()
     IUFillSwitchVector(&GainSP, GainS, 2, getDeviceName(), "GAIN", "Gain", IMAGE_SETTINGS_TAB, IP_WO, ISR_NOFMANY, 0,
                        IPS_IDLE);
 
+    /* Single mode starts and stops transmission for every exposure, continuous mode keeps the bus running */
+    IUFillSwitch(&CaptureModeS[CAPTURE_SINGLE], "CAPTURE_SINGLE", "Single", ISS_ON);
+    IUFillSwitch(&CaptureModeS[CAPTURE_CONTINUOUS], "CAPTURE_CONTINUOUS", "Continuous", ISS_OFF);
+    IUFillSwitchVector(&CaptureModeSP, CaptureModeS, 2, getDeviceName(), "CAPTURE_MODE", "Capture Mode",
+                       IMAGE_SETTINGS_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
+
     setDefaultPollingPeriod(250);
 
     return true;
@@ -316,10 +350,12 @@ bool FFMVCCD::updateProperties()
         // Start the timer
         SetTimer(getCurrentPollingPeriod());
         defineProperty(&GainSP);
+        defineProperty(&CaptureModeSP);
     }
     else
     {
         deleteProperty(GainSP.name);
+        deleteProperty(CaptureModeSP.name);
     }
 
     return true;
@@ -340,6 +376,49 @@ void FFMVCCD::setupParams()
     // Let's calculate how much memory we need for the primary CCD buffer
     uint32_t nbuf = PrimaryCCD.getXRes() * PrimaryCCD.getYRes() * PrimaryCCD.getBPP() / 8;
     PrimaryCCD.setFrameBufferSize(nbuf);
+
+    streamFrame.resize(PrimaryCCD.getXRes() * PrimaryCCD.getYRes());
+    Streamer->setPixelFormat(INDI_MONO, 16);
+    Streamer->setSize(PrimaryCCD.getXRes(), PrimaryCCD.getYRes());
+}
+
+/**************************************************************************************
+** Split the requested duration into subs no longer than the maximum shutter
+***************************************************************************************/
+bool FFMVCCD::setSubLength(float duration)
+{
+    dc1394error_t err;
+    float fval;
+    int ms = duration * 1000;
+
+    if (duration == last_exposure_length)
+        return true;
+
+    /* Calculate the number of exposures needed */
+    sub_count = duration / max_exposure;
+    if (ms % ((int)(max_exposure * 1000)))
+    {
+        ++sub_count;
+    }
+    sub_length = duration / sub_count;
+
+    LOGF_DEBUG("Triggering a %f second exposure using %d subs of %f seconds", duration, sub_count, sub_length);
+    /* Set sub length */
+    err = dc1394_feature_set_absolute_value(dcam, DC1394_FEATURE_SHUTTER, sub_length);
+    if (err != DC1394_SUCCESS)
+    {
+        LOG_ERROR("Unable to set shutter value.");
+        return false;
+    }
+    err = dc1394_feature_get_absolute_value(dcam, DC1394_FEATURE_SHUTTER, &fval);
+    if (err != DC1394_SUCCESS)
+    {
+        LOG_ERROR("Unable to get shutter value.");
+    }
+    LOGF_DEBUG("Shutter value is %f.", fval);
+
+    last_exposure_length = duration;
+    return true;
 }
 
 #define IMAGE_FILE_NAME "testimage.pgm"
@@ -350,11 +429,12 @@ bool FFMVCCD::StartExposure(float duration)
 {
     dc1394error_t err;
     dc1394video_frame_t *frame;
-    int ms;
-    float sub_length;
-    float fval;
 
-    ms = duration * 1000;
+    if (Streamer->isBusy())
+    {
+        LOG_ERROR("Cannot take exposure while streaming/recording is active.");
+        return false;
+    }
 
     //LOG_ERROR("Doing %d sub exposures at %f %s each", sub_count, absShutter, prop_info.pUnits);
 
@@ -364,47 +444,31 @@ bool FFMVCCD::StartExposure(float duration)
     PrimaryCCD.setBPP(16);
     PrimaryCCD.setExposureDuration(duration);
 
+    // Frames still in flight may have been exposed with the previous shutter value
+    float const previous_sub_length = (duration != last_exposure_length) ? sub_length : 0;
+    setSubLength(duration);
+
     gettimeofday(&ExpStart, nullptr);
 
     InExposure = true;
-    LOG_ERROR("Exposure has begun.");
+    LOG_DEBUG("Exposure has begun.");
 
     // Let's get a pointer to the frame buffer
     uint8_t *image = PrimaryCCD.getFrameBuffer();
 
+    std::unique_lock<std::mutex> guard(ccdBufferLock);
     memset(image, 0, PrimaryCCD.getFrameBufferSize());
+    guard.unlock();
 
-    if (duration != last_exposure_length)
+    if (capturing)
     {
-        /* Calculate the number of exposures needed */
-        sub_count = duration / max_exposure;
-        if (ms % ((int)(max_exposure * 1000)))
-        {
-            ++sub_count;
-        }
-        sub_length = duration / sub_count;
-
-        LOGF_DEBUG("Triggering a %f second exposure using %d subs of %f seconds", duration, sub_count,
-                   sub_length);
-        /* Set sub length */
-#if 0
-        err = dc1394_feature_set_absolute_control(dcam, DC1394_FEATURE_SHUTTER, DC1394_ON);
-        if (err != DC1394_SUCCESS)
-        {
-            LOG_ERROR("Failed to enable ansolute shutter control.");
-        }
-#endif
-        err = dc1394_feature_set_absolute_value(dcam, DC1394_FEATURE_SHUTTER, sub_length);
-        if (err != DC1394_SUCCESS)
-        {
-            LOG_ERROR("Unable to set shutter value.");
-        }
-        err = dc1394_feature_get_absolute_value(dcam, DC1394_FEATURE_SHUTTER, &fval);
-        if (err != DC1394_SUCCESS)
-        {
-            LOG_ERROR("Unable to get shutter value.");
-        }
-        LOGF_DEBUG("Shutter value is %f.", fval);
+        /* Transmission is already running, the capture worker collects the subs. Only accept
+         * frames that were entirely exposed after this point. */
+        subs_not_before = ExpStart.tv_sec * 1000000ULL + ExpStart.tv_usec +
+                          static_cast<uint64_t>((previous_sub_length + sub_length) * 1000000.0);
+        subs_done    = false;
+        subs_pending = sub_count;
+        return true;
     }
 
     /* Flush the DMA buffer */
@@ -443,7 +507,9 @@ bool FFMVCCD::StartExposure(float duration)
 ***************************************************************************************/
 bool FFMVCCD::AbortExposure()
 {
-    InExposure = false;
+    subs_pending = 0;
+    subs_done    = false;
+    InExposure   = false;
     return true;
 }
 
@@ -555,6 +621,33 @@ bool FFMVCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, ch
             setDigitalGain(GainS[1].s);
             return true;
         }
+
+        if (!strcmp(name, CaptureModeSP.name))
+        {
+            if (InExposure)
+            {
+                LOG_ERROR("Cannot change capture mode while exposing.");
+                CaptureModeSP.s = IPS_ALERT;
+                IDSetSwitch(&CaptureModeSP, nullptr);
+                return true;
+            }
+
+            IUUpdateSwitch(&CaptureModeSP, states, names, n);
+            CaptureModeSP.s = IPS_OK;
+
+            if (CaptureModeS[CAPTURE_CONTINUOUS].s == ISS_ON)
+            {
+                if (!startCapture())
+                    CaptureModeSP.s = IPS_ALERT;
+            }
+            else if (!Streamer->isBusy())
+            {
+                stopCapture();
+            }
+
+            IDSetSwitch(&CaptureModeSP, nullptr);
+            return true;
+        }
     }
 
     //  Nobody has claimed this, so, ignore it
@@ -569,7 +662,27 @@ void FFMVCCD::TimerHit()
     if (isConnected() == false)
         return;
 
-    if (InExposure)
+    uint32_t nextTimer = getCurrentPollingPeriod();
+
+    if (InExposure && capturing)
+    {
+        // The capture worker flags the exposure once all subs arrived
+        double timeleft = CalcTimeLeft();
+        if (subs_done.exchange(false))
+        {
+            InExposure = false;
+            PrimaryCCD.setExposureLeft(0);
+            ExposureComplete(&PrimaryCCD);
+        }
+        else
+        {
+            PrimaryCCD.setExposureLeft(timeleft > 0 ? timeleft : 0);
+            // Pick up the last sub promptly
+            if (timeleft * 1000 < nextTimer)
+                nextTimer = COMPLETE_POLL_MS;
+        }
+    }
+    else if (InExposure)
     {
         double timeleft = CalcTimeLeft();
 
@@ -596,10 +709,30 @@ void FFMVCCD::TimerHit()
         }
     }
 
-    SetTimer(getCurrentPollingPeriod());
+    SetTimer(nextTimer);
     return;
 }
 
+/**
+ * Add one sub to the image buffer, saturating at 16 bits.
+ * Caller must hold ccdBufferLock.
+ */
+void FFMVCCD::accumulateFrame(const dc1394video_frame_t *frame)
+{
+    uint16_t *image       = reinterpret_cast<uint16_t *>(PrimaryCCD.getFrameBuffer());
+    const uint16_t *pixel = reinterpret_cast<const uint16_t *>(frame->image);
+
+    // Get width and height
+    int width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
+    int height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+
+    for (int i = 0; i < width * height; i++)
+    {
+        uint32_t val = image[i] + ntohs(pixel[i]);
+        image[i]     = val > 0xFFFF ? 0xFFFF : val;
+    }
+}
+
 /**
  * Download image from FireFly
  */
@@ -607,20 +740,10 @@ void FFMVCCD::grabImage()
 {
     dc1394error_t err;
     dc1394video_frame_t *frame;
-    uint32_t uheight, uwidth;
     int sub;
-    uint16_t val;
     struct timeval start, end;
 
     std::unique_lock<std::mutex> guard(ccdBufferLock);
-    // Let's get a pointer to the frame buffer
-    uint8_t *image = PrimaryCCD.getFrameBuffer();
-
-    // Get width and height
-    int width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
-    int height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
-
-    memset(image, 0, PrimaryCCD.getFrameBufferSize());
 
     /*-----------------------------------------------------------------------
     *  stop data transmission
@@ -631,35 +754,20 @@ void FFMVCCD::grabImage()
     {
         LOGF_DEBUG("Getting sub %d of %d", sub, sub_count);
         err = dc1394_capture_dequeue(dcam, DC1394_CAPTURE_POLICY_WAIT, &frame);
-        if (err != DC1394_SUCCESS)
+        if (err != DC1394_SUCCESS || frame == nullptr)
         {
             LOG_ERROR("Could not capture frame");
+            continue;
         }
-        dc1394_get_image_size_from_video_mode(dcam, DC1394_VIDEO_MODE_640x480_MONO16, &uwidth, &uheight);
 
         if (DC1394_TRUE == dc1394_capture_is_frame_corrupt(dcam, frame))
         {
             LOG_ERROR("Corrupt frame!");
+            dc1394_capture_enqueue(dcam, frame);
             continue;
         }
-        // Fill buffer with random pattern
-        for (int i = 0; i < height; i++)
-        {
-            for (int j = 0; j < width; j++)
-            {
-                /* Detect unsigned overflow */
-                val = ((uint16_t *)image)[i * width + j] + ntohs(((uint16_t *)(frame->image))[i * width + j]);
-                if (val > ((uint16_t *)image)[i * width + j])
-                {
-                    ((uint16_t *)image)[i * width + j] = val;
-                }
-                else
-                {
-                    ((uint16_t *)image)[i * width + j] = 0xFFFF;
-                }
-            }
-        }
 
+        accumulateFrame(frame);
         dc1394_capture_enqueue(dcam, frame);
     }
     guard.unlock();
@@ -670,3 +778,129 @@ void FFMVCCD::grabImage()
     // Let INDI::CCD know we're done filling the image buffer
     ExposureComplete(&PrimaryCCD);
 }
+
+/**************************************************************************************
+** Keep isochronous transmission running and hand frames out from the capture worker
+***************************************************************************************/
+bool FFMVCCD::startCapture()
+{
+    if (capturing)
+        return true;
+
+    LOG_DEBUG("start continuous transmission");
+    if (dc1394_video_set_transmission(dcam, DC1394_ON) != DC1394_SUCCESS)
+    {
+        LOG_ERROR("Unable to start transmission");
+        return false;
+    }
+
+    capturing = true;
+    captureWorker.start(std::bind(&FFMVCCD::workerCapture, this, std::placeholders::_1));
+    return true;
+}
+
+void FFMVCCD::stopCapture()
+{
+    if (!capturing)
+        return;
+
+    captureWorker.quit();
+    capturing = false;
+
+    LOG_DEBUG("stop continuous transmission");
+    dc1394_video_set_transmission(dcam, DC1394_OFF);
+}
+
+void FFMVCCD::workerCapture(const std::atomic_bool &isAboutToQuit)
+{
+    dc1394video_frame_t *frame;
+    struct pollfd pfd;
+
+    pfd.fd     = dc1394_capture_get_fileno(dcam);
+    pfd.events = POLLIN;
+
+    while (!isAboutToQuit)
+    {
+        // Wake up regularly so a stop request is noticed even when no frames arrive
+        if (poll(&pfd, 1, CAPTURE_POLL_MS) <= 0)
+            continue;
+
+        if (dc1394_capture_dequeue(dcam, DC1394_CAPTURE_POLICY_POLL, &frame) != DC1394_SUCCESS)
+        {
+            LOG_ERROR("Could not capture frame");
+            break;
+        }
+        if (frame == nullptr)
+            continue;
+
+        if (DC1394_TRUE == dc1394_capture_is_frame_corrupt(dcam, frame))
+        {
+            LOG_DEBUG("Corrupt frame dropped.");
+            dc1394_capture_enqueue(dcam, frame);
+            continue;
+        }
+
+        if (Streamer->isBusy())
+        {
+            const uint16_t *pixel = reinterpret_cast<const uint16_t *>(frame->image);
+            for (size_t i = 0; i < streamFrame.size(); i++)
+                streamFrame[i] = ntohs(pixel[i]);
+        }
+
+        bool exposureDone = false;
+        if (subs_pending > 0 && frame->timestamp >= subs_not_before)
+        {
+            std::unique_lock<std::mutex> guard(ccdBufferLock);
+            accumulateFrame(frame);
+            exposureDone = (--subs_pending == 0);
+        }
+
+        // Give the buffer back to the ring before the slower consumers run
+        dc1394_capture_enqueue(dcam, frame);
+
+        if (Streamer->isBusy())
+            Streamer->newFrame(reinterpret_cast<const uint8_t *>(streamFrame.data()),
+                               streamFrame.size() * sizeof(uint16_t));
+
+        if (exposureDone)
+            subs_done = true;
+    }
+}
+
+/**************************************************************************************
+** Streaming runs the sensor at the target frame rate off the continuous capture
+***************************************************************************************/
+bool FFMVCCD::StartStreaming()
+{
+    if (InExposure)
+    {
+        LOG_ERROR("Cannot start streaming while exposing.");
+        return false;
+    }
+
+    float duration = 1.0 / Streamer->getTargetFPS();
+    if (duration > max_exposure)
+        duration = max_exposure;
+
+    if (!setSubLength(duration))
+        return false;
+
+    return startCapture();
+}
+
+bool FFMVCCD::StopStreaming()
+{
+    if (CaptureModeS[CAPTURE_CONTINUOUS].s != ISS_ON)
+        stopCapture();
+
+    return true;
+}
+
+bool FFMVCCD::saveConfigItems(FILE *fp)
+{
+    INDI::CCD::saveConfigItems(fp);
+
+    IUSaveConfigSwitch(fp, &CaptureModeSP);
+
+    return true;
+}
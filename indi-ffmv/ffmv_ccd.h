@@ -21,8 +21,12 @@
 #define FFMVCCD_H
 
 #include <indiccd.h>
+#include <indisinglethreadpool.h>
 #include <dc1394/dc1394.h>
 
+#include <atomic>
+#include <vector>
+
 using namespace std;
 
 class FFMVCCD : public INDI::CCD
@@ -45,6 +49,12 @@ class FFMVCCD : public INDI::CCD
     bool AbortExposure();
     void TimerHit();
 
+    // Streaming
+    bool StartStreaming();
+    bool StopStreaming();
+
+    bool saveConfigItems(FILE *fp);
+
   private:
     // Utility functions
     float CalcTimeLeft();
@@ -55,9 +65,16 @@ class FFMVCCD : public INDI::CCD
 
     dc1394error_t setGainVref(ISState iss);
     dc1394error_t setDigitalGain(ISState state);
+    bool setSubLength(float duration);
 
-    // Are we exposing?
-    bool InExposure;
+    // Continuous capture
+    bool startCapture();
+    void stopCapture();
+    void workerCapture(const std::atomic_bool &isAboutToQuit);
+    void accumulateFrame(const dc1394video_frame_t *frame);
+
+    // Are we exposing? Read by the capture worker
+    std::atomic_bool InExposure;
     bool capturing;
     // Struct to keep timing
     struct timeval ExpStart;
@@ -66,10 +83,22 @@ class FFMVCCD : public INDI::CCD
     float max_exposure;
     float last_exposure_length;
     int sub_count;
+    float sub_length;
+
+    // Continuous capture state, shared with the capture worker
+    INDI::SingleThreadPool captureWorker;
+    std::atomic_int subs_pending;
+    // Set by the capture worker once the last sub is in, TimerHit completes the exposure
+    std::atomic_bool subs_done;
+    uint64_t subs_not_before;
+    std::vector<uint16_t> streamFrame;
 
     ISwitch GainS[2];
     ISwitchVectorProperty GainSP;
 
+    ISwitch CaptureModeS[2];
+    ISwitchVectorProperty CaptureModeSP;
+
     dc1394_t *dc1394;
     dc1394camera_t *dcam;
 
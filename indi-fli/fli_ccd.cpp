@@ -91,7 +91,7 @@ bool FLICCD::initProperties()
     IUFillSwitchVector(&BackgroundFlushSP, BackgroundFlushS, 2, getDeviceName(), "CCD_BACKGROUND_FLUSH", "BKG. Flush",
                        OPTIONS_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
 
-    SetCCDCapability(CCD_CAN_ABORT | CCD_CAN_BIN | CCD_CAN_SUBFRAME | CCD_HAS_COOLER | CCD_HAS_SHUTTER);
+    SetCCDCapability(CCD_CAN_ABORT | CCD_CAN_BIN | CCD_CAN_SUBFRAME | CCD_HAS_COOLER | CCD_HAS_SHUTTER | CCD_HAS_STREAMING);
 
     PrimaryCCD.setMinMaxStep("CCD_EXPOSURE", "CCD_EXPOSURE_VALUE", 0.04, 3600, 1, false);
 
@@ -271,6 +271,8 @@ bool FLICCD::Disconnect()
 {
     int err;
 
+    stopVideo();
+
     if (sim)
         return true;
 
@@ -512,6 +514,12 @@ bool FLICCD::StartExposure(float duration)
         duration = 0;
     }
 
+    if (videoRunning)
+    {
+        LOG_ERROR("Cannot take exposure while streaming.");
+        return false;
+    }
+
     if (!sim)
     {
         if ((err = FLISetExposureTime(fli_dev, (long)(duration * 1000))))
@@ -640,6 +648,105 @@ bool FLICCD::UpdateCCDBin(int binx, int biny)
     return UpdateCCDFrame(PrimaryCCD.getSubX(), PrimaryCCD.getSubY(), PrimaryCCD.getSubW(), PrimaryCCD.getSubH());
 }
 
+bool FLICCD::StartStreaming()
+{
+    int err = 0;
+
+    if (InExposure)
+    {
+        LOG_ERROR("Cannot start streaming while exposing.");
+        return false;
+    }
+
+    double duration = 1.0 / Streamer->getTargetFPS();
+
+    if (!sim)
+    {
+        if ((err = FLISetExposureTime(fli_dev, (long)(duration * 1000))))
+        {
+            LOGF_ERROR("FLISetExposureTime() failed. %s.", strerror(-err));
+            return false;
+        }
+
+        // Only some models support video mode, the library tells us here
+        if ((err = FLIStartVideoMode(fli_dev)))
+        {
+            LOGF_ERROR("FLIStartVideoMode() failed. %s. Video mode may not be supported by this camera.", strerror(-err));
+            return false;
+        }
+    }
+
+    // Pool is sized once per stream, the frame can't change while streaming
+    size_t size = PrimaryCCD.getFrameBufferSize();
+    videoPool.resize(VIDEO_POOL_SIZE);
+    for (auto &buffer : videoPool)
+        buffer.resize(size);
+
+    Streamer->setPixelFormat(INDI_MONO, 16);
+    Streamer->setSize(PrimaryCCD.getSubW() / PrimaryCCD.getBinX(), PrimaryCCD.getSubH() / PrimaryCCD.getBinY());
+
+    LOGF_DEBUG("Starting video mode with %g seconds exposures...", duration);
+
+    videoRunning = true;
+    videoThread = std::thread(&FLICCD::streamVideo, this);
+
+    return true;
+}
+
+bool FLICCD::StopStreaming()
+{
+    stopVideo();
+    return true;
+}
+
+void FLICCD::stopVideo()
+{
+    if (!videoThread.joinable())
+        return;
+
+    videoRunning = false;
+    videoThread.join();
+
+    int err = 0;
+    if (!sim && (err = FLIStopVideoMode(fli_dev)))
+        LOGF_ERROR("FLIStopVideoMode() failed. %s.", strerror(-err));
+
+    videoPool.clear();
+}
+
+void FLICCD::streamVideo()
+{
+    int err = 0;
+    int index = 0;
+    bool failed = false;
+    double duration = 1.0 / Streamer->getTargetFPS();
+
+    while (videoRunning)
+    {
+        std::vector<uint8_t> &buffer = videoPool[index];
+        index = (index + 1) % VIDEO_POOL_SIZE;
+
+        if (sim)
+        {
+            usleep(duration * 1e6);
+            for (auto &pixel : buffer)
+                pixel = rand() % 255;
+        }
+        else if ((err = FLIGrabVideoFrame(fli_dev, buffer.data(), buffer.size())))
+        {
+            // Report once, keep trying until the stream is stopped
+            if (!failed)
+                LOGF_ERROR("FLIGrabVideoFrame() failed. %s.", strerror(-err));
+            failed = true;
+            usleep(100000);
+            continue;
+        }
+
+        failed = false;
+        Streamer->newFrame(buffer.data(), buffer.size());
+    }
+}
+
 // Downloads the image from the CCD.
 bool FLICCD::grabImage()
 {
@@ -742,6 +849,13 @@ void FLICCD::TimerHit()
         }
     }
 
+    // The video thread owns the device while streaming
+    if (videoRunning)
+    {
+        SetTimer(getCurrentPollingPeriod());
+        return;
+    }
+
     switch (TemperatureNP.s)
     {
         case IPS_IDLE:
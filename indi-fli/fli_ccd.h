@@ -26,6 +26,9 @@
 #include <libfli.h>
 #include <indiccd.h>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
@@ -57,6 +60,10 @@ class FLICCD : public INDI::CCD
         virtual bool UpdateCCDBin(int binx, int biny) override;
         virtual bool UpdateCCDFrameType(INDI::CCDChip::CCD_FRAME fType) override;
 
+        // Streaming
+        virtual bool StartStreaming() override;
+        virtual bool StopStreaming() override;
+
         virtual void debugTriggered(bool enable) override;
         virtual bool saveConfigItems(FILE *fp) override;
 
@@ -73,6 +80,10 @@ class FLICCD : public INDI::CCD
         // Get initial CCD values upon connection
         bool setupParams();
 
+        // Grab whole video frames on a worker thread until streaming stops
+        void streamVideo();
+        void stopVideo();
+
         typedef struct
         {
             flidomain_t domain;
@@ -116,6 +127,12 @@ class FLICCD : public INDI::CCD
         flidev_t fli_dev;
         cam_t FLICam;
 
+        // Video mode
+        std::thread videoThread;
+        std::atomic_bool videoRunning { false };
+        std::vector<std::vector<uint8_t>> videoPool;
+        static const int VIDEO_POOL_SIZE = 3;
+
         // Simulation mode
         bool sim = false;
 };
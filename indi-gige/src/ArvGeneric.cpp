@@ -18,6 +18,8 @@
  */
 #include "ArvGeneric.h"
 
+#include <string.h>
+
 using namespace arv;
 
 const char *ArvGeneric::_str_val(const char *s)
@@ -108,6 +110,11 @@ ArvGeneric::ArvGeneric(void *camera_device) : ArvCamera(camera_device)
     this->camera = (::ArvCamera *)camera_device;
     this->dev    = arv_camera_get_device(this->camera);
 
+    /* aravis defaults: always request resends, automatic socket buffer */
+    this->stream_cfg.packet_resend      = true;
+    this->stream_cfg.socket_buffer_size = 0;
+    memset(&this->stream_stats, 0, sizeof(this->stream_stats));
+
     this->cam.model_name  = arv_camera_get_model_name(this->camera);
     this->cam.vendor_name = arv_camera_get_vendor_name(this->camera);
     this->cam.device_id   = arv_camera_get_device_id(this->camera);
@@ -287,9 +294,47 @@ void ArvGeneric::set_exposure_time(double const val)
 ::ArvStream *ArvGeneric::_stream_create(void)
 {
     ::ArvStream *stream = arv_camera_create_stream(this->camera, nullptr, nullptr);
+    if (stream)
+        this->_stream_configure(stream);
     return stream;
 }
 
+void ArvGeneric::_stream_configure(::ArvStream *stream)
+{
+    if (!ARV_IS_GV_STREAM(stream))
+        return;
+
+    g_object_set(stream, "packet-resend",
+                 this->stream_cfg.packet_resend ? ARV_GV_STREAM_PACKET_RESEND_ALWAYS : ARV_GV_STREAM_PACKET_RESEND_NEVER,
+                 nullptr);
+
+    if (this->stream_cfg.socket_buffer_size > 0)
+        g_object_set(stream, "socket-buffer", ARV_GV_STREAM_SOCKET_BUFFER_FIXED, "socket-buffer-size",
+                     this->stream_cfg.socket_buffer_size, nullptr);
+    else
+        g_object_set(stream, "socket-buffer", ARV_GV_STREAM_SOCKET_BUFFER_AUTO, nullptr);
+}
+
+void ArvGeneric::_stream_statistics_add(ARV_STREAM_STATISTICS *stats)
+{
+    if (!this->stream)
+        return;
+
+    guint64 completed = 0, failures = 0, underruns = 0;
+    arv_stream_get_statistics(this->stream, &completed, &failures, &underruns);
+    stats->completed += completed;
+    stats->failures += failures;
+    stats->underruns += underruns;
+
+    if (ARV_IS_GV_STREAM(this->stream))
+    {
+        guint64 resent = 0, missing = 0;
+        arv_gv_stream_get_statistics(ARV_GV_STREAM(this->stream), &resent, &missing);
+        stats->resent_packets += resent;
+        stats->missing_packets += missing;
+    }
+}
+
 void ArvGeneric::_stream_start()
 {
     this->stream_active = true;
@@ -301,9 +346,10 @@ void ArvGeneric::_stream_start()
 
 void ArvGeneric::_stream_stop()
 {
-    /* stop the acquisition stream */
+    /* stop the acquisition stream, keeping its counters */
     arv_camera_stop_acquisition(this->camera);
-    g_object_unref(this->stream);
+    this->_stream_statistics_add(&this->stream_stats);
+    g_clear_object(&this->stream);
 
     this->stream_active = false;
 }
@@ -382,3 +428,64 @@ ARV_EXPOSURE_STATUS ArvGeneric::exposure_poll(void (*fn_image_callback)(void *co
             return ARV_EXPOSURE_UNKNOWN;
     }
 }
+
+bool ArvGeneric::is_gv_device(void)
+{
+    return this->is_connected() && arv_camera_is_gv_device(this->camera);
+}
+
+int ArvGeneric::negotiate_packet_size(void)
+{
+    if (!this->is_gv_device())
+        return 0;
+
+    /* Probes the link with test packets, picks jumbo frames when every hop supports them */
+    this->_test_exposure_and_abort();
+    return arv_camera_gv_auto_packet_size(this->camera);
+}
+
+int ArvGeneric::get_packet_size(void)
+{
+    return this->is_gv_device() ? arv_camera_gv_get_packet_size(this->camera) : 0;
+}
+
+void ArvGeneric::set_packet_size(int const val)
+{
+    if (!this->is_gv_device())
+        return;
+
+    this->_test_exposure_and_abort();
+    arv_camera_gv_set_packet_size(this->camera, val);
+}
+
+int64_t ArvGeneric::get_packet_delay(void)
+{
+    return this->is_gv_device() ? arv_camera_gv_get_packet_delay(this->camera) : 0;
+}
+
+void ArvGeneric::set_packet_delay(int64_t const val)
+{
+    if (!this->is_gv_device())
+        return;
+
+    this->_test_exposure_and_abort();
+    arv_camera_gv_set_packet_delay(this->camera, val);
+}
+
+void ArvGeneric::set_packet_resend(bool const enable)
+{
+    this->stream_cfg.packet_resend = enable;
+}
+
+void ArvGeneric::set_socket_buffer_size(int const val)
+{
+    this->stream_cfg.socket_buffer_size = (val > 0 ? val : 0);
+}
+
+ARV_STREAM_STATISTICS ArvGeneric::get_stream_statistics(void)
+{
+    ARV_STREAM_STATISTICS stats = this->stream_stats;
+    if (this->_stream_active())
+        this->_stream_statistics_add(&stats);
+    return stats;
+}
@@ -66,6 +66,16 @@ class ArvGeneric : public arv::ArvCamera
     ARV_EXPOSURE_STATUS exposure_poll(void (*fn_image_callback)(void *const, uint8_t const *const, size_t),
                                       void *const usr_ptr);
 
+    bool is_gv_device(void);
+    int negotiate_packet_size(void);
+    int get_packet_size(void);
+    void set_packet_size(int const val);
+    int64_t get_packet_delay(void);
+    void set_packet_delay(int64_t const val);
+    void set_packet_resend(bool const enable);
+    void set_socket_buffer_size(int const val);
+    ARV_STREAM_STATISTICS get_stream_statistics(void);
+
   protected:
     void _init(void);
     bool _configure(void);
@@ -92,10 +102,22 @@ class ArvGeneric : public arv::ArvCamera
     bool _stream_active();
     void _stream_start();
     void _stream_stop();
+    void _stream_configure(::ArvStream *stream);
+    void _stream_statistics_add(ARV_STREAM_STATISTICS *stats);
     void _trigger_exposure();
 
     bool stream_active;
 
+    /* GigE Vision stream settings, applied to every new stream */
+    struct
+    {
+        bool packet_resend;
+        gint socket_buffer_size; /* 0 lets aravis size the socket buffer from the payload */
+    } stream_cfg;
+
+    /* Totals of the streams already torn down */
+    ARV_STREAM_STATISTICS stream_stats;
+
     /* Camera properties */
     struct
     {
@@ -33,6 +33,15 @@ typedef enum {
 
 } ARV_EXPOSURE_STATUS;
 
+typedef struct
+{
+    uint64_t completed;       //!< Buffers received completely
+    uint64_t failures;        //!< Buffers dropped because of missing or wrong packets, timeouts or size mismatch
+    uint64_t underruns;       //!< Frames lost because no buffer was queued on the stream
+    uint64_t resent_packets;  //!< Packets recovered through resend requests
+    uint64_t missing_packets; //!< Packets that were never received
+} ARV_STREAM_STATISTICS;
+
 template <class T>
 class min_max_property
 {
@@ -109,6 +118,17 @@ class ArvCamera
     virtual void exposure_abort(void)                      = 0;
     virtual ARV_EXPOSURE_STATUS exposure_poll(void (*fn_image_callback)(void *const, uint8_t const *const, size_t),
                                               void *const) = 0;
+
+    /* GigE Vision stream tuning, no-ops for other transports */
+    virtual bool is_gv_device(void)                           = 0;
+    virtual int negotiate_packet_size(void)                   = 0;
+    virtual int get_packet_size(void)                         = 0;
+    virtual void set_packet_size(int const val)               = 0;
+    virtual int64_t get_packet_delay(void)                    = 0;
+    virtual void set_packet_delay(int64_t const val)          = 0;
+    virtual void set_packet_resend(bool const enable)         = 0;
+    virtual void set_socket_buffer_size(int const val)        = 0;
+    virtual ARV_STREAM_STATISTICS get_stream_statistics(void) = 0;
 };
 
 class ArvFactory
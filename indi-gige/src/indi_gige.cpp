@@ -45,6 +45,24 @@
 #define TIMER_TICK_MS  (100)
 #define CAPS           (CCD_CAN_ABORT | CCD_CAN_BIN | CCD_CAN_SUBFRAME)
 
+#define STREAM_TAB "Stream"
+
+enum
+{
+    STREAM_PACKET_SIZE,
+    STREAM_PACKET_DELAY,
+    STREAM_SOCKET_BUFFER,
+};
+
+enum
+{
+    STATS_COMPLETED,
+    STATS_FAILURES,
+    STATS_UNDERRUNS,
+    STATS_RESENT,
+    STATS_MISSING,
+};
+
 static class Loader
 {
     std::deque<std::unique_ptr<GigECCD>> cameras;
@@ -126,12 +144,85 @@ void GigECCD::_update_indi_properties(void)
 
     defineProperty(&indiprop_info_prop);
     defineProperty(&this->indiprop_gain_prop);
+
+    if (!this->camera->is_gv_device())
+        return;
+
+    /* Find the largest packet size the link can carry, jumbo frames included */
+    int const packet_size = this->camera->negotiate_packet_size();
+    LOGF_INFO("Negotiated GigE packet size %i bytes", packet_size);
+
+    IUFillNumber(&this->indiprop_stream[STREAM_PACKET_SIZE], "PACKET_SIZE", "Packet size (bytes)", "%.f", 576, 9000, 4,
+                 packet_size);
+    IUFillNumber(&this->indiprop_stream[STREAM_PACKET_DELAY], "PACKET_DELAY", "Inter-packet delay (ns)", "%.f", 0,
+                 1000000, 100, (double)this->camera->get_packet_delay());
+    IUFillNumber(&this->indiprop_stream[STREAM_SOCKET_BUFFER], "SOCKET_BUFFER", "Socket buffer (bytes, 0=auto)", "%.f", 0,
+                 256 * 1024 * 1024, 1024 * 1024, 0);
+    IUFillNumberVector(&this->indiprop_stream_prop, this->indiprop_stream, 3, getDeviceName(), "GIGE_STREAM",
+                       "Stream Tuning", STREAM_TAB, IP_RW, 60, IPS_IDLE);
+
+    IUFillSwitch(&this->indiprop_resend[0], "RESEND_ON", "On", ISS_ON);
+    IUFillSwitch(&this->indiprop_resend[1], "RESEND_OFF", "Off", ISS_OFF);
+    IUFillSwitchVector(&this->indiprop_resend_prop, this->indiprop_resend, 2, getDeviceName(), "GIGE_PACKET_RESEND",
+                       "Packet Resend", STREAM_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+
+    IUFillSwitch(&this->indiprop_negotiate[0], "NEGOTIATE", "Negotiate", ISS_OFF);
+    IUFillSwitchVector(&this->indiprop_negotiate_prop, this->indiprop_negotiate, 1, getDeviceName(),
+                       "GIGE_PACKET_NEGOTIATE", "Packet Size", STREAM_TAB, IP_RW, ISR_ATMOST1, 60, IPS_IDLE);
+
+    IUFillNumber(&this->indiprop_stats[STATS_COMPLETED], "COMPLETED", "Completed buffers", "%.f", 0, 1e15, 0, 0);
+    IUFillNumber(&this->indiprop_stats[STATS_FAILURES], "FAILURES", "Failed buffers", "%.f", 0, 1e15, 0, 0);
+    IUFillNumber(&this->indiprop_stats[STATS_UNDERRUNS], "UNDERRUNS", "Buffer underruns", "%.f", 0, 1e15, 0, 0);
+    IUFillNumber(&this->indiprop_stats[STATS_RESENT], "RESENT_PACKETS", "Resent packets", "%.f", 0, 1e15, 0, 0);
+    IUFillNumber(&this->indiprop_stats[STATS_MISSING], "MISSING_PACKETS", "Missing packets", "%.f", 0, 1e15, 0, 0);
+    IUFillNumberVector(&this->indiprop_stats_prop, this->indiprop_stats, 5, getDeviceName(), "GIGE_STREAM_STATS",
+                       "Statistics", STREAM_TAB, IP_RO, 0, IPS_IDLE);
+
+    defineProperty(&this->indiprop_stream_prop);
+    defineProperty(&this->indiprop_resend_prop);
+    defineProperty(&this->indiprop_negotiate_prop);
+    defineProperty(&this->indiprop_stats_prop);
+    this->_update_stream_statistics();
 }
 
 void GigECCD::_delete_indi_properties(void)
 {
     this->deleteProperty(this->indiprop_gain_prop.name);
     this->deleteProperty(this->indiprop_info_prop.name);
+
+    if (!this->camera->is_gv_device())
+        return;
+
+    this->deleteProperty(this->indiprop_stream_prop.name);
+    this->deleteProperty(this->indiprop_resend_prop.name);
+    this->deleteProperty(this->indiprop_negotiate_prop.name);
+    this->deleteProperty(this->indiprop_stats_prop.name);
+}
+
+void GigECCD::_update_stream_tuning(void)
+{
+    this->camera->set_packet_size((int)this->indiprop_stream[STREAM_PACKET_SIZE].value);
+    this->camera->set_packet_delay((int64_t)this->indiprop_stream[STREAM_PACKET_DELAY].value);
+    this->camera->set_socket_buffer_size((int)this->indiprop_stream[STREAM_SOCKET_BUFFER].value);
+
+    /* Get-back from camera system, it may round to its own increments */
+    this->indiprop_stream[STREAM_PACKET_SIZE].value  = this->camera->get_packet_size();
+    this->indiprop_stream[STREAM_PACKET_DELAY].value = (double)this->camera->get_packet_delay();
+}
+
+void GigECCD::_update_stream_statistics(void)
+{
+    if (!this->camera->is_gv_device())
+        return;
+
+    arv::ARV_STREAM_STATISTICS const stats = this->camera->get_stream_statistics();
+    this->indiprop_stats[STATS_COMPLETED].value = (double)stats.completed;
+    this->indiprop_stats[STATS_FAILURES].value  = (double)stats.failures;
+    this->indiprop_stats[STATS_UNDERRUNS].value = (double)stats.underruns;
+    this->indiprop_stats[STATS_RESENT].value    = (double)stats.resent_packets;
+    this->indiprop_stats[STATS_MISSING].value   = (double)stats.missing_packets;
+    this->indiprop_stats_prop.s = (stats.failures || stats.underruns) ? IPS_ALERT : IPS_OK;
+    IDSetNumber(&this->indiprop_stats_prop, nullptr);
 }
 
 //Initial call
@@ -207,6 +298,7 @@ void GigECCD::_update_image(uint8_t const *const data, size_t size)
     {
         uint8_t *const image = PrimaryCCD.getFrameBuffer();
         memcpy(image, (void *const)data, frame_buf_size);
+        this->_update_stream_statistics();
         this->ExposureComplete(&PrimaryCCD);
     }
     else
@@ -229,6 +321,16 @@ void GigECCD::_handle_failed(void)
 
     camera->exposure_abort();
 
+    if (this->camera->is_gv_device())
+    {
+        arv::ARV_STREAM_STATISTICS const stats = this->camera->get_stream_statistics();
+        LOGF_ERROR("Stream totals: %llu failed buffers, %llu underruns, %llu missing and %llu resent packets. "
+                   "Consider a larger inter-packet delay or socket buffer.",
+                   (unsigned long long)stats.failures, (unsigned long long)stats.underruns,
+                   (unsigned long long)stats.missing_packets, (unsigned long long)stats.resent_packets);
+        this->_update_stream_statistics();
+    }
+
     PrimaryCCD.setExposureLeft(0);
 
     /* Fill with black */
@@ -301,11 +403,64 @@ bool GigECCD::ISNewNumber(const char *dev, const char *name, double values[], ch
             IDSetNumber(&this->indiprop_gain_prop, nullptr);
             return true;
         }
+
+        if (!strcmp(name, this->indiprop_stream_prop.name))
+        {
+            IUUpdateNumber(&this->indiprop_stream_prop, values, names, n);
+            this->_update_stream_tuning();
+            this->indiprop_stream_prop.s = IPS_OK;
+            IDSetNumber(&this->indiprop_stream_prop, nullptr);
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewNumber(dev, name, values, names, n);
 }
 
+bool GigECCD::ISNewSwitch(const char *dev, const char *name, ISState *states, char *names[], int n)
+{
+    if (!strcmp(dev, this->getDeviceName()))
+    {
+        if (!strcmp(name, this->indiprop_resend_prop.name))
+        {
+            IUUpdateSwitch(&this->indiprop_resend_prop, states, names, n);
+            this->camera->set_packet_resend(this->indiprop_resend[0].s == ISS_ON);
+            this->indiprop_resend_prop.s = IPS_OK;
+            IDSetSwitch(&this->indiprop_resend_prop, nullptr);
+            return true;
+        }
+
+        if (!strcmp(name, this->indiprop_negotiate_prop.name))
+        {
+            int const packet_size = this->camera->negotiate_packet_size();
+            LOGF_INFO("Negotiated GigE packet size %i bytes", packet_size);
+
+            this->indiprop_stream[STREAM_PACKET_SIZE].value = packet_size;
+            IDSetNumber(&this->indiprop_stream_prop, nullptr);
+
+            IUResetSwitch(&this->indiprop_negotiate_prop);
+            this->indiprop_negotiate_prop.s = (packet_size > 0) ? IPS_OK : IPS_ALERT;
+            IDSetSwitch(&this->indiprop_negotiate_prop, nullptr);
+            return true;
+        }
+    }
+
+    return INDI::CCD::ISNewSwitch(dev, name, states, names, n);
+}
+
+bool GigECCD::saveConfigItems(FILE *fp)
+{
+    INDI::CCD::saveConfigItems(fp);
+
+    if (this->camera->is_gv_device())
+    {
+        IUSaveConfigNumber(fp, &this->indiprop_stream_prop);
+        IUSaveConfigSwitch(fp, &this->indiprop_resend_prop);
+    }
+
+    return true;
+}
+
 bool GigECCD::UpdateCCDFrame(int x, int y, int w, int h)
 {
     LOGF_INFO("%s x=%i y=%i w=%i h=%i", __PRETTY_FUNCTION__, x, y, w, h);
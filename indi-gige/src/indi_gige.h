@@ -49,6 +49,7 @@ class GigECCD : public INDI::CCD
     virtual bool UpdateCCDFrame(int x, int y, int w, int h);
     virtual bool UpdateCCDBin(int binx, int biny);
     virtual bool UpdateCCDFrameType(INDI::CCDChip::CCD_FRAME fType);
+    virtual bool saveConfigItems(FILE *fp);
 
   private:
     void _delete_indi_properties(void);
@@ -59,6 +60,8 @@ class GigECCD : public INDI::CCD
 
     void _handle_failed(void);
     void _handle_timeout(struct timeval *const tv, uint32_t timeout_us);
+    void _update_stream_tuning(void);
+    void _update_stream_statistics(void);
 
     arv::ArvCamera *camera;
     char name[32];
@@ -73,7 +76,18 @@ class GigECCD : public INDI::CCD
     IText indiprop_info[3] {};
     ITextVectorProperty indiprop_info_prop;
 
+    /* GigE Vision stream tuning and telemetry */
+    INumber indiprop_stream[3] {};
+    INumberVectorProperty indiprop_stream_prop {};
+    ISwitch indiprop_resend[2] {};
+    ISwitchVectorProperty indiprop_resend_prop {};
+    ISwitch indiprop_negotiate[1] {};
+    ISwitchVectorProperty indiprop_negotiate_prop {};
+    INumber indiprop_stats[5] {};
+    INumberVectorProperty indiprop_stats_prop {};
+
     virtual bool ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n);
+    virtual bool ISNewSwitch(const char *dev, const char *name, ISState *states, char *names[], int n);
 
     friend void ::ISGetProperties(const char *dev);
     friend void ::ISNewSwitch(const char *dev, const char *name, ISState *states, char *names[], int num);
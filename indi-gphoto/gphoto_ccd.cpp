@@ -2126,6 +2126,28 @@ void GPhotoCCD::addFITSKeywords(fitsfile * fptr, INDI::CCDChip * targetChip)
     {
         fits_update_key_s(fptr, TDOUBLE, "CCD-TEMP", &(TemperatureN[0].value), "CCD Temperature (Celsius)", &status);
     }
+
+    // Bulb exposures are timed by the driver, so record when the shutter was actually driven open and closed
+    struct timespec openUTC, closeUTC;
+    double measured = 0;
+    if (!isSimulation() && gphoto_get_bulb_timing(gphotodrv, &openUTC, &closeUTC, &measured))
+    {
+        auto formatUTC = [](const struct timespec & ts, char *out, size_t len)
+        {
+            struct tm tp;
+            char base[32];
+            gmtime_r(&ts.tv_sec, &tp);
+            strftime(base, sizeof(base), "%Y-%m-%dT%H:%M:%S", &tp);
+            snprintf(out, len, "%s.%03ld", base, ts.tv_nsec / 1000000);
+        };
+
+        char ts[64];
+        formatUTC(openUTC, ts, sizeof(ts));
+        fits_update_key_str(fptr, "SHUTOPEN", ts, "UTC shutter open command", &status);
+        formatUTC(closeUTC, ts, sizeof(ts));
+        fits_update_key_str(fptr, "SHUTCLOS", ts, "UTC shutter close command", &status);
+        fits_update_key_s(fptr, TDOUBLE, "EXPMEAS", &measured, "Measured bulb exposure duration (s)", &status);
+    }
 }
 
 bool GPhotoCCD::UpdateCCDUploadMode(CCD_UPLOAD_MODE mode)
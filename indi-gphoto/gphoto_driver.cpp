@@ -19,11 +19,14 @@
   The full GNU General Public License is included in this distribution in the
   file called LICENSE.
 *******************************************************************************/
+#include <errno.h>
 #include <fcntl.h>
 #include <pthread.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <time.h>
+#include <algorithm>
 #include <cstdlib>
 
 #include <config.h>
@@ -124,7 +127,13 @@ struct _gphoto_driver
     CameraWidget *config;
     CameraFilePath camerapath;
     int command;
-    struct timeval bulb_end;
+    // Bulb deadline on CLOCK_MONOTONIC so wall clock steps (NTP, GPS) cannot stretch or cut an exposure
+    struct timespec bulb_end;
+    // Measured shutter timing of the last bulb exposure
+    struct timespec bulb_open_mono;
+    struct timespec bulb_close_mono;
+    struct timespec bulb_open_utc;
+    bool bulb_timing_valid {false};
 
     char filename[80];
     int width;
@@ -186,6 +195,75 @@ enum
 static char device[64];
 static int RTS_flag = TIOCM_RTS;
 
+// The condition variable wakes us this long before the bulb deadline, the rest is spent spinning on the
+// monotonic clock so the close command is not at the mercy of scheduler wakeup latency.
+#define BULB_SPIN_USEC 2000
+
+static int64_t timespec_diff_usec(const struct timespec *a, const struct timespec *b)
+{
+    return (static_cast<int64_t>(a->tv_sec) - b->tv_sec) * 1000000LL + (a->tv_nsec - b->tv_nsec) / 1000;
+}
+
+static void timespec_add_usec(struct timespec *ts, int64_t usec)
+{
+    int64_t nsec = ts->tv_nsec + (usec % 1000000) * 1000;
+    ts->tv_sec += usec / 1000000 + nsec / 1000000000;
+    ts->tv_nsec = nsec % 1000000000;
+    if (ts->tv_nsec < 0)
+    {
+        ts->tv_nsec += 1000000000;
+        ts->tv_sec--;
+    }
+}
+
+// Sleep until the CLOCK_MONOTONIC deadline: coarse nanosleep first, then spin for the last BULB_SPIN_USEC.
+static void sleep_until_monotonic(const struct timespec *deadline)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t left = timespec_diff_usec(deadline, &now);
+
+    if (left > BULB_SPIN_USEC)
+    {
+        int64_t coarse = left - BULB_SPIN_USEC;
+        struct timespec rel;
+        rel.tv_sec  = coarse / 1000000;
+        rel.tv_nsec = (coarse % 1000000) * 1000;
+        while (nanosleep(&rel, &rel) == -1 && errno == EINTR)
+            ;
+    }
+
+    do
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    }
+    while (timespec_diff_usec(deadline, &now) > 0);
+}
+
+static void sleep_monotonic_usec(int64_t usec)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    timespec_add_usec(&deadline, usec);
+    sleep_until_monotonic(&deadline);
+}
+
+// Wait on the driver condition until the CLOCK_MONOTONIC deadline. gphoto_open() binds the condition
+// to the monotonic clock where pthread_condattr_setclock() exists; macOS only offers a relative wait.
+static int bulb_cond_wait_until(gphoto_driver *gphoto, const struct timespec *deadline)
+{
+#ifdef __APPLE__
+    struct timespec now, rel;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t left = std::max<int64_t>(0, timespec_diff_usec(deadline, &now));
+    rel.tv_sec  = left / 1000000;
+    rel.tv_nsec = (left % 1000000) * 1000;
+    return pthread_cond_timedwait_relative_np(&gphoto->signal, &gphoto->mutex, &rel);
+#else
+    return pthread_cond_timedwait(&gphoto->signal, &gphoto->mutex, deadline);
+#endif
+}
+
 void gphoto_set_debug(const char *name)
 {
     strncpy(device, name, 64);
@@ -584,9 +662,8 @@ static void *stop_bulb(void *arg)
     int timeout_set       = 0;
     gphoto_driver *gphoto = (gphoto_driver *)arg;
     //CameraEventType event;
-    long timeleft;
-    struct timespec timeout;
-    struct timeval curtime, diff;
+    int64_t timeleft;
+    struct timespec timeout, curtime;
 
     pthread_mutex_lock(&gphoto->mutex);
     pthread_cond_signal(&gphoto->signal);
@@ -596,13 +673,12 @@ static void *stop_bulb(void *arg)
         if (!timeout_set)
         {
             // 5 second timeout
-            gettimeofday(&curtime, nullptr);
-            timeout.tv_sec  = curtime.tv_sec + 5;
-            timeout.tv_nsec = curtime.tv_usec * 1000;
+            clock_gettime(CLOCK_MONOTONIC, &timeout);
+            timeout.tv_sec += 5;
         }
         timeout_set = 0;
         // All camera opertions take place with the mutex held, so we are thread-safe
-        pthread_cond_timedwait(&gphoto->signal, &gphoto->mutex, &timeout);
+        bulb_cond_wait_until(gphoto, &timeout);
         //DEBUGFDEVICE(device, INDI::Logger::DBG_DEBUG,"timeout expired");
         if (!(gphoto->command & DSLR_CMD_DONE) && ( (gphoto->command & DSLR_CMD_BULB_CAPTURE)
                 || (gphoto->command & DSLR_CMD_ABORT)))
@@ -610,16 +686,23 @@ static void *stop_bulb(void *arg)
             gphoto->is_aborted = (gphoto->command & DSLR_CMD_ABORT);
             if (gphoto->command & DSLR_CMD_BULB_CAPTURE)
             {
-                gettimeofday(&curtime, nullptr);
-                timersub(&gphoto->bulb_end, &curtime, &diff);
-                timeleft = diff.tv_sec * 1000 + diff.tv_usec / 1000;
-                DEBUGFDEVICE(device, INDI::Logger::DBG_DEBUG, "Time left: %ld ms", timeleft);
+                clock_gettime(CLOCK_MONOTONIC, &curtime);
+                timeleft = timespec_diff_usec(&gphoto->bulb_end, &curtime);
+                DEBUGFDEVICE(device, INDI::Logger::DBG_DEBUG, "Time left: %lld ms", static_cast<long long>(timeleft / 1000));
             }
             else
                 timeleft = 0;
 
-            if (timeleft <= 0)
+            if (timeleft <= BULB_SPIN_USEC)
             {
+                // Spin off the last few milliseconds, then stamp the close right before the first close command
+                // goes out. The open stamp was taken the same way, so command latency cancels out.
+                if (timeleft > 0)
+                    sleep_until_monotonic(&gphoto->bulb_end);
+                clock_gettime(CLOCK_MONOTONIC, &gphoto->bulb_close_mono);
+                if (gphoto->command & DSLR_CMD_BULB_CAPTURE)
+                    gphoto->bulb_timing_valid = true;
+
                 if (gphoto->dsusb)
                 {
                     DEBUGDEVICE(device, INDI::Logger::DBG_DEBUG, "Closing DSUSB shutter.");
@@ -657,11 +740,11 @@ static void *stop_bulb(void *arg)
                 gphoto->command |= DSLR_CMD_DONE;
                 pthread_cond_signal(&gphoto->signal);
             }
-            else if (timeleft < 5000)
+            else if (timeleft < 5000000)
             {
-                timeout_set     = 1;
-                timeout.tv_sec  = gphoto->bulb_end.tv_sec;
-                timeout.tv_nsec = gphoto->bulb_end.tv_usec * 1000;
+                timeout_set = 1;
+                timeout     = gphoto->bulb_end;
+                timespec_add_usec(&timeout, -BULB_SPIN_USEC);
             }
         }
         if (!(gphoto->command & DSLR_CMD_DONE) && (gphoto->command & DSLR_CMD_CAPTURE))
@@ -1021,6 +1104,28 @@ static int download_image(gphoto_driver *gphoto, CameraFilePath *fn, int fd)
     return GP_OK;
 }
 
+bool gphoto_get_bulb_timing(gphoto_driver *gphoto, struct timespec *open_utc, struct timespec *close_utc,
+                            double *measured_secs)
+{
+    pthread_mutex_lock(&gphoto->mutex);
+    bool valid = gphoto->bulb_timing_valid;
+    if (valid)
+    {
+        int64_t measured = timespec_diff_usec(&gphoto->bulb_close_mono, &gphoto->bulb_open_mono);
+        if (open_utc)
+            *open_utc = gphoto->bulb_open_utc;
+        if (close_utc)
+        {
+            *close_utc = gphoto->bulb_open_utc;
+            timespec_add_usec(close_utc, measured);
+        }
+        if (measured_secs)
+            *measured_secs = measured / 1e6;
+    }
+    pthread_mutex_unlock(&gphoto->mutex);
+    return valid;
+}
+
 bool gphoto_supports_temperature(gphoto_driver *gphoto)
 {
     return gphoto->supports_temperature;
@@ -1048,7 +1153,7 @@ int gphoto_mirrorlock(gphoto_driver *gphoto, int msec)
         gphoto_set_widget_num(gphoto, gphoto->bulb_widget, EOS_PRESS_FULL);
         gphoto_set_widget_num(gphoto, gphoto->bulb_widget, EOS_RELEASE_FULL);
 
-        usleep(msec * 1000);
+        sleep_monotonic_usec(msec * 1000LL);
 
         DEBUGDEVICE(device, INDI::Logger::DBG_DEBUG, "End of mirror lock timer");
 
@@ -1072,12 +1177,12 @@ int gphoto_mirrorlock(gphoto_driver *gphoto, int msec)
         //usleep(20000);
         // JM 2019-11-18: Changed to 150ms as per the discussion here
         // https://indilib.org/forum/ccds-dslrs/1564-mirror-lock-on-canon-with-serial-shutter.html
-        usleep(150000);
+        sleep_monotonic_usec(150000);
         ioctl(gphoto->bulb_fd, TIOCMBIC, &RTS_flag);
         close(gphoto->bulb_fd);
         gphoto->bulb_fd = -1;
         //usleep(msec * 1000 - 20000);
-        usleep(msec * 1000);
+        sleep_monotonic_usec(msec * 1000LL);
         return 0;
     }
 
@@ -1101,6 +1206,8 @@ int gphoto_start_exposure(gphoto_driver *gphoto, uint32_t exptime_usec, int mirr
     pthread_mutex_lock(&gphoto->mutex);
     DEBUGDEVICE(device, INDI::Logger::DBG_DEBUG, "Mutex locked");
 
+    gphoto->bulb_timing_valid = false;
+
     // Set ISO Settings
     if (gphoto->iso >= 0)
         gphoto_set_widget_num(gphoto, gphoto->iso_widget, gphoto->iso);
@@ -1251,12 +1358,14 @@ int gphoto_start_exposure(gphoto_driver *gphoto, uint32_t exptime_usec, int mirr
             return -1;
         }
 
+        // Stamp the open once the open command is out, so opening the port does not shorten the exposure.
+        // The bulb deadline is measured from here
+        clock_gettime(CLOCK_MONOTONIC, &gphoto->bulb_open_mono);
+        clock_gettime(CLOCK_REALTIME, &gphoto->bulb_open_utc);
+
         // Preparing exposure
-        struct timeval duration, current_time;
-        gettimeofday(&current_time, nullptr);
-        duration.tv_sec = exptime_usec / 1000000;
-        duration.tv_usec = exptime_usec % 1000000;
-        timeradd(&current_time, &duration, &gphoto->bulb_end);
+        gphoto->bulb_end = gphoto->bulb_open_mono;
+        timespec_add_usec(&gphoto->bulb_end, exptime_usec);
 
         // Start actual exposure
         gphoto->command = DSLR_CMD_BULB_CAPTURE;
@@ -1881,7 +1990,15 @@ gphoto_driver *gphoto_open(Camera *camera, GPContext *context, const char *model
     DEBUGDEVICE(device, INDI::Logger::DBG_DEBUG, "GPhoto initialized.");
 
     pthread_mutex_init(&gphoto->mutex, nullptr);
+#ifdef __APPLE__
     pthread_cond_init(&gphoto->signal, nullptr);
+#else
+    pthread_condattr_t condattr;
+    pthread_condattr_init(&condattr);
+    pthread_condattr_setclock(&condattr, CLOCK_MONOTONIC);
+    pthread_cond_init(&gphoto->signal, &condattr);
+    pthread_condattr_destroy(&condattr);
+#endif
 
     pthread_mutex_lock(&gphoto->mutex);
     pthread_create(&gphoto->thread, nullptr, stop_bulb, gphoto);
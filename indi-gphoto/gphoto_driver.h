@@ -23,6 +23,7 @@
 #pragma once
 
 #include <gphoto2/gphoto2.h>
+#include <time.h>
 
 #define GP_UPLOAD_CLIENT 0
 #define GP_UPLOAD_SDCARD 1
@@ -115,5 +116,8 @@ const char *gphoto_get_model(gphoto_driver *gphoto);
 int gphoto_delete_sdcard_image(gphoto_driver *gphoto, bool delete_sdcard_image);
 bool gphoto_supports_temperature(gphoto_driver *gphoto);
 float gphoto_get_last_sensor_temperature(gphoto_driver *gphoto);
+// Measured shutter open/close (UTC) and duration of the last bulb exposure. False if it was not a bulb exposure.
+bool gphoto_get_bulb_timing(gphoto_driver *gphoto, struct timespec *open_utc, struct timespec *close_utc,
+                            double *measured_secs);
 void gphoto_force_bulb(gphoto_driver *gphoto, bool enabled);
 void gphoto_set_view_finder(gphoto_driver *gphoto, bool enabled);
@@ -0,0 +1,116 @@
+/*
+    indi_limesdr_receiver - a software defined radio driver for INDI
+    Copyright (C) 2017  Ilia Platone
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "channelizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define TAPS_PER_PHASE 16
+
+void Channelizer::setup(double samplerate, double offset, double bandwidth, unsigned int decimation)
+{
+    this->samplerate = samplerate;
+    this->decimation = (decimation > 0 ? decimation : 1);
+
+    mix  = (offset != 0.0);
+    step = std::polar(1.0, -2.0 * M_PI * offset / samplerate);
+
+    taps.clear();
+    if (this->decimation == 1 && (bandwidth <= 0 || bandwidth >= samplerate))
+    {
+        // Full rate data is kept as it is, only shifted if there is an offset
+        taps.push_back(1.0f);
+        this->bandwidth = samplerate;
+    }
+    else
+    {
+        if (bandwidth <= 0)
+            bandwidth = 0.8 * samplerate / this->decimation;
+        this->bandwidth = std::min(bandwidth, samplerate);
+
+        // Blackman windowed sinc, cutoff at half the bandwidth, unity gain at DC
+        unsigned int len = this->decimation * TAPS_PER_PHASE + 1;
+        double fc        = std::min(0.5, bandwidth / 2.0 / samplerate);
+        double sum       = 0;
+        taps.resize(len);
+        for (unsigned int n = 0; n < len; n++)
+        {
+            double m = n - (len - 1) / 2.0;
+            double h = (m == 0 ? 2.0 * fc : sin(2.0 * M_PI * fc * m) / (M_PI * m));
+            double w = 0.42 - 0.5 * cos(2.0 * M_PI * n / (len - 1)) + 0.08 * cos(4.0 * M_PI * n / (len - 1));
+            taps[n]  = static_cast<float>(h * w);
+            sum += taps[n];
+        }
+        for (auto &tap : taps)
+            tap /= static_cast<float>(sum);
+    }
+
+    reset();
+}
+
+void Channelizer::reset()
+{
+    rotator = 1.0;
+    history.assign(taps.size() - 1, 0.0f);
+    next = history.size();
+}
+
+size_t Channelizer::process(const std::complex<float> *in, size_t count, std::complex<float> *out)
+{
+    size_t start = history.size();
+    history.resize(start + count);
+
+    if (mix)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            history[start + i] = in[i] * std::complex<float>(rotator);
+            rotator *= step;
+        }
+        // Keep the oscillator on the unit circle
+        rotator /= std::abs(rotator);
+    }
+    else
+    {
+        std::copy(in, in + count, history.begin() + start);
+    }
+
+    size_t written = 0;
+    size_t len     = taps.size();
+    for (; next < history.size(); next += decimation)
+    {
+        const std::complex<float> *x = history.data() + next + 1 - len;
+        float re = 0, im = 0;
+        for (size_t k = 0; k < len; k++)
+        {
+            re += taps[k] * x[k].real();
+            im += taps[k] * x[k].imag();
+        }
+        out[written++] = std::complex<float>(re, im);
+    }
+
+    // Drop what the next output no longer needs
+    size_t drop = next + 1 - len;
+    drop        = std::min(drop, history.size());
+    history.erase(history.begin(), history.begin() + drop);
+    next -= drop;
+
+    return written;
+}
@@ -0,0 +1,63 @@
+/*
+    indi_limesdr_receiver - a software defined radio driver for INDI
+    Copyright (C) 2017  Ilia Platone
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Streaming channelizer for complex baseband samples.
+ *
+ * Samples are shifted by the centre offset, low pass filtered to the band of
+ * interest and decimated as they arrive. The FIR is evaluated only at the
+ * samples that are kept, so the cost per input sample is the number of taps
+ * divided by the decimation ratio. State is carried between calls, chunks may
+ * have any length.
+ */
+class Channelizer
+{
+public:
+    /// offset and bandwidth in Hz, a bandwidth of 0 keeps 80% of the output rate, or all of it without decimation
+    void setup(double samplerate, double offset, double bandwidth, unsigned int decimation);
+    void reset();
+
+    /// Processes count samples, returns the number of samples written to out (at most count / decimation + 1)
+    size_t process(const std::complex<float> *in, size_t count, std::complex<float> *out);
+
+    /// Number of samples produced out of count input samples
+    size_t getOutputCount(size_t count) const { return count > 0 ? (count - 1) / decimation + 1 : 0; }
+    unsigned int getDecimation() const { return decimation; }
+    unsigned int getTaps() const { return static_cast<unsigned int>(taps.size()); }
+    double getOutputRate() const { return samplerate / decimation; }
+    /// Width of the filter passband in Hz
+    double getBandwidth() const { return bandwidth; }
+
+private:
+    double samplerate { 0 };
+    double bandwidth { 0 };
+    unsigned int decimation { 1 };
+    bool mix { false };
+    std::complex<double> rotator { 1.0 };
+    std::complex<double> step { 1.0 };
+    std::vector<float> taps;
+    std::vector<std::complex<float>> history;
+    size_t next { 0 };
+};
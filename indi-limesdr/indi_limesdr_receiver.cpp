@@ -24,6 +24,7 @@
 #include <indilogger.h>
 #include <memory>
 #include <deque>
+#include <algorithm>
 
 #define min(a, b)               \
     ({                          \
@@ -99,6 +100,8 @@ bool LIMESDR::Connect()
 ***************************************************************************************/
 bool LIMESDR::Disconnect()
 {
+    if (InIntegration)
+        stopCapture();
     InIntegration = false;
     LMS_Close(lime_dev);
     setBufferSize(1);
@@ -133,6 +136,13 @@ bool LIMESDR::initProperties()
     setMinMaxStep("RECEIVER_SETTINGS", "RECEIVER_BANDWIDTH", 400.0e+6, 3.8e+9, 1, false);
     setMinMaxStep("RECEIVER_SETTINGS", "RECEIVER_BITSPERSAMPLE", -32, -32, 0, false);
     setIntegrationFileExtension("fits");
+
+    // Narrow the captured band down to what is of interest, decimation 1 keeps the full rate
+    IUFillNumber(&ChannelizerN[CHANNEL_OFFSET_N], "CHANNEL_OFFSET", "Center Offset (Hz)", "%.0f", -14.0e+6, 14.0e+6, 1, 0);
+    IUFillNumber(&ChannelizerN[CHANNEL_BANDWIDTH_N], "CHANNEL_BANDWIDTH", "Bandwidth (Hz, 0 = auto)", "%.0f", 0, 28.0e+6, 1, 0);
+    IUFillNumber(&ChannelizerN[CHANNEL_DECIMATION_N], "CHANNEL_DECIMATION", "Decimation", "%.0f", 1, 256, 1, 1);
+    IUFillNumberVector(&ChannelizerNP, ChannelizerN, NUM_CHANNEL_SETTINGS, getDeviceName(), "LIMESDR_CHANNELIZER", "Channelizer",
+                       MAIN_CONTROL_TAB, IP_RW, 60, IPS_IDLE);
     /*
     // PrimaryReceiver Device Continuum Blob
     IUFillBLOB(&TFitsB[0], "TRMT", "Transmit1", "");
@@ -163,6 +173,7 @@ bool LIMESDR::updateProperties()
     {
         // Inital values
         setupParams(1000000, 1420000000, 10000, 10);
+        defineProperty(&ChannelizerNP);
         //defineProperty(&TFitsBP);
 
         // Start the timer
@@ -170,12 +181,20 @@ bool LIMESDR::updateProperties()
     }
     else
     {
+        deleteProperty(ChannelizerNP.name);
         //deleteProperty(TFitsBP.name);
     }
 
     return true;
 }
 
+bool LIMESDR::saveConfigItems(FILE *fp)
+{
+    INDI::Receiver::saveConfigItems(fp);
+    IUSaveConfigNumber(fp, &ChannelizerNP);
+    return true;
+}
+
 /**************************************************************************************
 ** Client is asking us to start an exposure
 ***************************************************************************************/
@@ -188,20 +207,42 @@ bool LIMESDR::StartIntegration(double duration)
     b_read  = 0;
     to_read = getSampleRate() * getIntegrationTime();
 
-    setBufferSize(to_read * sizeof(float));
-
     if (to_read > 0)
     {
+        channelizer.setup(getSampleRate(), ChannelizerN[CHANNEL_OFFSET_N].value, ChannelizerN[CHANNEL_BANDWIDTH_N].value,
+                          static_cast<unsigned int>(ChannelizerN[CHANNEL_DECIMATION_N].value));
+        n_read = channelizer.getOutputCount(to_read);
+
+        // The BLOB and FITS metadata describe the channelized data
+        hwSampleRate = getSampleRate();
+        hwFrequency  = getFrequency();
+        hwBandwidth  = getBandwidth();
+        setSampleRate(channelizer.getOutputRate());
+        setFrequency(hwFrequency + ChannelizerN[CHANNEL_OFFSET_N].value);
+        setBandwidth(min(hwBandwidth, channelizer.getBandwidth()));
+
+        // Complex samples, I and Q interleaved
+        setBufferSize(n_read * 2 * sizeof(float));
+
+        // The stream is drained while integrating, the fifo only needs to absorb scheduling delays
         lime_stream.channel             = 0;
         lime_stream.isTx                = false;
-        lime_stream.fifoSize            = to_read;
+        lime_stream.fifoSize            = MAX_FRAME_SIZE;
         lime_stream.dataFmt             = lms_stream_t::LMS_FMT_F32;
         lime_stream.throughputVsLatency = 0.5;
         LMS_SetupStream(lime_dev, &lime_stream);
         LMS_StartStream(&lime_stream);
         gettimeofday(&CapStart, nullptr);
-        InIntegration = true;
-        LOG_INFO("Integration started...");
+        InIntegration  = true;
+        captureFailed  = false;
+        captureDone    = false;
+        captureRunning = true;
+        captureThread  = std::thread(&LIMESDR::captureSamples, this);
+        if (channelizer.getDecimation() > 1)
+            LOGF_INFO("Integration started, %d samples decimated to %d at %.0f Hz (%u taps)...", to_read, n_read,
+                      channelizer.getOutputRate(), channelizer.getTaps());
+        else
+            LOG_INFO("Integration started...");
         return true;
     }
 
@@ -231,7 +272,29 @@ void LIMESDR::setupParams(float sr, float freq, float bw, float gain)
 bool LIMESDR::ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n)
 {
     bool r = false;
+    if (dev && !strcmp(dev, getDeviceName()) && !strcmp(name, ChannelizerNP.name)) {
+        if (InIntegration) {
+            LOG_ERROR("Cannot change the channelizer while integrating.");
+            ChannelizerNP.s = IPS_ALERT;
+            IDSetNumber(&ChannelizerNP, nullptr);
+            return true;
+        }
+        IUUpdateNumber(&ChannelizerNP, values, names, n);
+        double outputRate = getSampleRate() / ChannelizerN[CHANNEL_DECIMATION_N].value;
+        if (ChannelizerN[CHANNEL_BANDWIDTH_N].value > outputRate)
+            LOGF_WARN("Bandwidth is wider than the decimated rate of %.0f Hz and will alias.", outputRate);
+        ChannelizerNP.s = IPS_OK;
+        IDSetNumber(&ChannelizerNP, nullptr);
+        return true;
+    }
     if (dev && !strcmp(dev, getDeviceName()) && !strcmp(name, ReceiverSettingsNP.name)) {
+        // The published settings are the channelized ones until the integration ends
+        if (InIntegration) {
+            LOG_ERROR("Cannot change the receiver settings while integrating.");
+            ReceiverSettingsNP.s = IPS_ALERT;
+            IDSetNumber(&ReceiverSettingsNP, nullptr);
+            return true;
+        }
         for(int i = 0; i < n; i++) {
             if (!strcmp(names[i], "RECEIVER_GAIN")) {
                 setupParams(getSampleRate(), getFrequency(), getBandwidth(), values[i]);
@@ -255,14 +318,9 @@ bool LIMESDR::AbortIntegration()
 {
     if (InIntegration)
     {
-        lms_stream_status_t status;
-        LMS_GetStreamStatus(&lime_stream, &status);
-        if (status.fifoFilledCount <= 0)
-        {
-            InIntegration = false;
-            LMS_StopStream(&lime_stream);
-            LMS_DestroyStream(lime_dev, &lime_stream);
-        }
+        stopCapture();
+        restoreSettings();
+        InIntegration = false;
     }
     return true;
 }
@@ -298,20 +356,14 @@ void LIMESDR::TimerHit()
     if (InIntegration)
     {
         timeleft = CalcTimeLeft();
-        if (timeleft < 0.1)
+        if (captureDone)
         {
             /* We're done capturing */
-            LOG_INFO("Integration done, expecting data...");
-            lms_stream_status_t status;
-            LMS_GetStreamStatus(&lime_stream, &status);
-            if (status.active)
-            {
-                if (status.fifoFilledCount >= status.fifoSize)
-                {
-                    n_read = status.fifoFilledCount;
-                    grabData();
-                }
-            }
+            grabData();
+            timeleft = 0.0;
+        }
+        else if (timeleft < 0.1)
+        {
             timeleft = 0.0;
         }
 
@@ -323,6 +375,52 @@ void LIMESDR::TimerHit()
     return;
 }
 
+/**************************************************************************************
+** Receive and channelize samples as they arrive
+***************************************************************************************/
+void LIMESDR::captureSamples()
+{
+    std::vector<std::complex<float>> samples(SUBFRAME_SIZE);
+    std::vector<std::complex<float>> decimated(SUBFRAME_SIZE / channelizer.getDecimation() + 1);
+    std::complex<float> *out = reinterpret_cast<std::complex<float> *>(getBuffer());
+    int received = 0;
+
+    while (captureRunning && received < to_read)
+    {
+        int count = LMS_RecvStream(&lime_stream, samples.data(), min(SUBFRAME_SIZE, to_read - received), nullptr, 1000);
+        if (count < 0)
+        {
+            LOG_ERROR("Failed to receive samples.");
+            captureFailed = true;
+            break;
+        }
+        received += count;
+
+        int written = channelizer.process(samples.data(), count, decimated.data());
+        written     = min(written, n_read - b_read);
+        std::copy(decimated.begin(), decimated.begin() + written, out + b_read);
+        b_read += written;
+    }
+
+    captureDone = true;
+}
+
+void LIMESDR::stopCapture()
+{
+    captureRunning = false;
+    if (captureThread.joinable())
+        captureThread.join();
+    LMS_StopStream(&lime_stream);
+    LMS_DestroyStream(lime_dev, &lime_stream);
+}
+
+void LIMESDR::restoreSettings()
+{
+    setSampleRate(hwSampleRate);
+    setFrequency(hwFrequency);
+    setBandwidth(hwBandwidth);
+}
+
 /**************************************************************************************
 ** Create the spectrum
 ***************************************************************************************/
@@ -330,14 +428,18 @@ void LIMESDR::grabData()
 {
     if (InIntegration)
     {
-        continuum = getBuffer();
-        LOG_INFO("Downloading...");
-        LMS_RecvStream(&lime_stream, continuum, n_read, NULL, 1000);
-        LMS_StopStream(&lime_stream);
-        LMS_DestroyStream(lime_dev, &lime_stream);
+        stopCapture();
         InIntegration = false;
 
+        if (captureFailed)
+        {
+            restoreSettings();
+            setIntegrationFailed();
+            return;
+        }
+
         LOG_INFO("Download complete.");
         IntegrationComplete();
+        restoreSettings();
     }
 }
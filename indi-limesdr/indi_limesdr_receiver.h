@@ -21,6 +21,10 @@
 
 #include <lime/LimeSuite.h>
 #include "indireceiver.h"
+#include "channelizer.h"
+
+#include <atomic>
+#include <thread>
 
 enum Settings
 {
@@ -29,6 +33,14 @@ enum Settings
 	BANDWIDTH_N,
 	NUM_SETTINGS
 };
+
+enum ChannelizerSettings
+{
+	CHANNEL_OFFSET_N=0,
+	CHANNEL_BANDWIDTH_N,
+	CHANNEL_DECIMATION_N,
+	NUM_CHANNEL_SETTINGS
+};
 class LIMESDR : public INDI::Receiver
 {
   public:
@@ -43,6 +55,7 @@ class LIMESDR : public INDI::Receiver
 	const char *getDefaultName() override;
 	bool initProperties() override;
 	bool updateProperties() override;
+	bool saveConfigItems(FILE *fp) override;
 
     // Receiver specific functions
     bool StartIntegration(double duration) override;
@@ -51,6 +64,9 @@ class LIMESDR : public INDI::Receiver
     void TimerHit() override;
 
     void grabData();
+    void captureSamples();
+    void stopCapture();
+    void restoreSettings();
 
   private:
     lms_device_t *lime_dev = { nullptr };
@@ -71,6 +87,21 @@ class LIMESDR : public INDI::Receiver
 
     uint32_t receiverIndex = { 0 };
 
+    // Samples are channelized as they arrive by the capture thread
+    Channelizer channelizer;
+    std::thread captureThread;
+    std::atomic<bool> captureRunning { false };
+    std::atomic<bool> captureDone { false };
+    bool captureFailed { false };
+
+    // Hardware settings, the channelized ones are published while integrating
+    double hwSampleRate { 0 };
+    double hwFrequency { 0 };
+    double hwBandwidth { 0 };
+
+    INumber ChannelizerN[NUM_CHANNEL_SETTINGS];
+    INumberVectorProperty ChannelizerNP;
+
     IBLOB TFitsB[5];
     IBLOBVectorProperty TFitsBP;
 };
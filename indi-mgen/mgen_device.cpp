@@ -35,6 +35,7 @@
 #include <pthread.h>
 #include <libftdi1/ftdi.h>
 #include <libusb-1.0/libusb.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "indilogger.h"
@@ -261,6 +262,11 @@ int MGenDevice::setOpMode(IOMode const _mode)
         {
             _E("failed setting latency timer (%d: %s)", res, ftdi_get_error_string(ftdi));
         }
+        /* Answers are at most a display block, keep USB transfers small so they complete with the latency timer */
+        else if ((res = ftdi_read_data_set_chunksize(ftdi, read_chunk_size)) < 0)
+        {
+            _E("failed setting read chunk size (%d: %s)", res, ftdi_get_error_string(ftdi));
+        }
         else
         {
             _D("successfully switched device to baudrate %d.", baudrate);
@@ -285,8 +291,7 @@ int MGenDevice::write(IOBuffer const &query) //throw(IOError)
        query.size() > 4 ? query[4] : 0);
     int const bytes_written = ftdi_write_data(ftdi, query.data(), query.size());
 
-    /* FIXME: Adjust this to optimize how long device absorb the command for */
-    usleep(20000);
+    /* No settling delay here, read() waits for the answer itself */
 
     if (bytes_written < 0)
         throw IOError(bytes_written);
@@ -302,10 +307,33 @@ int MGenDevice::read(IOBuffer &answer) //throw(IOError)
     if (answer.size() > 0)
     {
         _D("reading %d bytes from device", answer.size());
-        int const bytes_read = ftdi_read_data(ftdi, answer.data(), answer.size());
 
-        if (bytes_read < 0)
-            throw IOError(bytes_read);
+        /* Keep reading until the expected answer length arrived or the deadline expired. The FTDI chip flushes
+         * whatever it holds every latency period, so each call returns within a few milliseconds and the command
+         * completes as soon as the device has answered, instead of after a fixed delay. */
+        struct timespec start, now;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        int bytes_read = 0;
+        while (true)
+        {
+            int const res = ftdi_read_data(ftdi, answer.data() + bytes_read, answer.size() - bytes_read);
+
+            if (res < 0)
+                throw IOError(res);
+
+            bytes_read += res;
+            if (bytes_read >= (int) answer.size())
+                break;
+
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            long const elapsed_ms = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+            if (elapsed_ms >= answer_timeout_ms)
+            {
+                _D("answer timed out after %ld ms with %d/%d bytes", elapsed_ms, bytes_read, answer.size());
+                break;
+            }
+        }
 
         _D("read %d bytes from device: %02X %02X %02X %02X %02X ...", bytes_read, answer.size() > 0 ? answer[0] : 0,
            answer.size() > 1 ? answer[1] : 0, answer.size() > 2 ? answer[2] : 0, answer.size() > 3 ? answer[3] : 0,
@@ -44,6 +44,11 @@ class MGenDevice
     IOMode mode;
     unsigned short vid, pid;
 
+    /** \internal How long read() waits for a complete answer */
+    static int const answer_timeout_ms = 100;
+    /** \internal FTDI read chunk, a multiple of the 64-byte USB packet large enough for a display block answer */
+    static int const read_chunk_size = 256;
+
   public:
     bool lock();
     void unlock();
@@ -86,6 +91,9 @@ class MGenDevice
     int write(IOBuffer const &); //throw(IOError);
 
     /** \brief Reading the answer part of a command from the device.
+     *
+     * This function reads until the answer buffer is full, or until answer_timeout_ms elapsed.
+     *
      * \return the number of bytes read, or -1 if the command is invalid or device is not accessible.
      * \throw IOError when device communication is malfunctioning.
      */
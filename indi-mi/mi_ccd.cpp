@@ -26,7 +26,10 @@
 #include "config.h"
 
 #include <math.h>
+#include <unistd.h>
+#include <algorithm>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -34,6 +37,7 @@
 #define TEMP_COOLER_OFF 100  /* High enough temperature for the camera cooler to turn off (°C) */
 #define MAX_DEVICES     4    /* Max device cameraCount */
 #define MAX_ERROR_LEN   64   /* Max length of error buffer */
+#define READY_POLL_MS   50   /* Interval between image ready checks once the exposure time elapsed (ms) */
 
 // There is _one_ binary for USB and ETH driver, but each binary is renamed
 // to its variant (indi_mi_ccd_usb and indi_mi_ccd_eth). The main function will
@@ -133,6 +137,7 @@ MICCD::MICCD(int camId, bool eth) : FilterInterface(this)
 
 MICCD::~MICCD()
 {
+    downloadWorker.quit();
     gxccd_release(cameraHandle);
 }
 
@@ -199,6 +204,11 @@ bool MICCD::initProperties()
     IUFillNumberVector(&PreflashNP, PreflashN, 2, getDeviceName(), "NIR_PRE_FLASH", "NIR Preflash",
                        MAIN_CONTROL_TAB, IP_RW, 60, IPS_IDLE);
 
+    // Simulated download delay, used to check driver responsiveness while an image is read out
+    IUFillNumber(&SimDownloadDelayN[0], "SIM_DOWNLOAD_DELAY", "Delay (ms)", "%5.0f", 0, 60000, 100, 0);
+    IUFillNumberVector(&SimDownloadDelayNP, SimDownloadDelayN, 1, getDeviceName(), "SIM_DOWNLOAD", "Sim. Download",
+                       OPTIONS_TAB, IP_RW, 60, IPS_IDLE);
+
     addAuxControls();
 
     setDriverInterface(getDriverInterface() | FILTER_INTERFACE);
@@ -234,6 +244,9 @@ void MICCD::ISGetProperties(const char *dev)
         if (canDoPreflash)
             defineProperty(&PreflashNP);
 
+        if (isSimulation())
+            defineProperty(&SimDownloadDelayNP);
+
         if (numFilters > 0)
         {
             INDI::FilterInterface::updateProperties();
@@ -270,6 +283,9 @@ bool MICCD::updateProperties()
         if (canDoPreflash)
             defineProperty(&PreflashNP);
 
+        if (isSimulation())
+            defineProperty(&SimDownloadDelayNP);
+
         if (numFilters > 0)
         {
             INDI::FilterInterface::updateProperties();
@@ -305,6 +321,9 @@ bool MICCD::updateProperties()
         if (canDoPreflash)
             deleteProperty(PreflashNP.name);
 
+        if (isSimulation())
+            deleteProperty(SimDownloadDelayNP.name);
+
         if (numFilters > 0)
         {
             INDI::FilterInterface::updateProperties();
@@ -393,6 +412,7 @@ bool MICCD::Connect()
 
 bool MICCD::Disconnect()
 {
+    downloadWorker.quit();
     LOGF_INFO("Disconnected from %s.", name);
     gxccd_release(cameraHandle);
     cameraHandle = nullptr;
@@ -480,6 +500,10 @@ int MICCD::SetTemperature(double temperature)
 
 bool MICCD::StartExposure(float duration)
 {
+    // A readout left running by an abort keeps the camera busy, wait for it here rather than in the abort
+    downloadWorker.quit();
+    downloadAborted = false;
+
     imageFrameType = PrimaryCCD.getFrameType();
     useShutter = (imageFrameType == INDI::CCDChip::LIGHT_FRAME || imageFrameType == INDI::CCDChip::FLAT_FRAME);
 
@@ -499,16 +523,25 @@ bool MICCD::StartExposure(float duration)
     ExposureRequest = duration;
     PrimaryCCD.setExposureDuration(duration);
 
-    gettimeofday(&ExpStart, nullptr);
-    InExposure  = true;
-    downloading = false;
+    {
+        std::lock_guard<std::mutex> lock(exposureLock);
+        gettimeofday(&ExpStart, nullptr);
+    }
+    InExposure   = true;
+    downloadDone = false;
     LOGF_DEBUG("Taking a %.3f seconds frame...", ExposureRequest);
+
+    downloadWorker.start(std::bind(&MICCD::workerDownload, this, std::placeholders::_1));
     return true;
 }
 
 bool MICCD::AbortExposure()
 {
-    if (InExposure && !isSimulation())
+    // Joining the worker here could block the event loop for a whole readout
+    std::lock_guard<std::mutex> lock(exposureLock);
+    downloadAborted = true;
+
+    if (InExposure && !downloadReading && !isSimulation())
     {
         if (gxccd_abort_exposure(cameraHandle, false) < 0)
         {
@@ -519,8 +552,8 @@ bool MICCD::AbortExposure()
         }
     }
 
-    InExposure  = false;
-    downloading = false;
+    InExposure   = false;
+    downloadDone = false;
     LOG_INFO("Exposure aborted.");
     return true;
 }
@@ -578,10 +611,14 @@ bool MICCD::UpdateCCDBin(int hor, int ver)
 float MICCD::calcTimeLeft()
 {
     double timesince;
-    struct timeval now;
+    struct timeval now, start;
     gettimeofday(&now, nullptr);
+    {
+        std::lock_guard<std::mutex> lock(exposureLock);
+        start = ExpStart;
+    }
 
-    timesince = (now.tv_sec * 1000.0 + now.tv_usec / 1000.0) - (ExpStart.tv_sec * 1000.0 + ExpStart.tv_usec / 1000.0);
+    timesince = (now.tv_sec * 1000.0 + now.tv_usec / 1000.0) - (start.tv_sec * 1000.0 + start.tv_usec / 1000.0);
     return ExposureRequest - timesince / 1000.0;
 }
 
@@ -605,7 +642,7 @@ static void mirror_image(void *buf, size_t w, size_t d)
     }
 }
 
-/* Downloads the image from the CCD. */
+/* Downloads the image from the CCD. Runs on the download worker thread. */
 int MICCD::grabImage()
 {
     std::unique_lock<std::mutex> guard(ccdBufferLock);
@@ -642,40 +679,92 @@ int MICCD::grabImage()
     if (ExposureRequest > 5 && !ret)
         LOG_INFO("Download complete.");
 
-    downloading = false;
-    ExposureComplete(&PrimaryCCD);
-
     return ret;
 }
 
+void MICCD::workerDownload(const std::atomic_bool &isAboutToQuit)
+{
+    // Do not query the camera before the exposure time elapses, see gxccd_image_ready()
+    for (float timeleft = calcTimeLeft(); timeleft > 0 && !isAboutToQuit && !downloadAborted; timeleft = calcTimeLeft())
+        usleep(std::min(timeleft * 1000.0f, 100.0f) * 1000);
+
+    if (isSimulation())
+    {
+        for (int delay = SimDownloadDelayN[0].value; delay > 0 && !isAboutToQuit && !downloadAborted;
+                delay -= READY_POLL_MS)
+            usleep(std::min(delay, READY_POLL_MS) * 1000);
+    }
+    else
+    {
+        bool ready = false;
+        while (!ready && !isAboutToQuit)
+        {
+            std::unique_lock<std::mutex> lock(exposureLock);
+            if (downloadAborted)
+                return;
+            int rc = gxccd_image_ready(cameraHandle, &ready);
+            lock.unlock();
+
+            if (rc < 0)
+            {
+                char errorStr[MAX_ERROR_LEN];
+                gxccd_get_last_error(cameraHandle, errorStr, sizeof(errorStr));
+                LOGF_ERROR("Getting image ready failed: %s.", errorStr);
+                downloadResult = -1;
+                downloadDone   = true;
+                return;
+            }
+            if (!ready)
+                usleep(READY_POLL_MS * 1000);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(exposureLock);
+        if (isAboutToQuit || downloadAborted)
+            return;
+        downloadReading = true;
+    }
+
+    // Don't spam the session log unless it is a long exposure > 5 seconds
+    if (ExposureRequest > 5)
+        LOG_INFO("Exposure done, downloading image...");
+
+    // The chip is free once the image is read out, TimerHit completes the exposure on the main loop
+    int result = grabImage();
+
+    std::lock_guard<std::mutex> lock(exposureLock);
+    downloadReading = false;
+    if (downloadAborted)
+        return;
+    downloadResult = result;
+    downloadDone   = true;
+}
+
 void MICCD::TimerHit()
 {
     if (!isConnected())
         return; // No need to reset timer if we are not connected anymore
 
+    uint32_t nextTimer = getCurrentPollingPeriod();
+
     if (InExposure)
     {
         float timeleft = calcTimeLeft();
-        bool ready     = false;
 
-        if (!downloading && (gxccd_image_ready(cameraHandle, &ready) < 0))
-        {
-            char errorStr[MAX_ERROR_LEN];
-            gxccd_get_last_error(cameraHandle, errorStr, sizeof(errorStr));
-            LOGF_ERROR("Getting image ready failed: %s.", errorStr);
-        }
-        if (ready)
+        if (downloadDone.exchange(false))
         {
-            PrimaryCCD.setExposureLeft(0);
-            InExposure  = false;
-            downloading = true;
+            InExposure = false;
 
-            // Don't spam the session log unless it is a long exposure > 5 seconds
-            if (ExposureRequest > 5)
-                LOG_INFO("Exposure done, downloading image...");
-
-            // grab and save image
-            grabImage();
+            if (downloadResult < 0)
+            {
+                PrimaryCCD.setExposureFailed();
+            }
+            else
+            {
+                PrimaryCCD.setExposureLeft(0);
+                ExposureComplete(&PrimaryCCD);
+            }
         }
         // camera may need some time for image download -> update client only for positive values
         else if (timeleft >= 0)
@@ -683,9 +772,13 @@ void MICCD::TimerHit()
             LOGF_DEBUG("Exposure in progress: Time left %.2fs", timeleft);
             PrimaryCCD.setExposureLeft(timeleft);
         }
+
+        // Pick up the downloaded image promptly so the next exposure can be started
+        if (InExposure && timeleft * 1000 < nextTimer)
+            nextTimer = READY_POLL_MS;
     }
 
-    SetTimer(getCurrentPollingPeriod());
+    SetTimer(nextTimer);
 }
 
 int MICCD::QueryFilter()
@@ -924,6 +1017,14 @@ bool MICCD::ISNewNumber(const char *dev, const char *name, double values[], char
             IDSetNumber(&GainNP, nullptr);
             return true;
         }
+
+        if (!strcmp(name, SimDownloadDelayNP.name))
+        {
+            IUUpdateNumber(&SimDownloadDelayNP, values, names, n);
+            SimDownloadDelayNP.s = IPS_OK;
+            IDSetNumber(&SimDownloadDelayNP, nullptr);
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewNumber(dev, name, values, names, n);
@@ -1017,5 +1118,8 @@ bool MICCD::saveConfigItems(FILE *fp)
     if (maxGainValue > 0)
         IUSaveConfigNumber(fp, &GainNP);
 
+    if (isSimulation())
+        IUSaveConfigNumber(fp, &SimDownloadDelayNP);
+
     return true;
 }
@@ -25,6 +25,9 @@
 
 #include <indiccd.h>
 #include <indifilterinterface.h>
+#include <indisinglethreadpool.h>
+
+#include <atomic>
 
 class MICCD : public INDI::CCD, public INDI::FilterInterface
 {
@@ -91,6 +94,10 @@ class MICCD : public INDI::CCD, public INDI::FilterInterface
     INumber PreflashN[2];
     INumberVectorProperty PreflashNP;
 
+    // Simulated image download delay
+    INumber SimDownloadDelayN[1];
+    INumberVectorProperty SimDownloadDelayNP;
+
   private:
     char name[MAXINDIDEVICE];
 
@@ -113,7 +120,16 @@ class MICCD : public INDI::CCD, public INDI::FilterInterface
     int temperatureID;
     int timerID;
 
-    bool downloading;
+    // Waits for the image to become ready and downloads it off the main loop
+    INDI::SingleThreadPool downloadWorker;
+    // Set by the worker once the frame buffer holds the image, consumed by TimerHit
+    std::atomic_bool downloadDone { false };
+    std::atomic_int downloadResult { 0 };
+    // Abort only flags the worker. The lock hands the camera over between abort and the worker,
+    // once the readout has started the image is dropped instead of aborting the exposure
+    std::mutex exposureLock;
+    std::atomic_bool downloadAborted { false };
+    bool downloadReading { false };
 
     bool canDoPreflash;
 
@@ -121,12 +137,13 @@ class MICCD : public INDI::CCD, public INDI::FilterInterface
 
     float TemperatureRequest;
     float ExposureRequest;
-    struct timeval ExpStart;
+    struct timeval ExpStart; // guarded by exposureLock, the worker reads it
 
     bool setupParams();
 
     float calcTimeLeft();
     int grabImage();
+    void workerDownload(const std::atomic_bool &isAboutToQuit);
 
     void updateTemperature();
     static void updateTemperatureHelper(void *);
@@ -0,0 +1,182 @@
+/*
+    Exposure phase timing for INDI CCD drivers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "exposure_timing.h"
+
+#include <algorithm>
+#include <wordexp.h>
+
+#define TIMING_WINDOW 20 /* Frames in the statistics */
+
+ExposureTiming::~ExposureTiming()
+{
+    closeTrace();
+}
+
+void ExposureTiming::setEnabled(bool enabled)
+{
+    std::unique_lock<std::mutex> guard(lock);
+
+    if (enabled && !this->enabled)
+    {
+        active = false;
+        window.clear();
+        mean.fill(0);
+        max.fill(0);
+        frames = 0;
+    }
+    this->enabled = enabled;
+}
+
+void ExposureTiming::setMergedDownload(bool merged)
+{
+    std::unique_lock<std::mutex> guard(lock);
+    this->merged = merged;
+}
+
+bool ExposureTiming::openTrace(const std::string &path)
+{
+    std::unique_lock<std::mutex> guard(lock);
+
+    if (trace != nullptr)
+        fclose(trace);
+    trace = nullptr;
+
+    wordexp_t wexp;
+    if (wordexp(path.c_str(), &wexp, 0))
+        return false;
+    if (wexp.we_wordc == 1)
+        trace = fopen(wexp.we_wordv[0], "a");
+    wordfree(&wexp);
+    if (trace == nullptr)
+        return false;
+
+    if (ftell(trace) == 0)
+    {
+        if (merged)
+            fprintf(trace, "time,duration_s,arm_ms,exposure_download_ms,process_ms,complete_ms,total_ms\n");
+        else
+            fprintf(trace, "time,duration_s,arm_ms,exposure_ms,download_ms,process_ms,complete_ms,total_ms\n");
+    }
+    fflush(trace);
+    return true;
+}
+
+void ExposureTiming::closeTrace()
+{
+    std::unique_lock<std::mutex> guard(lock);
+
+    if (trace != nullptr)
+        fclose(trace);
+    trace = nullptr;
+}
+
+void ExposureTiming::start(double duration)
+{
+    if (!enabled)
+        return;
+
+    std::unique_lock<std::mutex> guard(lock);
+    active         = true;
+    next           = PHASE_ARM;
+    this->duration = duration;
+    stamps[0]      = Clock::now();
+}
+
+bool ExposureTiming::mark(Phase phase)
+{
+    if (!enabled)
+        return false;
+
+    std::unique_lock<std::mutex> guard(lock);
+
+    // Retries go through the same phases again, only the first mark counts
+    if (!active || phase < next)
+        return false;
+
+    for (; next < phase; next++)
+        stamps[next + 1] = stamps[next];
+    stamps[phase + 1] = Clock::now();
+    next = phase + 1;
+
+    if (phase != PHASE_COMPLETE)
+        return false;
+
+    finish();
+    return true;
+}
+
+/* Caller must hold the lock */
+void ExposureTiming::finish()
+{
+    std::array<double, PHASE_N> elapsed;
+    for (int i = 0; i < PHASE_N; i++)
+        elapsed[i] = std::chrono::duration<double, std::milli>(stamps[i + 1] - stamps[i]).count();
+    elapsed[merged ? PHASE_DOWNLOAD : PHASE_EXPOSURE] -= duration * 1000.0;
+
+    active = false;
+    frames++;
+
+    window.push_back(elapsed);
+    if (window.size() > TIMING_WINDOW)
+        window.pop_front();
+
+    mean.fill(0);
+    max = window.front();
+    for (const auto &frame : window)
+    {
+        for (int i = 0; i < PHASE_N; i++)
+        {
+            mean[i] += frame[i] / window.size();
+            max[i] = std::max(max[i], frame[i]);
+        }
+    }
+
+    if (trace != nullptr)
+    {
+        double now   = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+        double total = std::chrono::duration<double, std::milli>(stamps[PHASE_N] - stamps[0]).count();
+        if (merged)
+            fprintf(trace, "%.3f,%g,%.3f,%.3f,%.3f,%.3f,%.3f\n", now, duration,
+                    elapsed[PHASE_ARM], elapsed[PHASE_DOWNLOAD],
+                    elapsed[PHASE_PROCESS], elapsed[PHASE_COMPLETE], total);
+        else
+            fprintf(trace, "%.3f,%g,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", now, duration,
+                    elapsed[PHASE_ARM], elapsed[PHASE_EXPOSURE], elapsed[PHASE_DOWNLOAD],
+                    elapsed[PHASE_PROCESS], elapsed[PHASE_COMPLETE], total);
+        fflush(trace);
+    }
+}
+
+unsigned int ExposureTiming::getFrames() const
+{
+    std::unique_lock<std::mutex> guard(lock);
+    return frames;
+}
+
+double ExposureTiming::getMean(Phase phase) const
+{
+    std::unique_lock<std::mutex> guard(lock);
+    return mean[phase];
+}
+
+double ExposureTiming::getMax(Phase phase) const
+{
+    std::unique_lock<std::mutex> guard(lock);
+    return max[phase];
+}
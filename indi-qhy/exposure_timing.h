@@ -0,0 +1,99 @@
+/*
+    Exposure phase timing for INDI CCD drivers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+
+/**
+ * Wall clock time spent in each phase of an exposure.
+ *
+ * start() is called when the exposure is requested and mark() at the end of
+ * each phase, from whichever thread runs it. Phases a frame does not go
+ * through are recorded with zero length. Marking the complete phase closes the
+ * frame: the statistics over the last frames are updated and a line is
+ * appended to the CSV trace, if one is open.
+ *
+ * Drivers with no signal for the end of the exposure itself set merged
+ * download: PHASE_EXPOSURE is not marked and PHASE_DOWNLOAD holds the overrun
+ * too, the exposure duration is taken off it instead.
+ *
+ * While disabled nothing is stamped and each call costs one atomic load.
+ */
+class ExposureTiming
+{
+public:
+    enum Phase
+    {
+        PHASE_ARM,      // exposure requested until the camera is armed
+        PHASE_EXPOSURE, // armed until the sensor is done, less the exposure duration
+        PHASE_DOWNLOAD, // readout from the SDK
+        PHASE_PROCESS,  // post-processing of the frame buffer
+        PHASE_COMPLETE, // ExposureComplete, FITS encoding and BLOB send
+        PHASE_N
+    };
+
+    ~ExposureTiming();
+
+    /// Statistics restart when timing is enabled
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+
+    /// Set before opening the trace, the CSV then has one exposure_download_ms column
+    void setMergedDownload(bool merged);
+
+    /// Appends per-frame timing to the file, ~ is expanded. The CSV header is written if it is empty
+    bool openTrace(const std::string &path);
+    void closeTrace();
+
+    void start(double duration);
+    /// Returns true when the frame is complete and the statistics were updated
+    bool mark(Phase phase);
+
+    /// Statistics over the last frames, in ms
+    unsigned int getFrames() const;
+    double getMean(Phase phase) const;
+    double getMax(Phase phase) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void finish();
+
+    std::atomic_bool enabled {false};
+    mutable std::mutex lock;
+    bool merged {false};
+
+    bool active {false};
+    int next {0};
+    double duration {0};
+    std::array<Clock::time_point, PHASE_N + 1> stamps;
+
+    std::deque<std::array<double, PHASE_N>> window;
+    std::array<double, PHASE_N> mean {};
+    std::array<double, PHASE_N> max {};
+    unsigned int frames {0};
+
+    FILE *trace {nullptr};
+};
@@ -30,6 +30,8 @@
 #include <math.h>
 #include <memory>
 #include <deque>
+#include <cerrno>
+#include <cstring>
 
 #define TEMP_THRESHOLD       0.05   /* Differential temperature threshold (C)*/
 
@@ -319,6 +321,35 @@ bool QHYCCD::initProperties()
     IUFillText(&GPSDataNowT[GPS_DATA_NOW_TS], "GPS_DATA_NOW_TS", "TS", "NA");
     IUFillTextVector(&GPSDataNowTP, GPSDataNowT, 4, getDeviceName(), "GPS_DATA_NOW", "Now", GPS_DATA_TAB, IP_RO, 60, IPS_IDLE);
 
+    /////////////////////////////////////////////////////////////////////////////
+    /// Properties: Exposure Phase Timing
+    /////////////////////////////////////////////////////////////////////////////
+    IUFillSwitch(&TimingS[TIMING_STATS], "TIMING_STATS", "Statistics", ISS_OFF);
+    IUFillSwitch(&TimingS[TIMING_TRACE], "TIMING_TRACE", "CSV Trace", ISS_OFF);
+    IUFillSwitchVector(&TimingSP, TimingS, 2, getDeviceName(), "EXPOSURE_TIMING", "Phase Timing", OPTIONS_TAB, IP_RW,
+                       ISR_NOFMANY, 0, IPS_IDLE);
+
+    std::string tracePath = std::string("~/.indi/") + getDeviceName() + "_timing.csv";
+    std::replace(tracePath.begin(), tracePath.end(), ' ', '_');
+    IUFillText(&TimingTraceT[0], "TRACE_FILE", "File", tracePath.c_str());
+    IUFillTextVector(&TimingTraceTP, TimingTraceT, 1, getDeviceName(), "EXPOSURE_TIMING_TRACE", "Timing Trace", OPTIONS_TAB,
+                     IP_RW, 60, IPS_IDLE);
+
+    IUFillNumber(&TimingStatsN[TIMING_FRAMES], "FRAMES", "Frames", "%.f", 0, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TIMING_ARM_MEAN], "ARM_MEAN", "Arm (ms)", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TIMING_ARM_MAX], "ARM_MAX", "Arm max (ms)", "%.1f", 0, 1e9, 0, 0);
+    // The SDK has no end of exposure signal, the driver only counts the duration down, so the
+    // overrun is timed together with the download: GetQHYCCDSingleFrame blocks through both
+    m_Timing.setMergedDownload(true);
+    IUFillNumber(&TimingStatsN[TIMING_DOWNLOAD_MEAN], "DOWNLOAD_MEAN", "Overrun + download (ms)", "%.1f", -1e9, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TIMING_DOWNLOAD_MAX], "DOWNLOAD_MAX", "Overrun + download max (ms)", "%.1f", -1e9, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TIMING_PROCESS_MEAN], "PROCESS_MEAN", "Process (ms)", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TIMING_PROCESS_MAX], "PROCESS_MAX", "Process max (ms)", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TIMING_COMPLETE_MEAN], "COMPLETE_MEAN", "Complete (ms)", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TIMING_COMPLETE_MAX], "COMPLETE_MAX", "Complete max (ms)", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumberVector(&TimingStatsNP, TimingStatsN, 9, getDeviceName(), "EXPOSURE_TIMING_STATS", "Phase Stats", OPTIONS_TAB,
+                       IP_RO, 60, IPS_IDLE);
+
     addAuxControls();
     setDriverInterface(getDriverInterface() | FILTER_INTERFACE);
 
@@ -398,6 +429,10 @@ void QHYCCD::ISGetProperties(const char *dev)
         //NEW CODE - Add support for overscan/calibration area
         if(HasOverscanArea)
             defineProperty(&OverscanAreaSP);
+
+        defineProperty(&TimingSP);
+        defineProperty(&TimingTraceTP);
+        defineProperty(&TimingStatsNP);
     }
 }
 
@@ -611,6 +646,10 @@ bool QHYCCD::updateProperties()
         if (HasOverscanArea)
             defineProperty(&OverscanAreaSP);
 
+        defineProperty(&TimingSP);
+        defineProperty(&TimingTraceTP);
+        defineProperty(&TimingStatsNP);
+
         // Let's get parameters now from CCD
         setupParams();
     }
@@ -686,6 +725,10 @@ bool QHYCCD::updateProperties()
         //NEW CODE - Add support for overscan/calibration area
         if (HasOverscanArea)
             deleteProperty(OverscanAreaSP.name);
+
+        deleteProperty(TimingSP.name);
+        deleteProperty(TimingTraceTP.name);
+        deleteProperty(TimingStatsNP.name);
     }
 
     return true;
@@ -1232,6 +1275,8 @@ bool QHYCCD::StartExposure(float duration)
         return false;
     }
 
+    m_Timing.start(duration);
+
     // Set streaming mode and re-initialize camera
     if (currentQHYStreamMode == 1 && !isSimulation())
     {
@@ -1331,6 +1376,7 @@ bool QHYCCD::StartExposure(float duration)
         return false;
     }
 
+    m_Timing.mark(ExposureTiming::PHASE_ARM);
     gettimeofday(&ExpStart, nullptr);
     LOGF_DEBUG("Taking a %.5f seconds frame...", m_ExposureRequest);
 
@@ -1500,6 +1546,8 @@ int QHYCCD::grabImage()
     }
     guard.unlock();
 
+    m_Timing.mark(ExposureTiming::PHASE_DOWNLOAD);
+
     // Perform software binning if necessary
     //if (useSoftBin)
     //    PrimaryCCD.binFrame();
@@ -1512,8 +1560,13 @@ int QHYCCD::grabImage()
     if (HasGPS && GPSControlS[INDI_ENABLED].s == ISS_ON)
         decodeGPSHeader();
 
+    m_Timing.mark(ExposureTiming::PHASE_PROCESS);
+
     ExposureComplete(&PrimaryCCD);
 
+    if (m_Timing.mark(ExposureTiming::PHASE_COMPLETE))
+        updateTimingStats();
+
     return 0;
 }
 
@@ -1771,6 +1824,16 @@ bool QHYCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, cha
             return true;
         }
 
+        //////////////////////////////////////////////////////////////////////
+        /// Exposure Phase Timing
+        //////////////////////////////////////////////////////////////////////
+        else if (!strcmp(TimingSP.name, name))
+        {
+            IUUpdateSwitch(&TimingSP, states, names, n);
+            setupTiming();
+            return true;
+        }
+
         //////////////////////////////////////////////////////////////////////
         /// Amp Glow
         //////////////////////////////////////////////////////////////////////
@@ -1862,11 +1925,61 @@ bool QHYCCD::ISNewText(const char *dev, const char *name, char *texts[], char *n
             INDI::FilterInterface::processText(dev, name, texts, names, n);
             return true;
         }
+
+        if (strcmp(name, TimingTraceTP.name) == 0)
+        {
+            IUUpdateText(&TimingTraceTP, texts, names, n);
+            TimingTraceTP.s = IPS_OK;
+            IDSetText(&TimingTraceTP, nullptr);
+
+            // Reopen the trace under its new name
+            if (TimingS[TIMING_TRACE].s == ISS_ON)
+                setupTiming();
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewText(dev, name, texts, names, n);
 }
 
+bool QHYCCD::setupTiming()
+{
+    bool trace = (TimingS[TIMING_TRACE].s == ISS_ON);
+    bool ok    = true;
+
+    m_Timing.closeTrace();
+    if (trace && !m_Timing.openTrace(TimingTraceT[0].text))
+    {
+        LOGF_ERROR("Failed to open timing trace %s (%s).", TimingTraceT[0].text, strerror(errno));
+        TimingS[TIMING_TRACE].s = ISS_OFF;
+        trace = false;
+        ok    = false;
+    }
+
+    bool enabled = trace || TimingS[TIMING_STATS].s == ISS_ON;
+    m_Timing.setEnabled(enabled);
+
+    TimingSP.s = ok ? (enabled ? IPS_OK : IPS_IDLE) : IPS_ALERT;
+    IDSetSwitch(&TimingSP, nullptr);
+    return ok;
+}
+
+void QHYCCD::updateTimingStats()
+{
+    const ExposureTiming::Phase phases[] = { ExposureTiming::PHASE_ARM, ExposureTiming::PHASE_DOWNLOAD,
+                                             ExposureTiming::PHASE_PROCESS, ExposureTiming::PHASE_COMPLETE
+                                           };
+
+    TimingStatsN[TIMING_FRAMES].value = m_Timing.getFrames();
+    for (int i = 0; i < 4; i++)
+    {
+        TimingStatsN[TIMING_ARM_MEAN + 2 * i].value = m_Timing.getMean(phases[i]);
+        TimingStatsN[TIMING_ARM_MAX + 2 * i].value  = m_Timing.getMax(phases[i]);
+    }
+    TimingStatsNP.s = IPS_OK;
+    IDSetNumber(&TimingStatsNP, nullptr);
+}
+
 bool QHYCCD::ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n)
 {
     //  first check if it's for our device
@@ -2307,6 +2420,9 @@ bool QHYCCD::saveConfigItems(FILE *fp)
 
     IUSaveConfigNumber(fp, &USBBufferNP);
 
+    IUSaveConfigText(fp, &TimingTraceTP);
+    IUSaveConfigSwitch(fp, &TimingSP);
+
     return true;
 }
 
@@ -24,6 +24,7 @@
 #include <qhyccd.h>
 #include <indiccd.h>
 #include <indifilterinterface.h>
+#include "exposure_timing.h"
 #include <unistd.h>
 #include <functional>
 #include <pthread.h>
@@ -276,6 +277,36 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
             GPS_DATA_NOW_TS,
         };
 
+        /////////////////////////////////////////////////////////////////////////////
+        /// Properties: Exposure Phase Timing
+        /////////////////////////////////////////////////////////////////////////////
+        ISwitchVectorProperty TimingSP;
+        ISwitch TimingS[2];
+        enum
+        {
+            TIMING_STATS,
+            TIMING_TRACE,
+        };
+
+        ITextVectorProperty TimingTraceTP;
+        IText TimingTraceT[1] {};
+
+        INumberVectorProperty TimingStatsNP;
+        // No exposure elements, the overrun is timed with the download
+        INumber TimingStatsN[9];
+        enum
+        {
+            TIMING_FRAMES,
+            TIMING_ARM_MEAN,
+            TIMING_ARM_MAX,
+            TIMING_DOWNLOAD_MEAN,
+            TIMING_DOWNLOAD_MAX,
+            TIMING_PROCESS_MEAN,
+            TIMING_PROCESS_MAX,
+            TIMING_COMPLETE_MEAN,
+            TIMING_COMPLETE_MAX,
+        };
+
 
     private:
         /////////////////////////////////////////////////////////////////////////////
@@ -403,6 +434,10 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         bool updateFilterProperties();
         // Decode GPS Header
         void decodeGPSHeader();
+        // Enable exposure phase timing and the CSV trace as selected
+        bool setupTiming();
+        // Publish the exposure phase statistics
+        void updateTimingStats();
         /**
          * @brief JStoJD Convert Julian Second to Julian Date
          * @param JS Julian Second
@@ -466,6 +501,8 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         uint32_t currentQHYReadMode;
         // dynamic array to hold read mode information
         QHYReadModeInfo *readModeInfo = nullptr;
+        // Exposure phase timing
+        ExposureTiming m_Timing;
 
 
         /////////////////////////////////////////////////////////////////////////////
@@ -51,6 +51,8 @@ public:
     virtual int getSubH() { return chip->getSubH(); }
     virtual int getXRes() { return chip->getXRes(); }
     virtual int getYRes() { return chip->getYRes(); }
+    virtual int getBinX() { return chip->getBinX(); }
+    virtual int getBinY() { return chip->getBinY(); }
 
 private:
     INDI::CCDChip *chip {nullptr};
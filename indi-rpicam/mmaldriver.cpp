@@ -290,12 +290,17 @@ bool MMALDriver::updateProperties()
     return true;
 }
 
-// FIXME: implement UpdateCCDBin
+/**
+ * Binning is done by the raw pipeline while decoding, see RawToBayer16Pipeline.
+ */
 bool MMALDriver::UpdateCCDBin(int hor, int ver)
 {
     LOGF_DEBUG("%s(%d, %d)", __FUNCTION__, hor, ver);
 
-    return true;
+    PrimaryCCD.setBin(hor, ver);
+
+    // Subframe alignment depends on the bin factor.
+    return UpdateCCDFrame(PrimaryCCD.getSubX(), PrimaryCCD.getSubY(), PrimaryCCD.getSubW(), PrimaryCCD.getSubH());
 }
 
 /**
@@ -311,6 +316,15 @@ bool MMALDriver::UpdateCCDFrame(int x, int y, int w, int h)
 {
     LOGF_DEBUG("%s(%d, %d, %d, %d)", __FUNCTION__, x, y, w, h);
 
+    // Keep the subframe on bayer cell boundaries and a whole number of binned cells wide and high,
+    // so the image is still a bayer image of exactly (w / binX) x (h / binY) pixels.
+    int align_x = 2 * PrimaryCCD.getBinX();
+    int align_y = 2 * PrimaryCCD.getBinY();
+    x &= ~1;
+    y &= ~1;
+    w = std::max(w - w % align_x, align_x);
+    h = std::max(h - h % align_y, align_y);
+
     PrimaryCCD.setFrame(x, y, w, h);
 
     // Total bytes required for image buffer
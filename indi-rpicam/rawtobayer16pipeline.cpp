@@ -0,0 +1,185 @@
+/*
+ Raspberry Pi High Quality Camera CCD Driver for Indi.
+ Copyright (C) 2020 Lars Berntzon (lars.berntzon@cecilia-data.se).
+ All rights reserved.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+
+#include "rawtobayer16pipeline.h"
+#include "broadcompipeline.h"
+#include "chipwrapper.h"
+
+/**
+ * The raw data is the full sensor readout, raw_width bytes per line, with pixels packed
+ * in groups (2 pixels in 3 bytes for RAW12, 4 pixels in 5 bytes for RAW10).
+ *
+ * A subframe starts on the group holding getSubX(), the pixels before it in that group are
+ * dropped after unpacking. Lines above and below the subframe and bytes to the left and
+ * right of it are never looked at.
+ *
+ * Binning keeps the bayer pattern: a binned pixel of one color is the mean of the binX * binY
+ * pixels of that color in a (2 * binX) x (2 * binY) block, i.e. pixels two apart in the raw image.
+ */
+
+void RawToBayer16Pipeline::reset()
+{
+    // The frame geometry is read when the first data arrives, the broadcom header is not known yet.
+    configured = false;
+    bytes_consumed = 0;
+}
+
+void RawToBayer16Pipeline::setup()
+{
+    raw_width = bcm_pipe->header.omx_data.raw_width;
+    check_geometry(raw_width);
+
+    const uint32_t ppg = pixels_per_group();
+    const uint32_t bpg = bytes_per_group();
+    const uint32_t sub_x = static_cast<uint32_t>(ccd->getSubX());
+    const uint32_t sub_h = static_cast<uint32_t>(ccd->getSubH());
+
+    sub_w = static_cast<uint32_t>(ccd->getSubW());
+    bin_x = static_cast<uint32_t>(std::max(ccd->getBinX(), 1));
+    bin_y = static_cast<uint32_t>(std::max(ccd->getBinY(), 1));
+    out_w = sub_w / bin_x;
+    out_h = sub_h / bin_y;
+
+    skip_pixels = sub_x % ppg;
+    first_byte = (sub_x / ppg) * bpg;
+    uint32_t groups = (skip_pixels + sub_w + ppg - 1) / ppg;
+    end_byte = std::min(first_byte + groups * bpg, raw_width - raw_width % bpg);
+
+    first_row = static_cast<uint32_t>(ccd->getSubY());
+    end_row = first_row + sub_h;
+
+    frame_buffer = reinterpret_cast<uint16_t *>(ccd->getFrameBuffer());
+    line.resize(end_byte - first_byte);
+    pixels.assign(groups * ppg, 0);
+    bin_sum.assign(2 * out_w, 0);
+    configured = true;
+}
+
+void RawToBayer16Pipeline::data_received(uint8_t *data,  uint32_t length)
+{
+    if (!configured)
+    {
+        setup();
+    }
+
+    const uint32_t frame_end = end_row * raw_width;
+
+    while (length > 0)
+    {
+        // Beyond the subframe, nothing more of interest in this frame.
+        if (bytes_consumed >= frame_end)
+        {
+            bytes_consumed += length;
+            return;
+        }
+
+        uint32_t row = bytes_consumed / raw_width;
+        uint32_t col = bytes_consumed % raw_width;
+        uint32_t n;
+
+        if (row < first_row)
+        {
+            n = std::min(length, first_row * raw_width + first_byte - bytes_consumed);
+        }
+        else if (col < first_byte)
+        {
+            n = std::min(length, first_byte - col);
+        }
+        else if (col >= end_byte)
+        {
+            n = std::min(length, raw_width - col);
+        }
+        else
+        {
+            n = std::min(length, end_byte - col);
+            if (col == first_byte && n == line.size())
+            {
+                // Whole line is in this buffer, decode in place.
+                line_received(data, row);
+            }
+            else
+            {
+                memcpy(line.data() + (col - first_byte), data, n);
+                if (col + n == end_byte)
+                {
+                    line_received(line.data(), row);
+                }
+            }
+        }
+
+        data += n;
+        length -= n;
+        bytes_consumed += n;
+    }
+}
+
+void RawToBayer16Pipeline::line_received(const uint8_t *raw, uint32_t row)
+{
+    unpack(raw, pixels.data(), static_cast<uint32_t>(line.size()) / bytes_per_group());
+
+    const uint16_t *src = pixels.data() + skip_pixels;
+    const uint32_t sub_row = row - first_row;
+
+    if (bin_x == 1 && bin_y == 1)
+    {
+        memcpy(frame_buffer + sub_row * out_w, src, out_w * sizeof(uint16_t));
+        return;
+    }
+
+    uint32_t *sum = bin_sum.data() + (sub_row & 1) * out_w;
+    for (uint32_t ox = 0; ox < out_w; ox++)
+    {
+        uint32_t sx = (ox >> 1) * 2 * bin_x + (ox & 1);
+        for (uint32_t i = 0; i < bin_x && sx < sub_w; i++, sx += 2)
+        {
+            sum[ox] += src[sx];
+        }
+    }
+
+    if (sub_row % (2 * bin_y) == 2 * bin_y - 1 || row + 1 == end_row)
+    {
+        flush_bin_rows(sub_row);
+    }
+}
+
+void RawToBayer16Pipeline::flush_bin_rows(uint32_t sub_row)
+{
+    const uint32_t first_out_row = (sub_row / (2 * bin_y)) * 2;
+    const uint32_t count = bin_x * bin_y;
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        const uint32_t oy = first_out_row + i;
+        const uint32_t *sum = bin_sum.data() + i * out_w;
+        if (oy < out_h)
+        {
+            uint16_t *out = frame_buffer + oy * out_w;
+            for (uint32_t ox = 0; ox < out_w; ox++)
+            {
+                out[ox] = static_cast<uint16_t>(sum[ox] / count);
+            }
+        }
+    }
+
+    std::fill(bin_sum.begin(), bin_sum.end(), 0);
+}
@@ -0,0 +1,83 @@
+/*
+ Raspberry Pi High Quality Camera CCD Driver for Indi.
+ Copyright (C) 2020 Lars Berntzon (lars.berntzon@cecilia-data.se).
+ All rights reserved.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef RAWTOBAYER16PIPELINE_H
+#define RAWTOBAYER16PIPELINE_H
+
+#include <cstddef>
+#include <vector>
+#include "pipeline.h"
+
+struct BroadcomPipeline;
+class ChipWrapper;
+
+/**
+ * @brief The RawToBayer16Pipeline class
+ * Common part of the packed raw to 16 bits bayer decoders.
+ * Only the part of each raw line covering the subframe is unpacked, all other bytes of the
+ * stream are skipped. When binning, the same colored pixels of each binX * binY block are
+ * averaged in the same pass, so the result is still a bayer image, binX/binY times smaller.
+ */
+class RawToBayer16Pipeline : public Pipeline
+{
+public:
+    RawToBayer16Pipeline(const BroadcomPipeline *bcm_pipe, ChipWrapper *ccd) : Pipeline(), bcm_pipe(bcm_pipe), ccd(ccd) {}
+
+    virtual void data_received(uint8_t *data,  uint32_t length) override;
+    virtual void reset() override;
+
+protected:
+    //! Number of pixels in one packed group.
+    virtual uint32_t pixels_per_group() const = 0;
+    //! Number of bytes in one packed group.
+    virtual uint32_t bytes_per_group() const = 0;
+    //! Unpack a number of groups into 16 bits pixels with the most significant bit at bit 15.
+    virtual void unpack(const uint8_t *raw, uint16_t *pixels, uint32_t groups) = 0;
+    //! Called once per frame, before the first line is decoded.
+    virtual void check_geometry(uint32_t raw_width) { (void)raw_width; }
+
+    const BroadcomPipeline *bcm_pipe;
+    ChipWrapper *ccd;
+
+private:
+    void setup();
+    void line_received(const uint8_t *raw, uint32_t row);
+    void flush_bin_rows(uint32_t sub_row);
+
+    bool configured {false};
+    uint32_t raw_width {0};
+    uint32_t bytes_consumed {0};
+    uint32_t first_row {0};     //! First raw line of the subframe.
+    uint32_t end_row {0};       //! One past the last raw line of the subframe.
+    uint32_t first_byte {0};    //! Offset in the raw line of the group holding the first subframe pixel.
+    uint32_t end_byte {0};      //! One past the last byte in the raw line needed for the subframe.
+    uint32_t skip_pixels {0};   //! Unpacked pixels before the first subframe pixel.
+    uint32_t sub_w {0};
+    uint32_t bin_x {1};
+    uint32_t bin_y {1};
+    uint32_t out_w {0};
+    uint32_t out_h {0};
+    uint16_t *frame_buffer {nullptr};
+    std::vector<uint8_t> line;      //! Subframe part of a raw line that was split over several buffers.
+    std::vector<uint16_t> pixels;   //! Unpacked subframe part of the current line.
+    std::vector<uint32_t> bin_sum;  //! Sums for the two output rows (one per bayer row) being binned.
+};
+
+#endif // RAWTOBAYER16PIPELINE_H
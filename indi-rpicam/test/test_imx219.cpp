@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
 #include <unistd.h>
 
 #include <mmaldriver.h>
@@ -23,12 +26,14 @@ class MockCCD : public ChipWrapper
 {
 public:
 
-    MockCCD(int x=0, int y=0, int w=3280, int h=2464)
+    MockCCD(int x=0, int y=0, int w=3280, int h=2464, int bin=1)
     {
         subx = x;
         suby = y;
         subw = w;
         subh = h;
+        binx = bin;
+        biny = bin;
         width = 3280;
         height = 2464;
         bpp = 16;
@@ -47,14 +52,17 @@ public:
     }
 
     virtual int getSubX() override { return subx; }
-    virtual int getSubY() override { return subx; }
+    virtual int getSubY() override { return suby; }
     virtual int getSubW() override { return subw; }
     virtual int getSubH() override { return subh; }
     virtual int getXRes() override { return width; }
     virtual int getYRes() override { return height; }
+    virtual int getBinX() override { return binx; }
+    virtual int getBinY() override { return biny; }
 
 private:
     int subx, suby, subw, subh;
+    int binx, biny;
     int width;
     int height;
     int bpp;
@@ -63,6 +71,72 @@ private:
 };
 // }}}
 
+// {{{ Synthetic RAW10 frames, for testing the decoder without a camera.
+static const uint32_t RAW_WIDTH = 4128;
+
+static uint16_t test_pixel(int x, int y)
+{
+    return static_cast<uint16_t>((x * 7 + y * 13) & 0x3FF);
+}
+
+// Broadcom header followed by a full sensor readout of test_pixel() values.
+static std::vector<uint8_t> make_raw_frame(int width, int height)
+{
+    BroadcomHeader header {};
+    std::vector<uint8_t> frame(32768 + RAW_WIDTH * height, 0);
+
+    memcpy(header.BRCM, "BRCMo", 5);
+    header.omx_data.raw_width = RAW_WIDTH;
+    memcpy(frame.data(), header.BRCM, 8);
+    memcpy(frame.data() + 8, &header.omx_data, sizeof header.omx_data);
+
+    for (int y = 0; y < height; y++) {
+        uint8_t *raw = frame.data() + 32768 + RAW_WIDTH * y;
+        for (int x = 0; x < width; x += 4, raw += 5) {
+            raw[4] = 0;
+            for (int i = 0; i < 4; i++) {
+                uint16_t v = test_pixel(x + i, y);
+                raw[i] = static_cast<uint8_t>(v >> 2);
+                raw[4] |= static_cast<uint8_t>((v & 0x03) << (2 * i));
+            }
+        }
+    }
+    return frame;
+}
+
+static uint16_t expected_pixel(int x, int y)
+{
+    return static_cast<uint16_t>(test_pixel(x, y) << 6);
+}
+// }}}
+
+// Feed a synthetic frame through the broadcom and raw pipelines in odd sized chunks.
+static void decode_raw_frame(MockCCD *ccd, const std::vector<uint8_t> &frame)
+{
+    BroadcomPipeline brcm_pipe;
+    brcm_pipe.daisyChain(new Raw10ToBayer16Pipeline(&brcm_pipe, ccd));
+    brcm_pipe.reset_pipe();
+
+    std::vector<uint8_t> data(frame);
+    const uint32_t chunk = 4099;
+    for (uint32_t pos = 0; pos < data.size(); pos += chunk) {
+        brcm_pipe.data_received(data.data() + pos, std::min<uint32_t>(chunk, data.size() - pos));
+    }
+}
+
+// Mean of the same colored pixels of a bin x bin bayer superpixel, as the pipeline does.
+static uint16_t expected_binned_pixel(int subx, int suby, int ox, int oy, int bin)
+{
+    uint32_t sum = 0;
+    for (int j = 0; j < bin; j++) {
+        for (int i = 0; i < bin; i++) {
+            sum += expected_pixel(subx + (ox / 2) * 2 * bin + (ox & 1) + 2 * i,
+                                  suby + (oy / 2) * 2 * bin + (oy & 1) + 2 * j);
+        }
+    }
+    return static_cast<uint16_t>(sum / (bin * bin));
+}
+
 // {{{ TestCameraControl
 class TestCameraControl : public CameraControl, CaptureListener
 {
@@ -234,6 +308,52 @@ TEST(TestCameraControl, subframe)
     EXPECT_EQ(statbuf.st_size, w * h * 2);
 }
 
+TEST(Raw10ToBayer16Pipeline, full_frame)
+{
+    MockCCD ccd;
+    decode_raw_frame(&ccd, make_raw_frame(ccd.getXRes(), ccd.getYRes()));
+
+    const uint16_t *image = reinterpret_cast<const uint16_t *>(ccd.getFrameBuffer());
+    for (int y = 0; y < ccd.getYRes(); y += 97) {
+        for (int x = 0; x < ccd.getXRes(); x++) {
+            ASSERT_EQ(image[y * ccd.getXRes() + x], expected_pixel(x, y)) << "x=" << x << " y=" << y;
+        }
+    }
+}
+
+TEST(Raw10ToBayer16Pipeline, subframe_not_on_group_boundary)
+{
+    // Start in the middle of a packed group and on an odd line.
+    const int subx = 103, suby = 51, w = 64, h = 40;
+    MockCCD ccd(subx, suby, w, h);
+    decode_raw_frame(&ccd, make_raw_frame(ccd.getXRes(), ccd.getYRes()));
+
+    const uint16_t *image = reinterpret_cast<const uint16_t *>(ccd.getFrameBuffer());
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            ASSERT_EQ(image[y * w + x], expected_pixel(subx + x, suby + y)) << "x=" << x << " y=" << y;
+        }
+    }
+}
+
+TEST(Raw10ToBayer16Pipeline, binned_subframe)
+{
+    const int subx = 200, suby = 100, w = 96, h = 48;
+    for (int bin = 2; bin <= 4; bin++) {
+        MockCCD ccd(subx, suby, w, h, bin);
+        decode_raw_frame(&ccd, make_raw_frame(ccd.getXRes(), ccd.getYRes()));
+
+        const uint16_t *image = reinterpret_cast<const uint16_t *>(ccd.getFrameBuffer());
+        const int out_w = w / bin, out_h = h / bin;
+        for (int oy = 0; oy < out_h; oy++) {
+            for (int ox = 0; ox < out_w; ox++) {
+                ASSERT_EQ(image[oy * out_w + ox], expected_binned_pixel(subx, suby, ox, oy, bin))
+                    << "bin=" << bin << " x=" << ox << " y=" << oy;
+            }
+        }
+    }
+}
+
 #ifdef USE_ISO
 TEST(TestCameraControl, double_iso)
 {
@@ -24,6 +24,7 @@
 
 #include <memory>
 #include <deque>
+#include <errno.h>
 #include <time.h>
 #include <math.h>
 #include <unistd.h>
@@ -42,6 +43,10 @@
 static pthread_cond_t cv         = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t condMutex = PTHREAD_MUTEX_INITIALIZER;
 
+// frame wait : SDK timeout per call, and how late a frame may be before giving up
+#define FRAME_WAIT_SLICE_MS 200
+#define FRAME_TIMEOUT_S     10
+
 static class Loader
 {
     std::deque<std::unique_ptr<Sv305CCD>> cameras;
@@ -95,6 +100,14 @@ Sv305CCD::Sv305CCD(int numCamera)
     // mutex init
     pthread_mutex_init(&cameraID_mutex, NULL);
     pthread_mutex_init(&streaming_mutex, NULL);
+    pthread_mutex_init(&capture_mutex, NULL);
+    pthread_cond_init(&capture_cv, NULL);
+
+    captureRequested = false;
+    captureBusy = false;
+    captureGeneration = 0;
+    terminateCapture = false;
+    pretriggered = false;
 }
 
 
@@ -104,6 +117,8 @@ Sv305CCD::~Sv305CCD()
     // mutex destroy
     pthread_mutex_destroy(&cameraID_mutex);
     pthread_mutex_destroy(&streaming_mutex);
+    pthread_mutex_destroy(&capture_mutex);
+    pthread_cond_destroy(&capture_cv);
 }
 
 
@@ -170,6 +185,9 @@ bool Sv305CCD::updateProperties()
         // stretch factor
         defineProperty(&StretchSP);
 
+        // soft trigger pipelining
+        defineProperty(&PipelineSP);
+
         timerID = SetTimer(getCurrentPollingPeriod());
     }
     else
@@ -193,6 +211,9 @@ bool Sv305CCD::updateProperties()
 
         // stretch factor
         deleteProperty(StretchSP.name);
+
+        // soft trigger pipelining
+        deleteProperty(PipelineSP.name);
     }
 
     return true;
@@ -417,6 +438,12 @@ bool Sv305CCD::Connect()
     IUFillSwitchVector(&StretchSP, StretchS, 5, getDeviceName(), "STRETCH_BITS", "12 bits 16 bits stretch", MAIN_CONTROL_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
     bitStretch=0;
 
+    // soft trigger pipelining, off by default : the next frame starts before the client asks for it
+    IUFillSwitch(&PipelineS[PIPELINE_ON], "PIPELINE_ON", "On", ISS_OFF);
+    IUFillSwitch(&PipelineS[PIPELINE_OFF], "PIPELINE_OFF", "Off", ISS_ON);
+    IUFillSwitchVector(&PipelineSP, PipelineS, 2, getDeviceName(), "SOFT_TRIGGER_PIPELINE", "Pipeline exposures", MAIN_CONTROL_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+    pretriggered = false;
+
     // set camera ROI and BIN
     binning = false;
     SetCCDParams(cameraProperty.MaxWidth, cameraProperty.MaxHeight, bitDepth, pixelSize, pixelSize);
@@ -457,6 +484,13 @@ bool Sv305CCD::Connect()
     terminateThread = false;
     pthread_create(&primary_thread, nullptr, &streamVideoHelper, this);
 
+    // create capture thread
+    captureRequested = false;
+    captureBusy = false;
+    captureGeneration = 0;
+    terminateCapture = false;
+    pthread_create(&capture_thread, nullptr, &captureFramesHelper, this);
+
     /* Success! */
     LOG_INFO("CCD is online. Retrieving basic data.\n");
     return true;
@@ -473,7 +507,17 @@ bool Sv305CCD::Disconnect()
     pthread_cond_signal(&cv);
     pthread_mutex_unlock(&condMutex);
 
-    //pthread_mutex_lock(&cameraID_mutex);
+    // destroy capture
+    pthread_mutex_lock(&capture_mutex);
+    terminateCapture = true;
+    captureGeneration++;
+    pretriggered = false;
+    pthread_cond_broadcast(&capture_cv);
+    pthread_mutex_unlock(&capture_mutex);
+    pthread_join(capture_thread, nullptr);
+    InExposure = false;
+
+    pthread_mutex_lock(&cameraID_mutex);
 
     // stop camera
     status = SVBStopVideoCapture(cameraID);
@@ -526,37 +570,229 @@ bool Sv305CCD::StartExposure(float duration)
         duration = maxExposure;
     }
 
-    pthread_mutex_lock(&cameraID_mutex);
-
-    // set exposure time (s -> us)
-    status = SVBSetControlValue(cameraID, SVB_EXPOSURE , (double)(duration * 1000000), SVB_FALSE);
-    if(status != SVB_SUCCESS)
+    // the capture thread may still be giving up an aborted frame, it must not take the new one
+    pthread_mutex_lock(&capture_mutex);
+    captureGeneration++;
+    pthread_cond_broadcast(&capture_cv);
+    while (captureBusy && !terminateCapture)
+        pthread_cond_wait(&capture_cv, &capture_mutex);
+    pthread_mutex_unlock(&capture_mutex);
+
+    // a frame with the same duration may already be exposing
+    pthread_mutex_lock(&capture_mutex);
+    bool pipelined = pretriggered && (pretriggerDuration == duration);
+    struct timeval start = pretriggerStart;
+    pthread_mutex_unlock(&capture_mutex);
+
+    if(!pipelined)
     {
-        LOG_ERROR("Error, camera set exposure failed\n");
+        discardPretrigger();
+
+        pthread_mutex_lock(&cameraID_mutex);
+
+        // set exposure time (s -> us)
+        status = SVBSetControlValue(cameraID, SVB_EXPOSURE , (double)(duration * 1000000), SVB_FALSE);
+        if(status != SVB_SUCCESS)
+        {
+            LOG_ERROR("Error, camera set exposure failed\n");
+            pthread_mutex_unlock(&cameraID_mutex);
+            return false;
+        }
+
+        // soft trigger
+        status = SVBSendSoftTrigger(cameraID);
+        if(status != SVB_SUCCESS)
+        {
+            LOG_ERROR("Error, soft trigger failed\n");
+            pthread_mutex_unlock(&cameraID_mutex);
+            return false;
+        }
+
         pthread_mutex_unlock(&cameraID_mutex);
-        return false;
+
+        gettimeofday(&start, nullptr);
     }
 
-    // soft trigger
+    PrimaryCCD.setExposureDuration(duration);
+
+    // hand the frame over to the capture thread
+    pthread_mutex_lock(&capture_mutex);
+    pretriggered = false;
+    ExposureRequest = duration;
+    ExpStart = start;
+    InExposure = true;
+    captureRequested = true;
+    pthread_cond_broadcast(&capture_cv);
+    pthread_mutex_unlock(&capture_mutex);
+
+    LOGF_DEBUG("Taking a %g seconds frame%s...\n", ExposureRequest, pipelined ? " (pipelined)" : "");
+
+    return true;
+}
+
+
+// trigger the next frame with the current exposure, while the last one is processed
+void Sv305CCD::pretrigger(float duration)
+{
+    pthread_mutex_lock(&cameraID_mutex);
     status = SVBSendSoftTrigger(cameraID);
+    pthread_mutex_unlock(&cameraID_mutex);
     if(status != SVB_SUCCESS)
     {
-        LOG_ERROR("Error, soft trigger failed\n");
-        pthread_mutex_unlock(&cameraID_mutex);
-        return false;
+        LOG_DEBUG("Pipelined soft trigger failed\n");
+        return;
     }
 
+    pthread_mutex_lock(&capture_mutex);
+    pretriggered = true;
+    pretriggerDuration = duration;
+    gettimeofday(&pretriggerStart, nullptr);
+    pthread_mutex_unlock(&capture_mutex);
+}
+
+
+// drop a pipelined frame nobody asked for, restarting capture flushes it
+void Sv305CCD::discardPretrigger()
+{
+    pthread_mutex_lock(&capture_mutex);
+    bool discard = pretriggered;
+    pretriggered = false;
+    pthread_mutex_unlock(&capture_mutex);
+
+    if(!discard)
+        return;
+
+    LOG_DEBUG("Discarding pipelined frame\n");
+
+    pthread_mutex_lock(&cameraID_mutex);
+    status = SVBStopVideoCapture(cameraID);
+    if(status == SVB_SUCCESS)
+        status = SVBStartVideoCapture(cameraID);
+    if(status != SVB_SUCCESS)
+        LOG_ERROR("Error, restart camera failed\n");
     pthread_mutex_unlock(&cameraID_mutex);
+}
 
-    PrimaryCCD.setExposureDuration(duration);
-    ExposureRequest = duration;
 
-    gettimeofday(&ExpStart, nullptr);
-    LOGF_DEBUG("Taking a %g seconds frame...\n", ExposureRequest);
+//
+void* Sv305CCD::captureFramesHelper(void * context)
+{
+    return static_cast<Sv305CCD *>(context)->captureFrames();
+}
+
 
-    InExposure = true;
+// true once the frame of this generation was aborted or superseded
+bool Sv305CCD::captureCancelled(unsigned int generation)
+{
+    pthread_mutex_lock(&capture_mutex);
+    bool cancelled = (generation != captureGeneration) || terminateCapture;
+    pthread_mutex_unlock(&capture_mutex);
+    return cancelled;
+}
 
-    return true;
+
+// wait for the frame in short SDK timeouts, so guiding and abort are never held off for long
+bool Sv305CCD::waitFrame(unsigned char *imageBuffer, const struct timeval &deadline, unsigned int generation)
+{
+    while(!captureCancelled(generation))
+    {
+        pthread_mutex_lock(&cameraID_mutex);
+        status = SVBGetVideoData(cameraID, imageBuffer, PrimaryCCD.getFrameBufferSize(), FRAME_WAIT_SLICE_MS);
+        pthread_mutex_unlock(&cameraID_mutex);
+
+        if(status == SVB_SUCCESS)
+            return true;
+
+        struct timeval now;
+        gettimeofday(&now, nullptr);
+        if(timercmp(&now, &deadline, >))
+            return false;
+    }
+
+    return false;
+}
+
+
+//
+void* Sv305CCD::captureFrames()
+{
+    while (true)
+    {
+        pthread_mutex_lock(&capture_mutex);
+
+        captureBusy = false;
+        pthread_cond_broadcast(&capture_cv);
+
+        while (!captureRequested && !terminateCapture)
+            pthread_cond_wait(&capture_cv, &capture_mutex);
+
+        if (terminateCapture)
+        {
+            pthread_mutex_unlock(&capture_mutex);
+            break;
+        }
+
+        captureRequested = false;
+        captureBusy = true;
+        float duration = ExposureRequest;
+        unsigned int generation = captureGeneration;
+
+        // sleep until the end of the exposure, unless aborted
+        struct timeval end, timeout;
+        struct timeval length = { static_cast<time_t>(duration), static_cast<suseconds_t>((duration - floor(duration)) * 1e6) };
+        timeradd(&ExpStart, &length, &end);
+        struct timespec endts = { end.tv_sec, end.tv_usec * 1000 };
+        while (generation == captureGeneration && !terminateCapture)
+        {
+            if (pthread_cond_timedwait(&capture_cv, &capture_mutex, &endts) == ETIMEDOUT)
+                break;
+        }
+        bool abort = (generation != captureGeneration) || terminateCapture;
+
+        pthread_mutex_unlock(&capture_mutex);
+
+        if (abort)
+            continue;
+
+        unsigned char* imageBuffer = PrimaryCCD.getFrameBuffer();
+        struct timeval late = { FRAME_TIMEOUT_S, 0 };
+        timeradd(&end, &late, &timeout);
+        if (!waitFrame(imageBuffer, timeout, generation))
+        {
+            if (!captureCancelled(generation))
+            {
+                LOG_ERROR("Error, frame not received\n");
+                InExposure = false;
+                PrimaryCCD.setExposureFailed();
+            }
+            continue;
+        }
+
+        // sensor is free, start the next frame while this one is processed
+        if (PipelineS[PIPELINE_ON].s == ISS_ON && !Streamer->isBusy())
+            pretrigger(duration);
+
+        // stretching 12bits depth to 16bits depth
+        if(bitDepth==16 && (bitStretch != 0))
+        {
+            u_int16_t* tmp=(u_int16_t*)imageBuffer;
+            for(int i=0; i<PrimaryCCD.getFrameBufferSize()/2; i++)
+            {
+                tmp[i]<<=bitStretch;
+            }
+        }
+
+        // binning if needed
+        if(binning)
+            PrimaryCCD.binFrame();
+
+        // exposure done
+        PrimaryCCD.setExposureLeft(0);
+        InExposure = false;
+        ExposureComplete(&PrimaryCCD);
+    }
+
+    return nullptr;
 }
 
 
@@ -568,6 +804,13 @@ bool Sv305CCD::AbortExposure()
 
     InExposure = false;
 
+    // stop waiting for the frame, a pipelined one is flushed below
+    pthread_mutex_lock(&capture_mutex);
+    captureGeneration++;
+    pretriggered = false;
+    pthread_cond_broadcast(&capture_cv);
+    pthread_mutex_unlock(&capture_mutex);
+
     pthread_mutex_lock(&cameraID_mutex);
 
     // *********
@@ -612,6 +855,8 @@ bool Sv305CCD::StartStreaming()
     // streaming exposure time
     ExposureRequest = 1.0 / Streamer->getTargetFPS();
 
+    discardPretrigger();
+
     pthread_mutex_lock(&cameraID_mutex);
 
     // set exposure time (s -> us)
@@ -756,6 +1001,8 @@ bool Sv305CCD::UpdateCCDFrame(int x, int y, int w, int h)
         return false;
     }
 
+    discardPretrigger();
+
     pthread_mutex_lock(&cameraID_mutex);
 
     status = SVBSetROIFormat(cameraID, x, y, w, h, 1);
@@ -837,88 +1084,25 @@ float Sv305CCD::CalcTimeLeft()
 }
 
 
-// grab loop
+// exposure progress, the frame itself is read by the capture thread
 void Sv305CCD::TimerHit()
 {
-    int timerID = -1;
-    long timeleft;
-
     if (isConnected() == false)
         return; //  No need to reset timer if we are not connected anymore
 
     if (InExposure)
     {
-        timeleft = CalcTimeLeft();
+        double timeleft = CalcTimeLeft();
+        if (timeleft < 0)
+            timeleft = 0;
 
-        if (timeleft < 1.0)
-        {
-            if (timeleft > 0.25)
-            {
-                //  a quarter of a second or more
-                //  just set a tighter timer
-                timerID = SetTimer(250);
-            }
-            else
-            {
-                if (timeleft > 0.07)
-                {
-                    //  use an even tighter timer
-                    timerID = SetTimer(50);
-                }
-                else
-                {
-                    pthread_mutex_lock(&cameraID_mutex);
-
-                    unsigned char* imageBuffer = PrimaryCCD.getFrameBuffer();
-                    status = SVBGetVideoData(cameraID, imageBuffer, PrimaryCCD.getFrameBufferSize(), 100 );
-                    while(status != SVB_SUCCESS)
-                    {
-                        pthread_mutex_unlock(&cameraID_mutex);
-                        usleep(100000);
-                        pthread_mutex_lock(&cameraID_mutex);
-			status = SVBGetVideoData(cameraID, imageBuffer, PrimaryCCD.getFrameBufferSize(), 100 );
-                        LOG_DEBUG("Wait...");
-                    }
-
-                    pthread_mutex_unlock(&cameraID_mutex);
-
-                    // exposing done
-                    PrimaryCCD.setExposureLeft(0);
-                    InExposure = false;
-
-                    // stretching 12bits depth to 16bits depth
-                    if(bitDepth==16 && (bitStretch != 0))
-                    {
-                        u_int16_t* tmp=(u_int16_t*)imageBuffer;
-                        for(int i=0; i<PrimaryCCD.getFrameBufferSize()/2; i++)
-                        {
-                                tmp[i]<<=bitStretch;
-                        }
-                    }
-
-                    // binning if needed
-                    if(binning)
-                        PrimaryCCD.binFrame();
-
-                    // exposure done
-                    ExposureComplete(&PrimaryCCD);
-                }
-            }
-        }
-        else
-        {
-            if (isDebug())
-            {
-                IDLog("With time left %ld\n", timeleft);
-                IDLog("image not yet ready....\n");
-            }
+        if (isDebug())
+            IDLog("With time left %.3f\n", timeleft);
 
-            PrimaryCCD.setExposureLeft(timeleft);
-        }
+        PrimaryCCD.setExposureLeft(timeleft);
     }
 
-    if (timerID == -1)
-        SetTimer(getCurrentPollingPeriod());
+    timerID = SetTimer(getCurrentPollingPeriod());
     return;
 }
 
@@ -928,13 +1112,16 @@ bool Sv305CCD::updateControl(int ControlType, SVB_CONTROL_TYPE SVB_Control, doub
 {
     IUUpdateNumber(&ControlsNP[ControlType], values, names, n);
 
-    pthread_mutex_unlock(&cameraID_mutex);
+    discardPretrigger();
+
+    pthread_mutex_lock(&cameraID_mutex);
 
     // set control
     status = SVBSetControlValue(cameraID, SVB_Control , ControlsN[ControlType].value, SVB_FALSE);
     if(status != SVB_SUCCESS)
     {
         LOGF_ERROR("Error, camera set control %d failed\n", ControlType);
+        pthread_mutex_unlock(&cameraID_mutex);
         return false;
     }
     LOGF_INFO("Camera control %d to %.f\n", ControlType, ControlsN[ControlType].value);
@@ -1036,6 +1223,8 @@ bool Sv305CCD::ISNewSwitch(const char *dev, const char *name, ISState *states, c
             IUUpdateSwitch(&FormatSP, states, names, n);
             tmpFormat = IUFindOnSwitchIndex(&FormatSP);
 
+            discardPretrigger();
+
             pthread_mutex_lock(&cameraID_mutex);
 
             // set new format
@@ -1089,6 +1278,8 @@ bool Sv305CCD::ISNewSwitch(const char *dev, const char *name, ISState *states, c
             IUUpdateSwitch(&SpeedSP, states, names, n);
             tmpSpeed = IUFindOnSwitchIndex(&SpeedSP);
 
+            discardPretrigger();
+
             pthread_mutex_lock(&cameraID_mutex);
 
             // set new frame rate
@@ -1136,6 +1327,24 @@ bool Sv305CCD::ISNewSwitch(const char *dev, const char *name, ISState *states, c
             return true;
         }
 
+        // Check if the soft trigger pipelining switch
+        if (!strcmp(name, PipelineSP.name))
+        {
+            IUUpdateSwitch(&PipelineSP, states, names, n);
+
+            if (PipelineS[PIPELINE_ON].s == ISS_ON)
+                LOG_INFO("Exposures pipelined, the next frame starts as soon as the sensor is read\n");
+            else
+            {
+                LOG_INFO("Exposures not pipelined\n");
+                discardPretrigger();
+            }
+
+            PipelineSP.s = IPS_OK;
+            IDSetSwitch(&PipelineSP, NULL);
+            return true;
+        }
+
     }
 
     // If we did not process the switch, let us pass it to the parent class to process it
@@ -1167,6 +1376,9 @@ bool Sv305CCD::saveConfigItems(FILE * fp)
     // bit stretching
     IUSaveConfigSwitch(fp, &StretchSP);
 
+    // soft trigger pipelining
+    IUSaveConfigSwitch(fp, &PipelineSP);
+
     return true;
 }
 
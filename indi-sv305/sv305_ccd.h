@@ -64,6 +64,10 @@ class Sv305CCD : public INDI::CCD
         static void* streamVideoHelper(void *context);
         void* streamVideo();
 
+        // exposure completion, off the INDI event loop
+        static void* captureFramesHelper(void *context);
+        void* captureFrames();
+
         // subframe
         virtual bool UpdateCCDFrame(int x, int y, int w, int h) override;
 
@@ -165,6 +169,28 @@ class Sv305CCD : public INDI::CCD
         float ExposureRequest;
         float CalcTimeLeft();
 
+        // capture worker and its control
+        pthread_t capture_thread;
+        pthread_mutex_t capture_mutex;
+        pthread_cond_t capture_cv;
+        bool captureRequested;
+        bool captureBusy;
+        // bumped by every start and abort, a frame whose generation changed is dropped
+        unsigned int captureGeneration;
+        bool terminateCapture;
+        bool captureCancelled(unsigned int generation);
+        bool waitFrame(unsigned char *imageBuffer, const struct timeval &deadline, unsigned int generation);
+
+        // soft trigger pipelining : next frame triggered as soon as the sensor is read
+        ISwitch PipelineS[2];
+        ISwitchVectorProperty PipelineSP;
+        enum { PIPELINE_ON, PIPELINE_OFF };
+        bool pretriggered;
+        float pretriggerDuration;
+        struct timeval pretriggerStart;
+        void pretrigger(float duration);
+        void discardPretrigger();
+
         // update CCD Params
         bool updateCCDParams();
 
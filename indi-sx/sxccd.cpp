@@ -33,6 +33,7 @@
 
 #include "sxconfig.h"
 
+#include <algorithm>
 #include <cmath>
 #include <deque>
 #include <memory>
@@ -47,6 +48,9 @@
 
 #define TIMER 1000
 
+/* Camera timed exposures are read this early, the read blocks until the camera sends pixels (ms) */
+#define CAMERA_TIMED_MARGIN 50
+
 static class Loader
 {
         std::deque<std::unique_ptr<SXCCD>> cameras;
@@ -103,6 +107,7 @@ SXCCD::SXCCD(DEVICE device, const char *name)
     ExposureTimerID       = 0;
     DidFlush              = false;
     DidLatch              = false;
+    CameraTimed           = false;
     GuideExposureTimerID  = 0;
     InGuideExposure       = false;
     DidGuideLatch         = false;
@@ -149,6 +154,11 @@ bool SXCCD::initProperties()
     IUFillSwitchVector(&ShutterSP, ShutterS, 2, getDeviceName(), "CCD_SHUTTER", "Shutter", OPTIONS_TAB, IP_RW,
                        ISR_1OFMANY, 60, IPS_IDLE);
 
+    // Exposures shorter than this are timed by the camera itself, 0 disables
+    IUFillNumber(&CameraTimedN[0], "THRESHOLD", "Below (s)", "%.2f", 0, 10, 0.1, 1);
+    IUFillNumberVector(&CameraTimedNP, CameraTimedN, 1, getDeviceName(), "CCD_CAMERA_TIMED", "Camera Timed", OPTIONS_TAB,
+                       IP_RW, 60, IPS_IDLE);
+
     //Adding switch to let user indicate whether the CCD has a Bayer filter, since I do not know which models beyond UltraStar C actually do
     //    IUFillSwitch(&BayerS[0], "BAYER_TRUE", "True", ISS_OFF);
     //    IUFillSwitch(&BayerS[1], "BAYER_FALSE", "False", ISS_ON);
@@ -173,6 +183,8 @@ bool SXCCD::updateProperties()
             defineProperty(&CoolerSP);
         if (HasShutter)
             defineProperty(&ShutterSP);
+        if (!sxIsInterlaced(model) && !sxIsICX453(model))
+            defineProperty(&CameraTimedNP);
         //        if (HasColor) {
         //            defineProperty(&BayerSP);
         //        }
@@ -183,6 +195,7 @@ bool SXCCD::updateProperties()
             deleteProperty(CoolerSP.name);
         if (HasShutter)
             deleteProperty(ShutterSP.name);
+        deleteProperty(CameraTimedNP.name);
         //        if (HasColor) {
         //            deleteProperty(BayerSP.name);
         //        }
@@ -403,6 +416,31 @@ bool SXCCD::StartExposure(float n)
 {
     InExposure = true;
     PrimaryCCD.setExposureDuration(n);
+
+    // Short exposures on progressive sensors are timed, latched and sent by the camera
+    CameraTimed = n < CameraTimedN[0].value && !sxIsInterlaced(model) && !sxIsICX453(model);
+    if (CameraTimed)
+    {
+        int time = std::max(1, (int)std::lround(1000 * n));
+        if (HasShutter && PrimaryCCD.getFrameType() != INDI::CCDChip::DARK_FRAME)
+            sxSetShutter(handle, 0);
+        if (!sxExposePixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, PrimaryCCD.getSubX(), PrimaryCCD.getSubY(),
+                            PrimaryCCD.getSubW(), PrimaryCCD.getSubH(), PrimaryCCD.getBinX(), PrimaryCCD.getBinY(), time))
+        {
+            LOG_ERROR("Failed to start camera timed exposure.");
+            if (HasShutter)
+                sxSetShutter(handle, 1);
+            InExposure = CameraTimed = false;
+            return false;
+        }
+        // Keep the cooler poll off the bus until the pixels are read
+        DidFlush         = true;
+        DidLatch         = true;
+        ExposureTimeLeft = n;
+        ExposureTimerID  = IEAddTimer(std::max(1, time - CAMERA_TIMED_MARGIN), ExposureTimerCallback, this);
+        return true;
+    }
+
     if (sxIsInterlaced(model) && PrimaryCCD.getBinY() == 1)
     {
         sxClearPixels(handle, CCD_EXP_FLAGS_FIELD_EVEN | CCD_EXP_FLAGS_NOWIPE_FRAME, 0);
@@ -438,9 +476,13 @@ bool SXCCD::AbortExposure()
         if (HasShutter)
             sxSetShutter(handle, 1);
         ExposureTimerID = 0;
+        // Camera is still counting down, a reset drops the pending pixels
+        if (CameraTimed)
+            sxReset(handle);
         PrimaryCCD.setExposureLeft(ExposureTimeLeft = 0);
-        DidLatch = false;
-        DidFlush = false;
+        DidLatch    = false;
+        DidFlush    = false;
+        CameraTimed = false;
         return true;
     }
     return false;
@@ -450,7 +492,26 @@ void SXCCD::ExposureTimerHit()
 {
     if (InExposure)
     {
-        if (!DidFlush)
+        if (CameraTimed)
+        {
+            ExposureTimerID = 0;
+            int size = PrimaryCCD.getSubW() * PrimaryCCD.getSubH() / PrimaryCCD.getBinX() / PrimaryCCD.getBinY();
+            int rc   = sxReadPixels(handle, PrimaryCCD.getFrameBuffer(), size * 2);
+            if (HasShutter)
+                sxSetShutter(handle, 1);
+            DidLatch    = false;
+            CameraTimed = false;
+            InExposure  = false;
+            PrimaryCCD.setExposureLeft(ExposureTimeLeft = 0);
+            if (rc)
+                ExposureComplete(&PrimaryCCD);
+            else
+            {
+                LOG_ERROR("Failed to read camera timed exposure.");
+                PrimaryCCD.setExposureFailed();
+            }
+        }
+        else if (!DidFlush)
         {
             ExposureTimerID = IEAddTimer(3000, ExposureTimerCallback, this);
             sxClearPixels(handle, CCD_EXP_FLAGS_NOWIPE_FRAME, 0);
@@ -795,9 +856,22 @@ bool SXCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, char
     return result;
 }
 
-//bool SXCCD::saveConfigItems(FILE *fp)
-//{
-//    INDI::CCD::saveConfigItems(fp);
-//    IUSaveConfigSwitch(fp, &BayerSP);
-//    return true;
-//}
+bool SXCCD::ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n)
+{
+    if (strcmp(name, CameraTimedNP.name) == 0)
+    {
+        IUUpdateNumber(&CameraTimedNP, values, names, n);
+        CameraTimedNP.s = IPS_OK;
+        IDSetNumber(&CameraTimedNP, nullptr);
+        return true;
+    }
+    return INDI::CCD::ISNewNumber(dev, name, values, names, n);
+}
+
+bool SXCCD::saveConfigItems(FILE *fp)
+{
+    INDI::CCD::saveConfigItems(fp);
+    IUSaveConfigNumber(fp, &CameraTimedNP);
+    //    IUSaveConfigSwitch(fp, &BayerSP);
+    return true;
+}
@@ -53,6 +53,8 @@ class SXCCD : public INDI::CCD
         ISwitchVectorProperty CoolerSP;
         ISwitch ShutterS[2];
         ISwitchVectorProperty ShutterSP;
+        INumber CameraTimedN[1];
+        INumberVectorProperty CameraTimedNP;
         //    ISwitch BayerS[2];
         //    ISwitchVectorProperty BayerSP;
         float TemperatureRequest;
@@ -65,6 +67,7 @@ class SXCCD : public INDI::CCD
         int NSGuiderTimerID;
         bool DidFlush;
         bool DidLatch;
+        bool CameraTimed;
         bool DidGuideLatch;
         bool InGuideExposure;
         char GuideStatus;
@@ -88,7 +91,7 @@ class SXCCD : public INDI::CCD
         void GuideExposureTimerHit();
         void WEGuiderTimerHit();
         void NSGuiderTimerHit();
-        //bool saveConfigItems(FILE *fp);
+        bool saveConfigItems(FILE *fp);
         IPState GuideWest(uint32_t ms);
         IPState GuideEast(uint32_t ms);
         IPState GuideNorth(uint32_t ms);
@@ -106,6 +109,7 @@ class SXCCD : public INDI::CCD
         void simulationTriggered(bool enable);
         void ISGetProperties(const char *dev);
         bool ISNewSwitch(const char *dev, const char *name, ISState *states, char *names[], int n);
+        bool ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n);
 
         friend void ::ExposureTimerCallback(void *p);
         friend void ::GuideExposureTimerCallback(void *p);
@@ -27,6 +27,9 @@
 
 #include <math.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <deque>
 #include <memory>
 
@@ -276,6 +279,72 @@ bool ToupBase::initProperties()
     IUFillSwitchVector(&HeatUpSP, HeatUpS, 2, getDeviceName(), "TC_HEAT_CONTROL", "Heat", CONTROL_TAB,
                        IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
 
+    ///////////////////////////////////////////////////////////////////////////////////
+    /// On-camera Dark & Flat Field Correction
+    ///////////////////////////////////////////////////////////////////////////////////
+    IUFillSwitch(&CalibrationS[TC_DARK_CORRECTION], "TC_DARK_CORRECTION", "Dark", ISS_OFF);
+    IUFillSwitch(&CalibrationS[TC_FLAT_CORRECTION], "TC_FLAT_CORRECTION", "Flat", ISS_OFF);
+    IUFillSwitchVector(&CalibrationSP, CalibrationS, 2, getDeviceName(), "TC_FIELD_CORRECTION", "Correction", CONTROL_TAB,
+                       IP_RW, ISR_NOFMANY, 60, IPS_IDLE);
+
+    IUFillSwitch(&CalibrationCaptureS[TC_CAPTURE_DARK], "TC_CAPTURE_DARK", "Dark", ISS_OFF);
+    IUFillSwitch(&CalibrationCaptureS[TC_CAPTURE_FLAT], "TC_CAPTURE_FLAT", "Flat", ISS_OFF);
+    IUFillSwitchVector(&CalibrationCaptureSP, CalibrationCaptureS, 2, getDeviceName(), "TC_FIELD_CAPTURE", "Capture",
+                       CONTROL_TAB, IP_RW, ISR_ATMOST1, 60, IPS_IDLE);
+
+    IUFillNumber(&CalibrationFramesN[TC_DARK_FRAMES], "TC_DARK_FRAMES", "Dark Frames", "%.f", 1, 255, 1, 5);
+    IUFillNumber(&CalibrationFramesN[TC_FLAT_FRAMES], "TC_FLAT_FRAMES", "Flat Frames", "%.f", 1, 255, 1, 5);
+    IUFillNumberVector(&CalibrationFramesNP, CalibrationFramesN, 2, getDeviceName(), "TC_FIELD_FRAMES", "Average",
+                       CONTROL_TAB, IP_RW, 60, IPS_IDLE);
+
+    ///////////////////////////////////////////////////////////////////////////////////
+    /// Frame Queue
+    ///////////////////////////////////////////////////////////////////////////////////
+    IUFillNumber(&FrameQueueN[TC_DEQUE_LENGTH], "TC_DEQUE_LENGTH", "Frames", "%.f", 2, 1024, 1, 3);
+    IUFillNumberVector(&FrameQueueNP, FrameQueueN, 1, getDeviceName(), "TC_FRAME_QUEUE", "Frame Queue", CONTROL_TAB,
+                       IP_RW, 60, IPS_IDLE);
+
+    IUFillSwitch(&DDRDepthS[TC_DDR_AUTO], "TC_DDR_AUTO", "Auto", ISS_ON);
+    IUFillSwitch(&DDRDepthS[TC_DDR_ONE], "TC_DDR_ONE", "One Frame", ISS_OFF);
+    IUFillSwitch(&DDRDepthS[TC_DDR_FULL], "TC_DDR_FULL", "Full", ISS_OFF);
+    IUFillSwitchVector(&DDRDepthSP, DDRDepthS, 3, getDeviceName(), "TC_DDR_DEPTH", "DDR Cache", CONTROL_TAB,
+                       IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+
+    ///////////////////////////////////////////////////////////////////////////////////
+    /// Dropped Frames
+    ///////////////////////////////////////////////////////////////////////////////////
+    IUFillNumber(&DroppedFramesN[0], "TC_DROPPED_FRAMES", "Frames", "%.f", 0, 1e9, 0, 0);
+    IUFillNumberVector(&DroppedFramesNP, DroppedFramesN, 1, getDeviceName(), "TC_DROPPED_FRAMES", "Dropped", IMAGE_INFO_TAB,
+                       IP_RO, 60, IPS_IDLE);
+
+    ///////////////////////////////////////////////////////////////////////////////////
+    /// Exposure Phase Timing
+    ///////////////////////////////////////////////////////////////////////////////////
+    IUFillSwitch(&TimingS[TC_TIMING_STATS], "TIMING_STATS", "Statistics", ISS_OFF);
+    IUFillSwitch(&TimingS[TC_TIMING_TRACE], "TIMING_TRACE", "CSV Trace", ISS_OFF);
+    IUFillSwitchVector(&TimingSP, TimingS, 2, getDeviceName(), "EXPOSURE_TIMING", "Phase Timing", OPTIONS_TAB,
+                       IP_RW, ISR_NOFMANY, 60, IPS_IDLE);
+
+    std::string tracePath = std::string("~/.indi/") + getDeviceName() + "_timing.csv";
+    std::replace(tracePath.begin(), tracePath.end(), ' ', '_');
+    IUFillText(&TimingTraceT[0], "TRACE_FILE", "File", tracePath.c_str());
+    IUFillTextVector(&TimingTraceTP, TimingTraceT, 1, getDeviceName(), "EXPOSURE_TIMING_TRACE", "Timing Trace", OPTIONS_TAB,
+                     IP_RW, 60, IPS_IDLE);
+
+    IUFillNumber(&TimingStatsN[TC_TIMING_FRAMES], "FRAMES", "Frames", "%.f", 0, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TC_TIMING_ARM_MEAN], "ARM_MEAN", "Arm (ms)", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TC_TIMING_ARM_MAX], "ARM_MAX", "Arm max (ms)", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TC_TIMING_EXPOSURE_MEAN], "EXPOSURE_MEAN", "Overrun (ms)", "%.1f", -1e9, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TC_TIMING_EXPOSURE_MAX], "EXPOSURE_MAX", "Overrun max (ms)", "%.1f", -1e9, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TC_TIMING_DOWNLOAD_MEAN], "DOWNLOAD_MEAN", "Download (ms)", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TC_TIMING_DOWNLOAD_MAX], "DOWNLOAD_MAX", "Download max (ms)", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TC_TIMING_PROCESS_MEAN], "PROCESS_MEAN", "Process (ms)", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TC_TIMING_PROCESS_MAX], "PROCESS_MAX", "Process max (ms)", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TC_TIMING_COMPLETE_MEAN], "COMPLETE_MEAN", "Complete (ms)", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumber(&TimingStatsN[TC_TIMING_COMPLETE_MAX], "COMPLETE_MAX", "Complete max (ms)", "%.1f", 0, 1e9, 0, 0);
+    IUFillNumberVector(&TimingStatsNP, TimingStatsN, 11, getDeviceName(), "EXPOSURE_TIMING_STATS", "Phase Stats", OPTIONS_TAB,
+                       IP_RO, 60, IPS_IDLE);
+
 
     ///////////////////////////////////////////////////////////////////////////////////
     /// Fan Control
@@ -373,6 +442,22 @@ bool ToupBase::updateProperties()
         if (m_HasHeatUp)
             defineProperty(&HeatUpSP);
 
+        if (m_HasDFC || m_HasFFC)
+        {
+            defineProperty(&CalibrationSP);
+            defineProperty(&CalibrationCaptureSP);
+            defineProperty(&CalibrationFramesNP);
+        }
+
+        defineProperty(&FrameQueueNP);
+        if (m_HasDDR)
+            defineProperty(&DDRDepthSP);
+        if (m_HasDroppedFrames)
+            defineProperty(&DroppedFramesNP);
+        defineProperty(&TimingSP);
+        defineProperty(&TimingTraceTP);
+        defineProperty(&TimingStatsNP);
+
         if (m_Instance->model->flag & (CP(FLAG_CG) | CP(FLAG_CGHDR)))
         {
             m_hasDualGain = true;
@@ -423,6 +508,22 @@ bool ToupBase::updateProperties()
         if (m_HasHeatUp)
             deleteProperty(HeatUpSP.name);
 
+        if (m_HasDFC || m_HasFFC)
+        {
+            deleteProperty(CalibrationSP.name);
+            deleteProperty(CalibrationCaptureSP.name);
+            deleteProperty(CalibrationFramesNP.name);
+        }
+
+        deleteProperty(FrameQueueNP.name);
+        if (m_HasDDR)
+            deleteProperty(DDRDepthSP.name);
+        if (m_HasDroppedFrames)
+            deleteProperty(DroppedFramesNP.name);
+        deleteProperty(TimingSP.name);
+        deleteProperty(TimingTraceTP.name);
+        deleteProperty(TimingStatsNP.name);
+
         if (m_Instance->model->flag & (CP(FLAG_CG) | CP(FLAG_CGHDR)))
         {
             deleteProperty(GainConversionNP.name);
@@ -906,6 +1007,9 @@ void ToupBase::setupParams()
     OffsetN[TC_OFFSET].step = bLevelStep;
 
 
+    // Dark & Flat Field Correction, DDR and frame deque
+    setupCalibration();
+
     // Allocate memory
     allocateFrameBuffer();
 
@@ -1242,6 +1346,69 @@ bool ToupBase::ISNewNumber(const char *dev, const char *name, double values[], c
             return true;
         }
 
+        //////////////////////////////////////////////////////////////////////
+        /// Dark & Flat Field Correction average
+        //////////////////////////////////////////////////////////////////////
+        if (!strcmp(name, CalibrationFramesNP.name))
+        {
+            IUUpdateNumber(&CalibrationFramesNP, values, names, n);
+
+            // Upper byte all set selects the number of frames to average
+            HRESULT rc = 0;
+            if (m_HasDFC)
+                rc = FP(put_Option(m_CameraHandle, CP(OPTION_DFC),
+                                   0xff000000 | static_cast<int>(CalibrationFramesN[TC_DARK_FRAMES].value)));
+            if (m_HasFFC && SUCCEEDED(rc))
+                rc = FP(put_Option(m_CameraHandle, CP(OPTION_FFC),
+                                   0xff000000 | static_cast<int>(CalibrationFramesN[TC_FLAT_FRAMES].value)));
+
+            if (FAILED(rc))
+            {
+                CalibrationFramesNP.s = IPS_ALERT;
+                LOGF_ERROR("Failed to set correction average. %s", errorCodes[rc].c_str());
+            }
+            else
+                CalibrationFramesNP.s = IPS_OK;
+
+            IDSetNumber(&CalibrationFramesNP, nullptr);
+            return true;
+        }
+
+        //////////////////////////////////////////////////////////////////////
+        /// Frame Deque Length
+        //////////////////////////////////////////////////////////////////////
+        if (!strcmp(name, FrameQueueNP.name))
+        {
+            double oldValue = FrameQueueN[TC_DEQUE_LENGTH].value;
+            IUUpdateNumber(&FrameQueueNP, values, names, n);
+            if (fabs(FrameQueueN[TC_DEQUE_LENGTH].value - oldValue) < 0.5)
+            {
+                FrameQueueNP.s = IPS_OK;
+                IDSetNumber(&FrameQueueNP, nullptr);
+                return true;
+            }
+
+            if (InExposure || Streamer->isBusy())
+            {
+                FrameQueueN[TC_DEQUE_LENGTH].value = oldValue;
+                FrameQueueNP.s = IPS_ALERT;
+                LOG_ERROR("Cannot change frame queue while exposing or streaming.");
+                IDSetNumber(&FrameQueueNP, nullptr);
+                return true;
+            }
+
+            if (setFrameDequeLength(static_cast<int>(FrameQueueN[TC_DEQUE_LENGTH].value)))
+                FrameQueueNP.s = IPS_OK;
+            else
+            {
+                FrameQueueN[TC_DEQUE_LENGTH].value = oldValue;
+                FrameQueueNP.s = IPS_ALERT;
+            }
+
+            IDSetNumber(&FrameQueueNP, nullptr);
+            return true;
+        }
+
     }
 
     return INDI::CCD::ISNewNumber(dev, name, values, names, n);
@@ -1251,6 +1418,16 @@ bool ToupBase::ISNewSwitch(const char *dev, const char *name, ISState * states,
 {
     if (dev != nullptr && !strcmp(dev, getDeviceName()))
     {
+        //////////////////////////////////////////////////////////////////////
+        /// Exposure Phase Timing
+        //////////////////////////////////////////////////////////////////////
+        if (!strcmp(name, TimingSP.name))
+        {
+            IUUpdateSwitch(&TimingSP, states, names, n);
+            setupTiming();
+            return true;
+        }
+
         //////////////////////////////////////////////////////////////////////
         /// Cooler Control
         //////////////////////////////////////////////////////////////////////
@@ -1374,6 +1551,116 @@ bool ToupBase::ISNewSwitch(const char *dev, const char *name, ISState * states,
             return true;
         }
 
+        //////////////////////////////////////////////////////////////////////
+        /// Dark & Flat Field Correction
+        //////////////////////////////////////////////////////////////////////
+        if (!strcmp(name, CalibrationSP.name))
+        {
+            ISState darkState = CalibrationS[TC_DARK_CORRECTION].s;
+            ISState flatState = CalibrationS[TC_FLAT_CORRECTION].s;
+            IUUpdateSwitch(&CalibrationSP, states, names, n);
+
+            HRESULT rc = 0;
+            if (m_HasDFC && CalibrationS[TC_DARK_CORRECTION].s != darkState)
+                rc = FP(put_Option(m_CameraHandle, CP(OPTION_DFC), CalibrationS[TC_DARK_CORRECTION].s == ISS_ON ? 1 : 0));
+            if (m_HasFFC && CalibrationS[TC_FLAT_CORRECTION].s != flatState && SUCCEEDED(rc))
+                rc = FP(put_Option(m_CameraHandle, CP(OPTION_FFC), CalibrationS[TC_FLAT_CORRECTION].s == ISS_ON ? 1 : 0));
+
+            if (FAILED(rc))
+            {
+                LOGF_ERROR("Failed to set field correction. Error (%s)", errorCodes[rc].c_str());
+                CalibrationS[TC_DARK_CORRECTION].s = darkState;
+                CalibrationS[TC_FLAT_CORRECTION].s = flatState;
+                CalibrationSP.s = IPS_ALERT;
+            }
+            else
+            {
+                CalibrationSP.s = IPS_OK;
+            }
+
+            IDSetSwitch(&CalibrationSP, nullptr);
+            return true;
+        }
+
+        if (!strcmp(name, CalibrationCaptureSP.name))
+        {
+            IUUpdateSwitch(&CalibrationCaptureSP, states, names, n);
+
+            HRESULT rc = 0;
+            switch (IUFindOnSwitchIndex(&CalibrationCaptureSP))
+            {
+                case TC_CAPTURE_DARK:
+                    rc = m_HasDFC ? FP(DfcOnce(m_CameraHandle)) : E_NOTIMPL;
+                    if (SUCCEEDED(rc))
+                        LOGF_INFO("Averaging the next %.f frames for dark field correction. Cover the telescope and stream or expose.",
+                                  CalibrationFramesN[TC_DARK_FRAMES].value);
+                    break;
+                case TC_CAPTURE_FLAT:
+                    rc = m_HasFFC ? FP(FfcOnce(m_CameraHandle)) : E_NOTIMPL;
+                    if (SUCCEEDED(rc))
+                        LOGF_INFO("Averaging the next %.f frames for flat field correction. Point at an even light source and stream or expose.",
+                                  CalibrationFramesN[TC_FLAT_FRAMES].value);
+                    break;
+                default:
+                    CalibrationCaptureSP.s = IPS_IDLE;
+                    IDSetSwitch(&CalibrationCaptureSP, nullptr);
+                    return true;
+            }
+
+            if (FAILED(rc))
+            {
+                LOGF_ERROR("Failed to start field correction capture. Error (%s)", errorCodes[rc].c_str());
+                IUResetSwitch(&CalibrationCaptureSP);
+                CalibrationCaptureSP.s = IPS_ALERT;
+            }
+            else
+            {
+                // Completed by EVENT_DFC / EVENT_FFC
+                CalibrationCaptureSP.s = IPS_BUSY;
+            }
+
+            IDSetSwitch(&CalibrationCaptureSP, nullptr);
+            return true;
+        }
+
+        //////////////////////////////////////////////////////////////////////
+        /// DDR Cache Depth
+        //////////////////////////////////////////////////////////////////////
+        if (!strcmp(name, DDRDepthSP.name))
+        {
+            int prevIndex = IUFindOnSwitchIndex(&DDRDepthSP);
+            IUUpdateSwitch(&DDRDepthSP, states, names, n);
+            int depth = 0;
+            switch (IUFindOnSwitchIndex(&DDRDepthSP))
+            {
+                case TC_DDR_ONE:
+                    depth = 1;
+                    break;
+                case TC_DDR_FULL:
+                    depth = -1;
+                    break;
+                default:
+                    depth = 0;
+                    break;
+            }
+
+            HRESULT rc = FP(put_Option(m_CameraHandle, CP(OPTION_DDR_DEPTH), depth));
+            if (FAILED(rc))
+            {
+                LOGF_ERROR("Failed to set DDR cache depth. Error (%s)", errorCodes[rc].c_str());
+                IUResetSwitch(&DDRDepthSP);
+                DDRDepthS[prevIndex].s = ISS_ON;
+                DDRDepthSP.s = IPS_ALERT;
+            }
+            else
+            {
+                DDRDepthSP.s = IPS_OK;
+            }
+
+            IDSetSwitch(&DDRDepthSP, nullptr);
+            return true;
+        }
+
         //////////////////////////////////////////////////////////////////////
         /// Video Format
         //////////////////////////////////////////////////////////////////////
@@ -1702,6 +1989,61 @@ bool ToupBase::ISNewSwitch(const char *dev, const char *name, ISState * states,
     return INDI::CCD::ISNewSwitch(dev, name, states, names, n);
 }
 
+bool ToupBase::ISNewText(const char *dev, const char *name, char *texts[], char *names[], int n)
+{
+    if (dev != nullptr && !strcmp(dev, getDeviceName()))
+    {
+        if (!strcmp(name, TimingTraceTP.name))
+        {
+            IUUpdateText(&TimingTraceTP, texts, names, n);
+            TimingTraceTP.s = IPS_OK;
+            IDSetText(&TimingTraceTP, nullptr);
+
+            // Reopen the trace under its new name
+            if (TimingS[TC_TIMING_TRACE].s == ISS_ON)
+                setupTiming();
+            return true;
+        }
+    }
+
+    return INDI::CCD::ISNewText(dev, name, texts, names, n);
+}
+
+bool ToupBase::setupTiming()
+{
+    bool trace = (TimingS[TC_TIMING_TRACE].s == ISS_ON);
+    bool ok    = true;
+
+    m_Timing.closeTrace();
+    if (trace && !m_Timing.openTrace(TimingTraceT[0].text))
+    {
+        LOGF_ERROR("Failed to open timing trace %s (%s).", TimingTraceT[0].text, strerror(errno));
+        TimingS[TC_TIMING_TRACE].s = ISS_OFF;
+        trace = false;
+        ok    = false;
+    }
+
+    bool enabled = trace || TimingS[TC_TIMING_STATS].s == ISS_ON;
+    m_Timing.setEnabled(enabled);
+
+    TimingSP.s = ok ? (enabled ? IPS_OK : IPS_IDLE) : IPS_ALERT;
+    IDSetSwitch(&TimingSP, nullptr);
+    return ok;
+}
+
+void ToupBase::updateTimingStats()
+{
+    TimingStatsN[TC_TIMING_FRAMES].value = m_Timing.getFrames();
+    for (int i = 0; i < ExposureTiming::PHASE_N; i++)
+    {
+        auto phase = static_cast<ExposureTiming::Phase>(i);
+        TimingStatsN[TC_TIMING_ARM_MEAN + 2 * i].value = m_Timing.getMean(phase);
+        TimingStatsN[TC_TIMING_ARM_MAX + 2 * i].value  = m_Timing.getMax(phase);
+    }
+    TimingStatsNP.s = IPS_OK;
+    IDSetNumber(&TimingStatsNP, nullptr);
+}
+
 bool ToupBase::dualGainEnabled()
 {
     return m_hasDualGain &&
@@ -1881,6 +2223,7 @@ bool ToupBase::activateCooler(bool enable)
 bool ToupBase::StartExposure(float duration)
 {
     HRESULT rc = 0;
+    m_Timing.start(duration);
     PrimaryCCD.setExposureDuration(static_cast<double>(duration));
 
     uint32_t uSecs = static_cast<uint32_t>(duration * 1000000.0f);
@@ -1954,6 +2297,8 @@ bool ToupBase::StartExposure(float duration)
         }
     }
 
+    m_Timing.mark(ExposureTiming::PHASE_ARM);
+
     // Timeout 500ms after expected duration
     m_CaptureTimeout.start(duration * 1000 + m_DownloadEstimation * 1.2);
 
@@ -2086,6 +2431,9 @@ void ToupBase::TimerHit()
         PrimaryCCD.setExposureLeft(timeleft);
     }
 
+    if (m_HasDroppedFrames)
+        updateDroppedFrames();
+
     if (m_Instance->model->flag & CP(FLAG_GETTEMPERATURE))
     {
         double currentTemperature = TemperatureN[0].value;
@@ -2301,6 +2649,119 @@ void ToupBase::refreshControls()
     IDSetNumber(&ControlNP, nullptr);
 }
 
+void ToupBase::setupCalibration()
+{
+    int val = 0;
+
+    // Option get: (val & 0xff) 0 disabled, 1 enabled, 2 inited; (val & 0xff0000) >> 16 average number
+    m_HasDFC = SUCCEEDED(FP(get_Option(m_CameraHandle, CP(OPTION_DFC), &val)));
+    if (m_HasDFC)
+    {
+        LOGF_DEBUG("Dark field correction: %#08X", val);
+        CalibrationS[TC_DARK_CORRECTION].s = (val & 0xff) == 1 ? ISS_ON : ISS_OFF;
+        if ((val & 0xff0000) >> 16)
+            CalibrationFramesN[TC_DARK_FRAMES].value = (val & 0xff0000) >> 16;
+    }
+
+    val = 0;
+    m_HasFFC = SUCCEEDED(FP(get_Option(m_CameraHandle, CP(OPTION_FFC), &val)));
+    if (m_HasFFC)
+    {
+        LOGF_DEBUG("Flat field correction: %#08X", val);
+        CalibrationS[TC_FLAT_CORRECTION].s = (val & 0xff) == 1 ? ISS_ON : ISS_OFF;
+        if ((val & 0xff0000) >> 16)
+            CalibrationFramesN[TC_FLAT_FRAMES].value = (val & 0xff0000) >> 16;
+    }
+
+    // DDR cache depth: 1 one frame, 0 auto, -1 full capacity
+    m_HasDDR = m_Instance->model->flag & CP(FLAG_DDR);
+    if (m_HasDDR)
+    {
+        val = 0;
+        FP(get_Option(m_CameraHandle, CP(OPTION_DDR_DEPTH), &val));
+        LOGF_DEBUG("DDR depth: %d", val);
+        IUResetSwitch(&DDRDepthSP);
+        DDRDepthS[val == 1 ? TC_DDR_ONE : (val < 0 ? TC_DDR_FULL : TC_DDR_AUTO)].s = ISS_ON;
+    }
+
+    // Deque is allocated when the camera starts, so it must be set before push mode
+    HRESULT rc = FP(put_Option(m_CameraHandle, CP(OPTION_FRAME_DEQUE_LENGTH), static_cast<int>(FrameQueueN[TC_DEQUE_LENGTH].value)));
+    LOGF_DEBUG("Frame deque length %.f rc: %d", FrameQueueN[TC_DEQUE_LENGTH].value, rc);
+
+    // Not all SDK flavors define the option, older firmware rejects it
+    val = 0;
+    m_HasDroppedFrames = SUCCEEDED(FP(get_Option(m_CameraHandle, OPTION_NUMBER_DROP_FRAME, &val)));
+    DroppedFramesN[0].value = val;
+    DroppedFramesNP.s = IPS_IDLE;
+}
+
+void ToupBase::calibrationChanged(bool dark)
+{
+    int val = 0;
+    HRESULT rc = FP(get_Option(m_CameraHandle, dark ? CP(OPTION_DFC) : CP(OPTION_FFC), &val));
+    if (FAILED(rc))
+        return;
+
+    ISState state = (val & 0xff) == 1 ? ISS_ON : ISS_OFF;
+    int index = dark ? TC_DARK_CORRECTION : TC_FLAT_CORRECTION;
+    if (CalibrationS[index].s != state)
+    {
+        CalibrationS[index].s = state;
+        IDSetSwitch(&CalibrationSP, nullptr);
+    }
+
+    int captureIndex = dark ? TC_CAPTURE_DARK : TC_CAPTURE_FLAT;
+    if (CalibrationCaptureSP.s == IPS_BUSY && CalibrationCaptureS[captureIndex].s == ISS_ON)
+    {
+        if (state == ISS_ON)
+            LOGF_INFO("%s field correction captured and applied.", dark ? "Dark" : "Flat");
+        else
+            LOGF_INFO("%s field correction captured. Enable correction to apply it.", dark ? "Dark" : "Flat");
+        IUResetSwitch(&CalibrationCaptureSP);
+        CalibrationCaptureSP.s = IPS_OK;
+        IDSetSwitch(&CalibrationCaptureSP, nullptr);
+    }
+}
+
+void ToupBase::updateDroppedFrames()
+{
+    int dropped = 0;
+    if (FAILED(FP(get_Option(m_CameraHandle, OPTION_NUMBER_DROP_FRAME, &dropped))))
+        return;
+
+    // Alert while frames keep being dropped, back to OK once the count settles
+    IPState state = dropped > DroppedFramesN[0].value ? IPS_ALERT : (dropped > 0 ? IPS_OK : IPS_IDLE);
+    if (dropped != DroppedFramesN[0].value || state != DroppedFramesNP.s)
+    {
+        if (dropped > DroppedFramesN[0].value)
+            LOGF_DEBUG("%d frames dropped since connection.", dropped);
+        DroppedFramesN[0].value = dropped;
+        DroppedFramesNP.s = state;
+        IDSetNumber(&DroppedFramesNP, nullptr);
+    }
+}
+
+bool ToupBase::setFrameDequeLength(int length)
+{
+    // Frames are allocated when the camera starts, so restart it around the change
+    FP(Stop(m_CameraHandle));
+
+    HRESULT rc = FP(put_Option(m_CameraHandle, CP(OPTION_FRAME_DEQUE_LENGTH), length));
+    if (FAILED(rc))
+        LOGF_ERROR("Failed to set frame deque length. %s", errorCodes[rc].c_str());
+    else
+        LOGF_INFO("Frame deque length set to %d frames.", length);
+
+    HRESULT startRC = FP(StartPushModeV3(m_CameraHandle, &ToupBase::pushCB, this, &ToupBase::eventCB, this));
+    if (FAILED(startRC))
+    {
+        LOGF_ERROR("Failed to restart camera push mode. %s", errorCodes[startRC].c_str());
+        return false;
+    }
+
+    return SUCCEEDED(rc);
+}
+
 void ToupBase::addFITSKeywords(fitsfile * fptr, INDI::CCDChip * targetChip)
 {
     INDI::CCD::addFITSKeywords(fptr, targetChip);
@@ -2331,6 +2792,14 @@ bool ToupBase::saveConfigItems(FILE * fp)
     IUSaveConfigSwitch(fp, &VideoFormatSP);
     if (m_HasLowNoise)
         IUSaveConfigSwitch(fp, &LowNoiseSP);
+
+    if (m_HasDFC || m_HasFFC)
+        IUSaveConfigNumber(fp, &CalibrationFramesNP);
+    IUSaveConfigNumber(fp, &FrameQueueNP);
+    if (m_HasDDR)
+        IUSaveConfigSwitch(fp, &DDRDepthSP);
+    IUSaveConfigText(fp, &TimingTraceTP);
+    IUSaveConfigSwitch(fp, &TimingSP);
     return true;
 }
 
@@ -2408,6 +2877,7 @@ void ToupBase::pushCallback(const void* pData, const XP(FrameInfoV2)* pInfo, int
         LOGF_DEBUG("New download estimate %.f ms", m_DownloadEstimation);
 
         InExposure  = false;
+        m_Timing.mark(ExposureTiming::PHASE_EXPOSURE);
         PrimaryCCD.setExposureLeft(0);
         uint8_t *buffer = PrimaryCCD.getFrameBuffer();
         uint32_t size = PrimaryCCD.getFrameBufferSize();
@@ -2428,6 +2898,7 @@ void ToupBase::pushCallback(const void* pData, const XP(FrameInfoV2)* pInfo, int
         else
         {
             memcpy(buffer, pData, size);
+            m_Timing.mark(ExposureTiming::PHASE_DOWNLOAD);
 
             if (m_MonoCamera == false && m_CurrentVideoFormat == TC_VIDEO_COLOR_RGB)
             {
@@ -2452,6 +2923,7 @@ void ToupBase::pushCallback(const void* pData, const XP(FrameInfoV2)* pInfo, int
                 guard.unlock();
                 free(buffer);
             }
+            m_Timing.mark(ExposureTiming::PHASE_PROCESS);
 
             LOGF_DEBUG("Image received. Width: %d Height: %d flag: %d timestamp: %ld"
                        , pInfo->width,
@@ -2459,6 +2931,9 @@ void ToupBase::pushCallback(const void* pData, const XP(FrameInfoV2)* pInfo, int
                        pInfo->flag,
                        pInfo->timestamp);
             ExposureComplete(&PrimaryCCD);
+
+            if (m_Timing.mark(ExposureTiming::PHASE_COMPLETE))
+                updateTimingStats();
         }
     }
 }
@@ -2507,6 +2982,7 @@ void ToupBase::eventPullCallBack(unsigned event)
                 else if (InExposure)
                 {
                     InExposure = false;
+                    m_Timing.mark(ExposureTiming::PHASE_EXPOSURE);
                     PrimaryCCD.setExposureLeft(0);
                     uint8_t *buffer = PrimaryCCD.getFrameBuffer();
 
@@ -2516,6 +2992,7 @@ void ToupBase::eventPullCallBack(unsigned event)
                     std::unique_lock<std::mutex> guard(ccdBufferLock);
                     HRESULT rc = FP(PullImageV2(m_CameraHandle, buffer, captureBits * m_Channels, &info));
                     guard.unlock();
+                    m_Timing.mark(ExposureTiming::PHASE_DOWNLOAD);
                     if (FAILED(rc))
                     {
                         LOGF_ERROR("Failed to pull image. %s", errorCodes[rc].c_str());
@@ -2548,10 +3025,14 @@ void ToupBase::eventPullCallBack(unsigned event)
                             guard.unlock();
                             free(buffer);
                         }
+                        m_Timing.mark(ExposureTiming::PHASE_PROCESS);
 
                         LOGF_DEBUG("Image received. Width: %d Height: %d flag: %d timestamp: %ld", info.width, info.height, info.flag,
                                    info.timestamp);
                         ExposureComplete(&PrimaryCCD);
+
+                        if (m_Timing.mark(ExposureTiming::PHASE_COMPLETE))
+                            updateTimingStats();
                     }
                 }
                 else
@@ -2593,6 +3074,7 @@ void ToupBase::eventPullCallBack(unsigned event)
                 else if (InExposure)
                 {
                     InExposure = false;
+                    m_Timing.mark(ExposureTiming::PHASE_EXPOSURE);
                     PrimaryCCD.setExposureLeft(0);
                     uint8_t *buffer = PrimaryCCD.getFrameBuffer();
 
@@ -2602,6 +3084,7 @@ void ToupBase::eventPullCallBack(unsigned event)
                     std::unique_lock<std::mutex> guard(ccdBufferLock);
                     HRESULT rc = FP(PullStillImageV2(m_CameraHandle, buffer, captureBits * m_Channels, &info));
                     guard.unlock();
+                    m_Timing.mark(ExposureTiming::PHASE_DOWNLOAD);
                     if (FAILED(rc))
                     {
                         LOGF_ERROR("Failed to pull image. %s", errorCodes[rc].c_str());
@@ -2634,10 +3117,14 @@ void ToupBase::eventPullCallBack(unsigned event)
                             guard.unlock();
                             free(buffer);
                         }
+                        m_Timing.mark(ExposureTiming::PHASE_PROCESS);
 
                         LOGF_DEBUG("Image received. Width: %d Height: %d flag: %d timestamp: %ld", info.width, info.height, info.flag,
                                    info.timestamp);
                         ExposureComplete(&PrimaryCCD);
+
+                        if (m_Timing.mark(ExposureTiming::PHASE_COMPLETE))
+                            updateTimingStats();
                     }
                 }
                 else
@@ -2688,9 +3175,11 @@ void ToupBase::eventPullCallBack(unsigned event)
                 LOG_DEBUG("Black Balance Gain changed.");
             break;
         case CP(EVENT_FFC: )
-                break;
+                calibrationChanged(false);
+            break;
         case CP(EVENT_DFC: )
-                break;
+                calibrationChanged(true);
+            break;
         case CP(EVENT_ERROR: )
                 break;
         case CP(EVENT_DISCONNECTED: )
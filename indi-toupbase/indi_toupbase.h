@@ -25,6 +25,8 @@
 #include <indiccd.h>
 #include <inditimer.h>
 
+#include "exposure_timing.h"
+
 #ifdef BUILD_TOUPCAM
 #include <toupcam.h>
 #define FP(x) Toupcam_##x
@@ -87,6 +89,7 @@ class ToupBase : public INDI::CCD
     protected:
         virtual bool ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n) override;
         virtual bool ISNewSwitch(const char *dev, const char *name, ISState *states, char *names[], int n) override;
+        virtual bool ISNewText(const char *dev, const char *name, char *texts[], char *names[], int n) override;
 
         // Streaming
         virtual bool StartStreaming() override;
@@ -275,6 +278,8 @@ class ToupBase : public INDI::CCD
             OPTION_HEAT_MAX        = 0x36,     /* maximum level: heat to prevent fogging up */
             OPTION_HEAT            = 0x37,     /* heat to prevent fogging up */
             OPTION_LOW_NOISE       = 0x38,     /* low noise mode: 1 => enable */
+
+            OPTION_NUMBER_DROP_FRAME = 0x3e,   /* get the number of frames that have been grabbed from the USB but dropped by the software */
         };
 
         enum eGUIDEDIRECTION
@@ -396,6 +401,14 @@ class ToupBase : public INDI::CCD
         // Update control values from camera
         void refreshControls();
 
+        //#############################################################################
+        // Dark & Flat Field Correction
+        //#############################################################################
+        void setupCalibration();
+        void calibrationChanged(bool dark);
+        void updateDroppedFrames();
+        bool setFrameDequeLength(int length);
+
         //#############################################################################
         // Dual conversion Gain
         //#############################################################################
@@ -414,6 +427,10 @@ class ToupBase : public INDI::CCD
         //#############################################################################
         // Get the current Bayer string used
         const char *getBayerString();
+        // Enable exposure phase timing and the CSV trace as selected
+        bool setupTiming();
+        // Publish the exposure phase statistics
+        void updateTimingStats();
 
         //#############################################################################
         // Callbacks
@@ -591,6 +608,81 @@ class ToupBase : public INDI::CCD
         };
 
 
+        // On-camera Dark & Flat Field Correction
+        ISwitchVectorProperty CalibrationSP;
+        ISwitch CalibrationS[2];
+        enum
+        {
+            TC_DARK_CORRECTION,
+            TC_FLAT_CORRECTION,
+        };
+
+        ISwitchVectorProperty CalibrationCaptureSP;
+        ISwitch CalibrationCaptureS[2];
+        enum
+        {
+            TC_CAPTURE_DARK,
+            TC_CAPTURE_FLAT,
+        };
+
+        INumberVectorProperty CalibrationFramesNP;
+        INumber CalibrationFramesN[2];
+        enum
+        {
+            TC_DARK_FRAMES,
+            TC_FLAT_FRAMES,
+        };
+
+        // Frame Queue
+        INumberVectorProperty FrameQueueNP;
+        INumber FrameQueueN[1];
+        enum
+        {
+            TC_DEQUE_LENGTH,
+        };
+
+        ISwitchVectorProperty DDRDepthSP;
+        ISwitch DDRDepthS[3];
+        enum
+        {
+            TC_DDR_AUTO,
+            TC_DDR_ONE,
+            TC_DDR_FULL,
+        };
+
+        // Dropped Frames
+        INumberVectorProperty DroppedFramesNP;
+        INumber DroppedFramesN[1];
+
+        // Exposure Phase Timing
+        ISwitchVectorProperty TimingSP;
+        ISwitch TimingS[2];
+        enum
+        {
+            TC_TIMING_STATS,
+            TC_TIMING_TRACE,
+        };
+
+        ITextVectorProperty TimingTraceTP;
+        IText TimingTraceT[1] = {};
+
+        INumberVectorProperty TimingStatsNP;
+        INumber TimingStatsN[11];
+        enum
+        {
+            TC_TIMING_FRAMES,
+            TC_TIMING_ARM_MEAN,
+            TC_TIMING_ARM_MAX,
+            TC_TIMING_EXPOSURE_MEAN,
+            TC_TIMING_EXPOSURE_MAX,
+            TC_TIMING_DOWNLOAD_MEAN,
+            TC_TIMING_DOWNLOAD_MAX,
+            TC_TIMING_PROCESS_MEAN,
+            TC_TIMING_PROCESS_MAX,
+            TC_TIMING_COMPLETE_MEAN,
+            TC_TIMING_COMPLETE_MAX,
+        };
+
         // Firmware Info
         ITextVectorProperty FirmwareTP;
         IText FirmwareT[5] = {};
@@ -640,11 +732,17 @@ class ToupBase : public INDI::CCD
         bool m_hasDualGain { false };
         bool m_HasLowNoise { false };
         bool m_HasHeatUp { false };
+        bool m_HasDFC { false };
+        bool m_HasFFC { false };
+        bool m_HasDDR { false };
+        bool m_HasDroppedFrames { false };
 
         INDI::Timer m_CaptureTimeout;
         uint32_t m_CaptureTimeoutCounter {0};
         // Download estimation in ms after exposure duration finished.
         double m_DownloadEstimation {5000};
+        // Exposure phase timing
+        ExposureTiming m_Timing;
 
         uint8_t m_BitsPerPixel { 8 };
         uint8_t m_RawBitsPerPixel { 8 };
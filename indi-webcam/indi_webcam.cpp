@@ -22,6 +22,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 */
 
+#include <algorithm>
 #include <zlib.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -39,6 +40,51 @@ extern "C" {
 
 #include "config.h"
 
+#ifdef __linux__
+#include <linux/videodev2.h>
+
+//The capture device name for our own Video4Linux2 backend
+static const char *V4L2_NATIVE_DEVICE = "V4L2 Native";
+//Number of driver buffers in the capture ring
+#define V4L2_BUFFER_COUNT 4
+
+//These are the V4L2 formats we can convert without a decoder, and what FFMpeg calls them
+static AVPixelFormat v4l2ToAVPixelFormat(uint32_t fourcc)
+{
+    switch(fourcc)
+    {
+        case V4L2_PIX_FMT_YUYV:
+            return AV_PIX_FMT_YUYV422;
+        case V4L2_PIX_FMT_UYVY:
+            return AV_PIX_FMT_UYVY422;
+        case V4L2_PIX_FMT_GREY:
+            return AV_PIX_FMT_GRAY8;
+        case V4L2_PIX_FMT_Y16:
+            return AV_PIX_FMT_GRAY16LE;
+        case V4L2_PIX_FMT_RGB24:
+            return AV_PIX_FMT_RGB24;
+        case V4L2_PIX_FMT_BGR24:
+            return AV_PIX_FMT_BGR24;
+        case V4L2_PIX_FMT_YUV420:
+            return AV_PIX_FMT_YUV420P;
+        case V4L2_PIX_FMT_NV12:
+            return AV_PIX_FMT_NV12;
+        default:
+            return AV_PIX_FMT_NONE;
+    }
+}
+
+static bool isV4L2Jpeg(uint32_t fourcc)
+{
+    return fourcc == V4L2_PIX_FMT_MJPEG || fourcc == V4L2_PIX_FMT_JPEG;
+}
+
+static bool isV4L2FormatSupported(uint32_t fourcc)
+{
+    return isV4L2Jpeg(fourcc) || v4l2ToAVPixelFormat(fourcc) != AV_PIX_FMT_NONE;
+}
+#endif
+
 static std::unique_ptr<indi_webcam> webcam(new indi_webcam());
 
 //Note this is how we get information about AVFoundation Devices
@@ -231,10 +277,12 @@ bool indi_webcam::ConnectToSource(std::string device, std::string source, int fr
     char stringFrameRate[16];
     snprintf(stringFrameRate,16,"%u",framerate);
     if(isConnected())
-    {
-        avcodec_close(pCodecCtx);
-        avformat_close_input(&pFormatCtx);
-    }
+        closeSource();
+
+#ifdef __linux__
+    if(device == V4L2_NATIVE_DEVICE)
+        return ConnectToV4L2Source(source, framerate, videosize);
+#endif
 
     AVDictionary* options = nullptr;
     av_dict_set(&options, "timeout", ffmpegTimeout.c_str(), 0); //Timeout for open_input and for read_frame.  VERY important.
@@ -328,6 +376,217 @@ bool indi_webcam::reconnectSource()
     return false;
 }
 
+#ifdef __linux__
+//This connects straight to a Video4Linux2 device instead of going through the FFMpeg demuxer.
+//Compressed formats are still decoded by FFMpeg, raw formats are converted straight from the driver's buffers.
+bool indi_webcam::ConnectToV4L2Source(std::string source, int framerate, std::string videosize)
+{
+    if(!v4l2.open(source))
+    {
+        DEBUGF(INDI::Logger::DBG_SESSION,"Failed to open source. Check your settings: %s", v4l2.lastError().c_str());
+        return false;
+    }
+
+    //Use the pixel format the user picked, otherwise prefer MJPEG, which gives most UVC cameras their full frame rate.
+    std::vector<V4L2Capture::Format> formats = v4l2.enumerateFormats();
+    const V4L2Capture::Format *format = nullptr;
+    for(const std::string &wanted : { v4l2PixelFormat, std::string("MJPG"), std::string("YUYV"), std::string("GREY") })
+    {
+        for(const V4L2Capture::Format &f : formats)
+        {
+            if(f.name == wanted && isV4L2FormatSupported(f.fourcc))
+            {
+                format = &f;
+                break;
+            }
+        }
+        if(format)
+            break;
+    }
+    for(const V4L2Capture::Format &f : formats)
+    {
+        if(format == nullptr && isV4L2FormatSupported(f.fourcc))
+            format = &f;
+    }
+    if(format == nullptr)
+    {
+        DEBUG(INDI::Logger::DBG_SESSION,"The device has no pixel format this driver can convert.");
+        v4l2.close();
+        return false;
+    }
+    v4l2PixelFormat = format->name;
+
+    unsigned int width = 640, height = 480;
+    sscanf(videosize.c_str(), "%ux%u", &width, &height);
+
+    for(const V4L2Capture::FrameSize &size : v4l2.enumerateFrameSizes(format->fourcc))
+    {
+        std::string rates;
+        for(double rate : v4l2.enumerateFrameRates(format->fourcc, size.width, size.height))
+        {
+            char text[16];
+            snprintf(text, 16, " %.4g", rate);
+            rates += text;
+        }
+        LOGF_DEBUG("%s supports %ux%u at%s fps", format->name.c_str(), size.width, size.height, rates.c_str());
+    }
+
+    if(!v4l2.setFormat(format->fourcc, width, height))
+    {
+        DEBUGF(INDI::Logger::DBG_SESSION,"Failed to set the video format: %s", v4l2.lastError().c_str());
+        v4l2.close();
+        return false;
+    }
+
+    double fps = framerate;
+    if(!v4l2.setFrameRate(fps))
+        LOGF_WARN("Could not set the frame rate: %s", v4l2.lastError().c_str());
+
+    //Set up the decoder for compressed input, for raw input only the geometry and pixel format are needed.
+    avcodec_free_context(&pCodecCtx);
+    if(isV4L2Jpeg(format->fourcc))
+    {
+        pCodec = avcodec_find_decoder(AV_CODEC_ID_MJPEG);
+        pCodecCtx = avcodec_alloc_context3(pCodec);
+        pCodecCtx->width = width;
+        pCodecCtx->height = height;
+        if(pCodec == nullptr || avcodec_open2(pCodecCtx, pCodec, &optionsDict) < 0)
+        {
+            DEBUG(INDI::Logger::DBG_SESSION,"Failed to open codec.");
+            v4l2.close();
+            return false;
+        }
+    }
+    else
+    {
+        pCodec = nullptr;
+        pCodecCtx = avcodec_alloc_context3(nullptr);
+        pCodecCtx->width = width;
+        pCodecCtx->height = height;
+        pCodecCtx->pix_fmt = v4l2ToAVPixelFormat(format->fourcc);
+    }
+
+    if(!v4l2.start(V4L2_BUFFER_COUNT))
+    {
+        DEBUGF(INDI::Logger::DBG_SESSION,"Failed to start capturing: %s", v4l2.lastError().c_str());
+        v4l2.close();
+        return false;
+    }
+
+    DEBUGF(INDI::Logger::DBG_SESSION, "Capturing %s (%s) at %ux%u and %.4g frames per second", format->name.c_str(),
+           format->description.c_str(), width, height, fps);
+
+    refreshPixelFormats(formats);
+
+    //Set the initial parameters for the CCD.
+    SetCCDParams(width, height, 8, 5, 5); //Note 5 microns is a guess!
+
+    return true;
+}
+
+//This offers the pixel formats of the connected device that we know how to convert.
+void indi_webcam::refreshPixelFormats(const std::vector<V4L2Capture::Format> &formats)
+{
+    deletePixelFormats();
+
+    int num = 0;
+    PixelFormats = new ISwitch[formats.size()];
+    for(const V4L2Capture::Format &f : formats)
+    {
+        if(!isV4L2FormatSupported(f.fourcc))
+            continue;
+        IUFillSwitch(&PixelFormats[num], f.name.c_str(), f.description.c_str(), f.name == v4l2PixelFormat ? ISS_ON : ISS_OFF);
+        num++;
+    }
+    IUFillSwitchVector(&PixelFormatSelection, PixelFormats, num, getDeviceName(), "CAPTURE_PIXEL_FORMAT", "Pixel Format",
+                       CONNECTION_TAB, IP_RW, ISR_1OFMANY, 60, IPS_OK);
+    defineProperty(&PixelFormatSelection);
+}
+
+void indi_webcam::deletePixelFormats()
+{
+    if(PixelFormats)
+    {
+        deleteProperty(PixelFormatSelection.name);
+        delete[] PixelFormats;
+        PixelFormats = nullptr;
+    }
+}
+
+//This gets one frame from the native V4L2 ring and converts it to our output format.
+//The driver buffer is handed back as soon as the conversion is done.
+bool indi_webcam::getV4L2Frame()
+{
+    V4L2Capture::Frame frame;
+    int timeoutMs = std::max(atoi(ffmpegTimeout.c_str()) / 1000, 1);
+    if(!v4l2.dequeue(frame, timeoutMs))
+    {
+        DEBUGF(INDI::Logger::DBG_SESSION, "V4L2 Error:%s, attempting to reconnect.", v4l2.lastError().c_str());
+        if(!reconnectSource())
+        {
+            DEBUG(INDI::Logger::DBG_SESSION, "Device did not reconnect after 10 tries.");
+            return false;
+        }
+        DEBUG(INDI::Logger::DBG_SESSION, "Device successfully reconnected.");
+        freeMemory();
+        //Try to set up streaming again, if there is an error, return
+        if(!setupStreaming())
+        {
+            DEBUG(INDI::Logger::DBG_SESSION, "Error on Stream Setup.");
+            return false;
+        }
+        if(!v4l2.dequeue(frame, timeoutMs))
+            return false;
+    }
+
+    bool rc = false;
+    if(pCodec)
+    {
+        //Compressed frames are decoded straight from the driver buffer.
+        AVPacket packet;
+        av_init_packet(&packet);
+        packet.data = frame.data;
+        packet.size = frame.bytesused;
+        if(avcodec_send_packet(pCodecCtx, &packet) >= 0 && avcodec_receive_frame(pCodecCtx, pFrame) >= 0)
+            rc = convertFrame(pFrame->data, pFrame->linesize, static_cast<AVPixelFormat>(pFrame->format));
+        else
+            DEBUG(INDI::Logger::DBG_SESSION, "Error during decoding");
+    }
+    else
+    {
+        //Raw frames are converted straight from the driver buffer, using the line length the driver reported.
+        uint8_t *data[4];
+        int linesize[4];
+        av_image_fill_linesizes(linesize, pCodecCtx->pix_fmt, pCodecCtx->width);
+        int packedLine = linesize[0];
+        if(packedLine > 0 && static_cast<int>(v4l2.getBytesPerLine()) > packedLine)
+        {
+            for(int i = 0; i < 4; i++)
+                linesize[i] = linesize[i] * v4l2.getBytesPerLine() / packedLine;
+        }
+        int size = av_image_fill_pointers(data, pCodecCtx->pix_fmt, pCodecCtx->height, frame.data, linesize);
+        if(size > 0 && frame.bytesused >= static_cast<uint32_t>(size))
+            rc = convertFrame(data, linesize, pCodecCtx->pix_fmt);
+        else
+            DEBUGF(INDI::Logger::DBG_SESSION, "Short frame of %u bytes dropped.", frame.bytesused);
+    }
+
+    v4l2.requeue(frame);
+    return rc;
+}
+
+bool indi_webcam::convertFrame(const uint8_t * const *data, const int *linesize, AVPixelFormat format)
+{
+    sws_ctx = sws_getCachedContext(sws_ctx, pCodecCtx->width, pCodecCtx->height, format,
+                                   pCodecCtx->width, pCodecCtx->height, out_pix_fmt, SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if(sws_ctx == nullptr)
+        return false;
+
+    sws_scale(sws_ctx, data, linesize, 0, pCodecCtx->height, pFrameOUT->data, pFrameOUT->linesize);
+    return true;
+}
+#endif
+
 //This is the method that should be called to change the streaming device, source, framerate, or video size
 //If it was already connected, it will attempt a connection with the new settings and if it is not successful, it will revert to the old ones.
 //It should be safe to use while streaming or between image captures because it will pause them and return them to normal afterwards.
@@ -442,16 +701,28 @@ bool indi_webcam::ChangeHTMLSource(std::string newIPAddress, std::string newPort
 bool indi_webcam::Disconnect()
 {
     if (isConnected()) {
-      // Close the codecs
-      avcodec_close(pCodecCtx);
+      closeSource();
+#ifdef __linux__
+      deletePixelFormats();
+#endif
 
-      // Close the video file
-      avformat_close_input(&pFormatCtx);
-      
       DEBUG(INDI::Logger::DBG_SESSION,"INDI Webcam disconnected successfully!");
     }
     return true;
 }
+
+//This closes whatever input is open, the FFMpeg one or the native V4L2 one.
+void indi_webcam::closeSource()
+{
+#ifdef __linux__
+    v4l2.close();
+#endif
+    // Close the codecs
+    avcodec_close(pCodecCtx);
+
+    // Close the video file
+    avformat_close_input(&pFormatCtx);
+}
 /**************************************************************************************
 ** INDI is asking us for our default device name
 ***************************************************************************************/
@@ -509,7 +780,14 @@ bool indi_webcam::refreshInputDevices()
     AVInputFormat * d=nullptr;
     int i =0;
     int numDevices = getNumOfInputDevices();
+#ifdef __linux__
+    //Our own V4L2 backend goes in the list like any FFMpeg input device
+    CaptureDevices = new ISwitch[numDevices + 2];
+    IUFillSwitch(&CaptureDevices[numDevices + 1], V4L2_NATIVE_DEVICE, V4L2_NATIVE_DEVICE,
+                 videoDevice == V4L2_NATIVE_DEVICE ? ISS_ON : ISS_OFF);
+#else
     CaptureDevices = new ISwitch[numDevices + 1];
+#endif
     while ((d = av_input_video_device_next(d))) {
         if(!strcmp(d->name, videoDevice.c_str()))
             IUFillSwitch(&CaptureDevices[i], d->name, d->name, ISS_ON);
@@ -518,6 +796,9 @@ bool indi_webcam::refreshInputDevices()
         i++;
     }
     IUFillSwitch(&CaptureDevices[numDevices], "IP Camera", "IP Camera", ISS_OFF);
+#ifdef __linux__
+    numDevices++;
+#endif
     IUFillSwitchVector(&CaptureDeviceSelection, CaptureDevices, numDevices + 1, getDeviceName(), "CAPTURE_DEVICE", "Capture Devices",
                        CONNECTION_TAB, IP_RW, ISR_ATMOST1, 60, IPS_IDLE);
     defineProperty(&CaptureDeviceSelection);
@@ -575,7 +856,13 @@ bool indi_webcam::refreshInputSources()
     {
         int nbdev=0;
         struct AVDeviceInfoList *devlist = nullptr;
-        AVInputFormat *iformat = av_find_input_format(videoDevice.c_str());
+        std::string listDevice = videoDevice;
+#ifdef __linux__
+        //The native backend opens the same /dev/video devices FFMpeg lists for video4linux2
+        if(videoDevice == V4L2_NATIVE_DEVICE)
+            listDevice = "video4linux2";
+#endif
+        AVInputFormat *iformat = av_find_input_format(listDevice.c_str());
         nbdev=avdevice_list_input_sources(iformat, nullptr, nullptr, &devlist);
 
         //For this case the source list function is not implemented, we have to just list them by number
@@ -824,6 +1111,47 @@ bool indi_webcam::ISNewSwitch (const char *dev, const char *name, ISState *state
         return false;
     }
 
+#ifdef __linux__
+    if (PixelFormats && !strcmp(name, PixelFormatSelection.name))
+    {
+        IUUpdateSwitch(&PixelFormatSelection, states, names, n);
+        ISwitch *sp = IUFindOnSwitch(&PixelFormatSelection);
+        if (sp)
+        {
+            //The property is rebuilt when we reconnect, so keep our own copy of the name.
+            std::string newFormat = sp->name;
+            std::string oldFormat = v4l2PixelFormat;
+            if(newFormat == oldFormat)
+            {
+                PixelFormatSelection.s = IPS_OK;
+                IDSetSwitch(&PixelFormatSelection, nullptr);
+                return true;
+            }
+
+            DEBUGF(INDI::Logger::DBG_SESSION, "Setting pixel format to: %s", newFormat.c_str());
+            bool was_streaming = is_streaming;
+            if(was_streaming)
+                StopStreaming();
+
+            v4l2PixelFormat = newFormat;
+            bool rc = ConnectToSource(videoDevice, videoSource, frameRate, videoSize, htmlSourceString);
+            if(!rc)
+            {
+                DEBUGF(INDI::Logger::DBG_SESSION, "Pixel format %s failed, changing back to %s", newFormat.c_str(), oldFormat.c_str());
+                v4l2PixelFormat = oldFormat;
+                ConnectToSource(videoDevice, videoSource, frameRate, videoSize, htmlSourceString);
+                PixelFormatSelection.s = IPS_ALERT;
+                IDSetSwitch(&PixelFormatSelection, nullptr);
+            }
+
+            if(was_streaming)
+                StartStreaming();
+            return rc;
+        }
+        return false;
+    }
+#endif
+
     if (!strcmp(svp->name, RapidStackingSelection.name))
     {
         IUUpdateSwitch(&RapidStackingSelection, states, names, n);
@@ -1449,12 +1777,17 @@ bool indi_webcam::setupStreaming()
               pCodecCtx->width, pCodecCtx->height, 1);
 
     // initialize SWS context for software scaling
-    sws_ctx = sws_getContext( pCodecCtx->width, pCodecCtx->height,
-                 pCodecCtx->pix_fmt, pCodecCtx->width, pCodecCtx->height,
-                 out_pix_fmt, SWS_BILINEAR, nullptr, nullptr, nullptr
-                 );
-    if(sws_ctx==nullptr)
-      return false;
+    // The native MJPEG input only knows its pixel format after the first frame is decoded,
+    // convertFrame() sets the context up then.
+    if(pCodecCtx->pix_fmt != AV_PIX_FMT_NONE)
+    {
+        sws_ctx = sws_getContext( pCodecCtx->width, pCodecCtx->height,
+                     pCodecCtx->pix_fmt, pCodecCtx->width, pCodecCtx->height,
+                     out_pix_fmt, SWS_BILINEAR, nullptr, nullptr, nullptr
+                     );
+        if(sws_ctx==nullptr)
+          return false;
+    }
 
     PrimaryCCD.setFrameBufferSize(numBytes);
     PrimaryCCD.setResolution(pCodecCtx->width, pCodecCtx->height);
@@ -1466,6 +1799,10 @@ bool indi_webcam::setupStreaming()
 //It is used for both the streaming and exposing algorithms
 bool indi_webcam::getStreamFrame()
 {
+#ifdef __linux__
+    if(v4l2.isOpen())
+        return getV4L2Frame();
+#endif
     AVPacket packet;
     //If at first you don't succees to get a frame, try again.
     int ret = -1;
@@ -1534,6 +1871,15 @@ bool indi_webcam::getStreamFrame()
 //That way we are sure to get the latest frames when exposing
 bool indi_webcam::flush_frame_buffer() {
 
+#ifdef __linux__
+    if(v4l2.isOpen())
+    {
+        //Everything waiting in the ring was taken before now, so just hand it all back to the driver.
+        DEBUGF(INDI::Logger::DBG_SESSION, "Buffer Cleared of %d stale frames.", v4l2.flush());
+        return true;
+    }
+#endif
+
     int packetReceiveTime = -1;
     //If the packet takes longer than this to receive, then it is probably not in the buffer.
     //So at that point we want to stop dumping the buffer.
@@ -1622,6 +1968,10 @@ bool indi_webcam::saveConfigItems(FILE *fp)
     IUSaveConfigText(fp, &HTTPInputOptionsP);
     IUSaveConfigText(fp, &InputOptionsTP);
     IUSaveConfigText(fp, &TimeoutOptionsTP);
+#ifdef __linux__
+    if(PixelFormats)
+        IUSaveConfigSwitch(fp, &PixelFormatSelection);
+#endif
 
 
     return true;
@@ -43,6 +43,10 @@ extern "C" {
 //#include <ctime>
 #include <thread>
 
+#ifdef __linux__
+#include "v4l2_capture.h"
+#endif
+
 //These are required to check for AVFoundation Devices
 //The reason is that we have to print and parse the output
 //These can't be in indi_webcam class declaration because the callback method has to be passed to FFMpeg
@@ -161,6 +165,20 @@ private:
     ITextVectorProperty TimeoutOptionsTP;
 
 
+#ifdef __linux__
+    //Native Video4Linux2 capture, used for the "V4L2 Native" device instead of the FFMpeg demuxer
+    V4L2Capture v4l2;
+    std::string v4l2PixelFormat;
+    bool ConnectToV4L2Source(std::string source, int framerate, std::string videosize);
+    bool getV4L2Frame();
+    bool convertFrame(const uint8_t * const *data, const int *linesize, AVPixelFormat format);
+    void refreshPixelFormats(const std::vector<V4L2Capture::Format> &formats);
+    void deletePixelFormats();
+    ISwitch *PixelFormats = nullptr;
+    ISwitchVectorProperty PixelFormatSelection {};
+#endif
+    void closeSource();
+
     //Webcam setup, release, and frame capture
     bool setupStreaming();
     void freeMemory();
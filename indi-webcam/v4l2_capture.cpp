@@ -0,0 +1,395 @@
+/*
+INDI Webcam CCD Driver - native Video4Linux2 capture
+
+Memory mapped V4L2 capture backend, used in place of FFmpeg for local
+video devices.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "v4l2_capture.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/videodev2.h>
+
+V4L2Capture::~V4L2Capture()
+{
+    close();
+}
+
+bool V4L2Capture::xioctl(unsigned long request, void *arg, const char *what)
+{
+    int r;
+    do
+    {
+        r = ioctl(fd, request, arg);
+    }
+    while (r == -1 && errno == EINTR);
+
+    if (r == -1)
+    {
+        error = std::string(what) + ": " + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool V4L2Capture::open(const std::string &device)
+{
+    close();
+
+    fd = ::open(device.c_str(), O_RDWR | O_NONBLOCK);
+    if (fd < 0)
+    {
+        error = "Cannot open " + device + ": " + strerror(errno);
+        return false;
+    }
+
+    struct v4l2_capability cap;
+    memset(&cap, 0, sizeof(cap));
+    if (!xioctl(VIDIOC_QUERYCAP, &cap, "VIDIOC_QUERYCAP"))
+    {
+        close();
+        return false;
+    }
+
+    uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING))
+    {
+        error = device + " is not a streaming video capture device";
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void V4L2Capture::close()
+{
+    if (fd < 0)
+        return;
+
+    stop();
+    ::close(fd);
+    fd = -1;
+}
+
+std::vector<V4L2Capture::Format> V4L2Capture::enumerateFormats()
+{
+    std::vector<Format> formats;
+    struct v4l2_fmtdesc desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    while (ioctl(fd, VIDIOC_ENUM_FMT, &desc) == 0)
+    {
+        Format format;
+        format.fourcc = desc.pixelformat;
+        format.name = fourccToString(desc.pixelformat);
+        format.description = reinterpret_cast<const char *>(desc.description);
+        format.compressed = desc.flags & V4L2_FMT_FLAG_COMPRESSED;
+        formats.push_back(format);
+        desc.index++;
+    }
+    return formats;
+}
+
+std::vector<V4L2Capture::FrameSize> V4L2Capture::enumerateFrameSizes(uint32_t fourcc)
+{
+    std::vector<FrameSize> sizes;
+    struct v4l2_frmsizeenum size;
+    memset(&size, 0, sizeof(size));
+    size.pixel_format = fourcc;
+
+    while (ioctl(fd, VIDIOC_ENUM_FRAMESIZES, &size) == 0)
+    {
+        if (size.type == V4L2_FRMSIZE_TYPE_DISCRETE)
+        {
+            sizes.push_back({ size.discrete.width, size.discrete.height });
+            size.index++;
+        }
+        else
+        {
+            //Stepwise and continuous ranges, report both ends of the range
+            sizes.push_back({ size.stepwise.min_width, size.stepwise.min_height });
+            sizes.push_back({ size.stepwise.max_width, size.stepwise.max_height });
+            break;
+        }
+    }
+    return sizes;
+}
+
+std::vector<double> V4L2Capture::enumerateFrameRates(uint32_t fourcc, uint32_t width, uint32_t height)
+{
+    std::vector<double> rates;
+    struct v4l2_frmivalenum interval;
+    memset(&interval, 0, sizeof(interval));
+    interval.pixel_format = fourcc;
+    interval.width = width;
+    interval.height = height;
+
+    while (ioctl(fd, VIDIOC_ENUM_FRAMEINTERVALS, &interval) == 0)
+    {
+        if (interval.type == V4L2_FRMIVAL_TYPE_DISCRETE)
+        {
+            if (interval.discrete.numerator)
+                rates.push_back(static_cast<double>(interval.discrete.denominator) / interval.discrete.numerator);
+            interval.index++;
+        }
+        else
+        {
+            //Stepwise and continuous ranges, report the fastest and the slowest rate
+            if (interval.stepwise.min.numerator)
+                rates.push_back(static_cast<double>(interval.stepwise.min.denominator) / interval.stepwise.min.numerator);
+            if (interval.stepwise.max.numerator)
+                rates.push_back(static_cast<double>(interval.stepwise.max.denominator) / interval.stepwise.max.numerator);
+            break;
+        }
+    }
+    return rates;
+}
+
+bool V4L2Capture::setFormat(uint32_t fourcc, uint32_t &width, uint32_t &height)
+{
+    struct v4l2_format fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.pixelformat = fourcc;
+    fmt.fmt.pix.width = width;
+    fmt.fmt.pix.height = height;
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+
+    if (!xioctl(VIDIOC_S_FMT, &fmt, "VIDIOC_S_FMT"))
+        return false;
+
+    if (fmt.fmt.pix.pixelformat != fourcc)
+    {
+        error = "Pixel format " + fourccToString(fourcc) + " was not accepted, the device chose " +
+                fourccToString(fmt.fmt.pix.pixelformat);
+        return false;
+    }
+
+    width = fmt.fmt.pix.width;
+    height = fmt.fmt.pix.height;
+    bytesPerLine = fmt.fmt.pix.bytesperline;
+    return true;
+}
+
+bool V4L2Capture::setFrameRate(double &fps)
+{
+    struct v4l2_streamparm parm;
+    memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    if (!xioctl(VIDIOC_G_PARM, &parm, "VIDIOC_G_PARM"))
+        return false;
+
+    //Not every driver lets us choose the frame interval, then we just run at whatever it gives us.
+    if (parm.parm.capture.capability & V4L2_CAP_TIMEPERFRAME)
+    {
+        parm.parm.capture.timeperframe.numerator = 1000;
+        parm.parm.capture.timeperframe.denominator = static_cast<uint32_t>(fps * 1000);
+        if (!xioctl(VIDIOC_S_PARM, &parm, "VIDIOC_S_PARM"))
+            return false;
+    }
+
+    if (parm.parm.capture.timeperframe.numerator)
+        fps = static_cast<double>(parm.parm.capture.timeperframe.denominator) / parm.parm.capture.timeperframe.numerator;
+    return true;
+}
+
+bool V4L2Capture::start(uint32_t bufferCount)
+{
+    stop();
+
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = bufferCount;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    if (!xioctl(VIDIOC_REQBUFS, &req, "VIDIOC_REQBUFS"))
+        return false;
+
+    if (req.count < 2)
+    {
+        error = "Not enough capture buffers available";
+        releaseBuffers();
+        return false;
+    }
+
+    for (uint32_t i = 0; i < req.count; i++)
+    {
+        struct v4l2_buffer buf;
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+
+        if (!xioctl(VIDIOC_QUERYBUF, &buf, "VIDIOC_QUERYBUF"))
+        {
+            releaseBuffers();
+            return false;
+        }
+
+        void *start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buf.m.offset);
+        if (start == MAP_FAILED)
+        {
+            error = std::string("mmap: ") + strerror(errno);
+            releaseBuffers();
+            return false;
+        }
+        buffers.push_back({ start, buf.length });
+
+        if (!xioctl(VIDIOC_QBUF, &buf, "VIDIOC_QBUF"))
+        {
+            releaseBuffers();
+            return false;
+        }
+    }
+
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (!xioctl(VIDIOC_STREAMON, &type, "VIDIOC_STREAMON"))
+    {
+        releaseBuffers();
+        return false;
+    }
+
+    streaming = true;
+    return true;
+}
+
+void V4L2Capture::stop()
+{
+    if (streaming)
+    {
+        enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(VIDIOC_STREAMOFF, &type, "VIDIOC_STREAMOFF");
+        streaming = false;
+    }
+    releaseBuffers();
+}
+
+void V4L2Capture::releaseBuffers()
+{
+    for (auto &buffer : buffers)
+        munmap(buffer.start, buffer.length);
+
+    if (!buffers.empty() && fd >= 0)
+    {
+        struct v4l2_requestbuffers req;
+        memset(&req, 0, sizeof(req));
+        req.count = 0;
+        req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        req.memory = V4L2_MEMORY_MMAP;
+        ioctl(fd, VIDIOC_REQBUFS, &req);
+    }
+    buffers.clear();
+}
+
+//Waits up to timeoutMs for a filled buffer. The frame points into the mapped driver buffer
+//and stays valid until it is given back with requeue().
+bool V4L2Capture::dequeue(Frame &frame, int timeoutMs)
+{
+    if (!streaming)
+    {
+        error = "Device is not streaming";
+        return false;
+    }
+
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    int r;
+    do
+    {
+        r = poll(&pfd, 1, timeoutMs);
+    }
+    while (r == -1 && errno == EINTR);
+
+    if (r == 0)
+    {
+        error = "Timed out waiting for a frame";
+        return false;
+    }
+    if (r < 0)
+    {
+        error = std::string("poll: ") + strerror(errno);
+        return false;
+    }
+
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+
+    if (!xioctl(VIDIOC_DQBUF, &buf, "VIDIOC_DQBUF"))
+        return false;
+
+    frame.data = static_cast<uint8_t *>(buffers[buf.index].start);
+    frame.bytesused = buf.bytesused;
+    frame.index = buf.index;
+    frame.timestamp = buf.timestamp;
+    return true;
+}
+
+bool V4L2Capture::requeue(const Frame &frame)
+{
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = frame.index;
+    return xioctl(VIDIOC_QBUF, &buf, "VIDIOC_QBUF");
+}
+
+//Hands every frame that is already waiting in the ring back to the driver, so the next
+//dequeue returns a frame taken after this call. Returns the number of frames dropped.
+int V4L2Capture::flush()
+{
+    int dropped = 0;
+    Frame frame;
+    while (dequeue(frame, 0))
+    {
+        requeue(frame);
+        dropped++;
+    }
+    return dropped;
+}
+
+std::string V4L2Capture::fourccToString(uint32_t fourcc)
+{
+    std::string name;
+    for (int i = 0; i < 4; i++)
+    {
+        char c = static_cast<char>((fourcc >> (8 * i)) & 0xFF);
+        if (c != ' ' && c != '\0')
+            name += c;
+    }
+    return name;
+}
+
+uint32_t V4L2Capture::stringToFourcc(const std::string &name)
+{
+    char c[4] = { ' ', ' ', ' ', ' ' };
+    for (size_t i = 0; i < 4 && i < name.size(); i++)
+        c[i] = name[i];
+    return v4l2_fourcc(c[0], c[1], c[2], c[3]);
+}
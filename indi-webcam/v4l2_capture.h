@@ -0,0 +1,105 @@
+/*
+INDI Webcam CCD Driver - native Video4Linux2 capture
+
+Memory mapped V4L2 capture backend, used in place of FFmpeg for local
+video devices.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef V4L2_CAPTURE_H
+#define V4L2_CAPTURE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+
+//This talks to a Video4Linux2 device directly instead of going through the FFMpeg demuxer.
+//Frames stay in a ring of driver buffers mapped into our memory, so they can be converted or
+//decoded straight from the kernel buffer and handed back to the driver afterwards.
+class V4L2Capture
+{
+public:
+    struct Format
+    {
+        uint32_t fourcc;
+        std::string name;           //The fourcc as text, i.e. "MJPG"
+        std::string description;    //What the driver calls it
+        bool compressed;
+    };
+
+    struct FrameSize
+    {
+        uint32_t width;
+        uint32_t height;
+    };
+
+    struct Frame
+    {
+        uint8_t *data { nullptr };
+        uint32_t bytesused { 0 };
+        uint32_t index { 0 };
+        struct timeval timestamp { 0, 0 };
+    };
+
+    V4L2Capture() = default;
+    ~V4L2Capture();
+
+    bool open(const std::string &device);
+    void close();
+    bool isOpen() const { return fd >= 0; }
+
+    //These ask the driver what it can do
+    std::vector<Format> enumerateFormats();
+    std::vector<FrameSize> enumerateFrameSizes(uint32_t fourcc);
+    std::vector<double> enumerateFrameRates(uint32_t fourcc, uint32_t width, uint32_t height);
+
+    //The driver may adjust the requested values, the ones actually used are returned
+    bool setFormat(uint32_t fourcc, uint32_t &width, uint32_t &height);
+    bool setFrameRate(double &fps);
+    uint32_t getBytesPerLine() const { return bytesPerLine; }
+
+    //Buffer ring handling
+    bool start(uint32_t bufferCount);
+    void stop();
+    bool dequeue(Frame &frame, int timeoutMs);
+    bool requeue(const Frame &frame);
+    int flush();
+
+    const std::string &lastError() const { return error; }
+
+    static std::string fourccToString(uint32_t fourcc);
+    static uint32_t stringToFourcc(const std::string &name);
+
+private:
+    bool xioctl(unsigned long request, void *arg, const char *what);
+    void releaseBuffers();
+
+    struct Buffer
+    {
+        void *start;
+        size_t length;
+    };
+
+    int fd { -1 };
+    bool streaming { false };
+    uint32_t bytesPerLine { 0 };
+    std::vector<Buffer> buffers;
+    std::string error;
+};
+
+#endif // V4L2_CAPTURE_H
@@ -306,6 +306,54 @@ void AltaEthernetIo::WriteReg( uint16_t reg, uint16_t val )
 
 }
 
+//////////////////////////// 
+// WRITE        REGS 
+void AltaEthernetIo::WriteRegs( const std::vector< std::pair<uint16_t,uint16_t> > & RegAndVal )
+{
+    //the FPGA cgi applies WR/WD pairs in order, so several
+    //registers can be written with a single request
+    std::string base = m_url + "/FPGA?";
+    std::string fullUrl = base;
+
+    std::vector< std::pair<uint16_t,uint16_t> >::const_iterator iter;
+
+    bool first = true;
+    int32_t count = 0;
+
+    for( iter = RegAndVal.begin(); iter != RegAndVal.end(); ++iter )
+    {
+        std::string vv = (first ? "WR=" : "&WR=") + help::uShort2Str( iter->first ) +
+            "&WD=" + help::uShort2Str( iter->second, true );
+        fullUrl.append( vv );
+        first = false;
+
+        if( MAX_WRITES_PER_URL-1 == count )
+        {
+            //send the max data
+            CLibCurlWrap theCurl;
+            std::string result;
+            theCurl.HttpGet( fullUrl, result );
+
+            //reset
+            count = 0;
+            fullUrl = base;
+            first = true;
+        }
+        else
+        {
+            ++count;
+        }
+    }
+
+    //send any remaining data
+    if( count )
+    {
+        CLibCurlWrap theCurl;
+        std::string result;
+        theCurl.HttpGet( fullUrl, result );
+    }
+}
+
 //////////////////////////// 
 // WRITE        MRMD 
 void AltaEthernetIo::WriteMRMD(const uint16_t reg, const std::vector<uint16_t> & data )
@@ -31,6 +31,8 @@ class AltaEthernetIo : public ICamIo, public IAltaSerialPortIo
         uint16_t ReadReg( uint16_t reg ) const;
 	    void WriteReg( uint16_t reg, uint16_t val ) ;
 
+        void WriteRegs( const std::vector< std::pair<uint16_t,uint16_t> > & RegAndVal );
+
         void WriteSRMD( uint16_t reg, const std::vector<uint16_t> & data );
 
         void WriteMRMD( uint16_t reg, const std::vector<uint16_t> & data );
@@ -1589,10 +1589,13 @@ void ApogeeCam::SetExpsoureTime( const double Duration )
         static_cast<uint32_t>( (Duration / m_CameraConsts->m_TimerResolution) ) + 
         m_CameraConsts->m_TimerOffsetCount;
 
+    //both halves go out together
+    CameraIo::RegTransaction trans( *m_CamIo );
     const uint16_t ExpTimeLow = (ExpTime & 0xFFFF);
     WriteReg( CameraRegs::TIMER_LOWER, ExpTimeLow);
     const uint16_t ExpTimeHigh = ( (ExpTime >> 16) & 0xFFFF);
     WriteReg( CameraRegs::TIMER_UPPER, ExpTimeHigh);
+    trans.Commit();
 }
 
 //////////////////////////// 
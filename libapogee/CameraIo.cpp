@@ -24,6 +24,7 @@ CameraIo::CameraIo(CamModel::InterfaceType type )
     :  m_type(type)
     , m_RegMirror( new CamRegMirror() )
     , m_fileName(__FILE__)
+    , m_TransactionDepth( 0 )
 {
 
 }
@@ -54,6 +55,8 @@ void CameraIo::ClearAllRegisters()
     {
         m_RegMirror->Write( (*iter), 0);
     }
+
+    m_MirrorCurrent.clear();
 }
 
 
@@ -68,6 +71,8 @@ uint16_t CameraIo::ReadMirrorReg( uint16_t reg ) const
 // READ     REG 
 uint16_t CameraIo::ReadReg( uint16_t reg ) const
 {
+    //queued writes must land before the camera is read back
+    FlushPendingWrites();
     return m_Interface->ReadReg( reg );
 }
 
@@ -76,20 +81,48 @@ uint16_t CameraIo::ReadReg( uint16_t reg ) const
 void CameraIo::WriteReg( uint16_t reg, 
             uint16_t val )
 {
-    m_Interface->WriteReg( reg, val );
+    if( IsCommandReg( reg ) )
+    {
+        //commands are strobes, never skip or queue them
+        FlushPendingWrites();
+        m_Interface->WriteReg( reg, val );
+        m_RegMirror->Write( reg, val );
+        return;
+    }
+
+    //the camera already holds this value
+    if( IsMirrorCurrent( reg ) && m_RegMirror->Read( reg ) == val )
+    {
+        return;
+    }
+
+    if( m_TransactionDepth > 0 )
+    {
+        m_PendingWrites.push_back( std::pair<uint16_t,uint16_t>( reg, val ) );
+    }
+    else
+    {
+        m_Interface->WriteReg( reg, val );
+    }
+
     m_RegMirror->Write( reg, val );
+    m_MirrorCurrent.insert( reg );
 }
 
 //////////////////////////// 
 // WRITE        REG 
 void CameraIo::WriteReg( const std::vector< std::pair<uint16_t,uint16_t> > & RegAndVal )
 {
+    RegTransaction trans( *this );
+
     std::vector< std::pair<uint16_t,uint16_t> >::const_iterator it;
 
     for(it = RegAndVal.begin(); it != RegAndVal .end(); ++it)
     {
         WriteReg( it->first, it->second );
     }
+
+    trans.Commit();
 }
 
 ///////////////////////////////////////
@@ -97,7 +130,7 @@ void CameraIo::WriteReg( const std::vector< std::pair<uint16_t,uint16_t> > & Reg
 void CameraIo::ReadOrWriteReg(const uint16_t reg, 
                               const uint16_t val2Or)
 {
-    uint16_t val = ReadReg(reg);
+    uint16_t val = IsMirrorCurrent(reg) ? ReadMirrorReg(reg) : ReadReg(reg);
 
     val |= val2Or;
 
@@ -109,13 +142,124 @@ void CameraIo::ReadOrWriteReg(const uint16_t reg,
 void CameraIo::ReadAndWriteReg(const uint16_t reg, 
                                const uint16_t val2And)
 {
-    uint16_t val = ReadReg(reg);
+    uint16_t val = IsMirrorCurrent(reg) ? ReadMirrorReg(reg) : ReadReg(reg);
 
     val &= val2And;
 
     WriteReg(reg, val);
 }
 
+///////////////////////////////////////
+// IS     COMMAND       REG
+bool CameraIo::IsCommandReg( const uint16_t reg )
+{
+    switch( reg )
+    {
+        case CameraRegs::CMD_A:
+        case CameraRegs::CMD_B:
+        case CameraRegs::SCRATCH:
+        case CameraRegs::HRAM_INPUT:
+        case CameraRegs::VRAM_INPUT:
+        case CameraRegs::HCLAMP_INPUT:
+        case CameraRegs::HSKIP_INPUT:
+        case CameraRegs::AD_CONFIG_DATA:
+        case CameraRegs::IO_PORT_DATA_WRITE:
+            return true;
+
+        default:
+            //read only status block
+            return reg >= CameraRegs::IO_PORT_DATA_READ;
+    }
+}
+
+///////////////////////////////////////
+// IS     MIRROR       CURRENT
+bool CameraIo::IsMirrorCurrent( const uint16_t reg ) const
+{
+    return m_MirrorCurrent.count( reg ) != 0;
+}
+
+///////////////////////////////////////
+// FLUSH     PENDING       WRITES
+void CameraIo::FlushPendingWrites() const
+{
+    if( m_PendingWrites.empty() )
+    {
+        return;
+    }
+
+    std::vector< std::pair<uint16_t,uint16_t> > writes;
+    writes.swap( m_PendingWrites );
+
+    try
+    {
+        m_Interface->WriteRegs( writes );
+    }
+    catch( std::exception & )
+    {
+        //no telling how far the camera got, stop trusting the mirror for these
+        std::vector< std::pair<uint16_t,uint16_t> >::const_iterator it;
+        for(it = writes.begin(); it != writes.end(); ++it)
+        {
+            m_MirrorCurrent.erase( it->first );
+        }
+        throw;
+    }
+}
+
+///////////////////////////////////////
+// DROP     PENDING       WRITES
+void CameraIo::DropPendingWrites()
+{
+    //the mirror already holds the dropped values, so it no longer
+    //reflects the camera for those registers
+    std::vector< std::pair<uint16_t,uint16_t> >::const_iterator it;
+    for(it = m_PendingWrites.begin(); it != m_PendingWrites.end(); ++it)
+    {
+        m_MirrorCurrent.erase( it->first );
+    }
+
+    m_PendingWrites.clear();
+}
+
+///////////////////////////////////////
+// REG      TRANSACTION
+CameraIo::RegTransaction::RegTransaction( CameraIo & io )
+    : m_Io( io )
+    , m_Done( false )
+{
+    ++m_Io.m_TransactionDepth;
+}
+
+CameraIo::RegTransaction::~RegTransaction()
+{
+    if( m_Done )
+    {
+        return;
+    }
+
+    //left without commit, most likely unwinding an exception
+    if( 0 == --m_Io.m_TransactionDepth )
+    {
+        m_Io.DropPendingWrites();
+    }
+}
+
+void CameraIo::RegTransaction::Commit()
+{
+    if( m_Done )
+    {
+        return;
+    }
+
+    m_Done = true;
+
+    if( 0 == --m_Io.m_TransactionDepth )
+    {
+        m_Io.FlushPendingWrites();
+    }
+}
+
 ///////////////////////////////////////
 // READ     MIRROR       OR      WRITE       REG
 void CameraIo::ReadMirrorOrWriteReg(const uint16_t reg, 
@@ -145,7 +289,9 @@ void CameraIo::ReadMirrorAndWriteReg(const uint16_t reg,
 void CameraIo::WriteSRMD( uint16_t reg, 
                          const std::vector<uint16_t> & data )
 {
+    FlushPendingWrites();
     m_Interface->WriteSRMD(reg, data);
+    m_MirrorCurrent.erase( reg );
 }
 
 //////////////////////////// 
@@ -153,7 +299,13 @@ void CameraIo::WriteSRMD( uint16_t reg,
 void CameraIo::WriteMRMD( uint16_t reg, 
                          const std::vector<uint16_t> & data )
 {
+    FlushPendingWrites();
     m_Interface->WriteMRMD(reg, data);
+
+    for( size_t offset = 0; offset < data.size(); ++offset )
+    {
+        m_MirrorCurrent.erase( static_cast<uint16_t>(reg + offset) );
+    }
 }
 
 //////////////////////////// 
@@ -191,6 +343,7 @@ void CameraIo::SetupImgXfer(const uint16_t Rows,
     }
 
    
+     FlushPendingWrites();
      m_Interface->SetupImgXfer( Rows, Cols, NumOfImages, IsBulkSeq );
 }
 
@@ -214,6 +367,7 @@ void CameraIo::GetImageData( std::vector<uint16_t> & data )
 
     try
     {
+       FlushPendingWrites();
        m_Interface->GetImageData( data );
     }
     catch( std::exception & err )
@@ -237,6 +391,7 @@ void CameraIo::GetImageData( std::vector<uint16_t> & data )
 // GET  STATUS
 void CameraIo::GetStatus(CameraStatusRegs::BasicStatus & status)
 {
+    FlushPendingWrites();
     m_Interface->GetStatus( status );
 }
 
@@ -244,6 +399,7 @@ void CameraIo::GetStatus(CameraStatusRegs::BasicStatus & status)
 // GET  STATUS
 void CameraIo::GetStatus(CameraStatusRegs::AdvStatus & status)
 {
+    FlushPendingWrites();
     m_Interface->GetStatus( status );
 }
 
@@ -348,6 +504,10 @@ void CameraIo::Reset(const bool Flush)
         WriteReg( CameraRegs::SCRATCH, 0x8086 );
 	    WriteReg( CameraRegs::SCRATCH, 0x8088 );
     }
+
+    //do not assume the settings survived the reset, the next
+    //write or read-modify-write of each register goes to the camera
+    m_MirrorCurrent.clear();
 }
 
 
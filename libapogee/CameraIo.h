@@ -16,6 +16,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include "CameraStatusRegs.h"
 #include "CamCfgMatrix.h"
 #include "CameraInfo.h" 
@@ -30,6 +31,25 @@ class CamRegMirror;
 class DLL_EXPORT CameraIo 
 { 
     public: 
+        /*! 
+        * Coalesces the register writes issued while it is open.  Writes are
+        * queued and sent with as few interface transactions as possible when
+        * Commit() is called or a hardware read needs them.  If the scope is
+        * left without Commit(), e.g. on an exception, queued writes are dropped.
+        */
+        class DLL_EXPORT RegTransaction
+        {
+            public:
+                explicit RegTransaction( CameraIo & io );
+                ~RegTransaction();
+
+                void Commit();
+
+            private:
+                CameraIo & m_Io;
+                bool m_Done;
+        };
+
        CameraIo( CamModel::InterfaceType type );
 
         virtual ~CameraIo(); 
@@ -110,8 +130,19 @@ class DLL_EXPORT CameraIo
         std::shared_ptr<CamRegMirror> m_RegMirror;
 
     private:
+        static bool IsCommandReg( uint16_t reg );
+        bool IsMirrorCurrent( uint16_t reg ) const;
+        void FlushPendingWrites() const;
+        void DropPendingWrites();
+
         std::string m_fileName;
 
+        //registers whose mirror value is known to match the camera, i.e. written
+        //by us since the last reset.  command, fifo and status registers never are.
+        mutable std::set<uint16_t> m_MirrorCurrent;
+        mutable std::vector< std::pair<uint16_t,uint16_t> > m_PendingWrites;
+        int32_t m_TransactionDepth;
+
 }; 
 
 namespace InterfaceHelper
@@ -22,3 +22,15 @@ ICamIo::~ICamIo()
 { 
 
 }
+
+//////////////////////////// 
+// WRITE        REGS 
+void ICamIo::WriteRegs( const std::vector< std::pair<uint16_t,uint16_t> > & RegAndVal )
+{
+    std::vector< std::pair<uint16_t,uint16_t> >::const_iterator it;
+
+    for(it = RegAndVal.begin(); it != RegAndVal.end(); ++it)
+    {
+        WriteReg( it->first, it->second );
+    }
+}
@@ -13,7 +13,7 @@
 
 #include <string>
 #include <vector>
-#include <vector>
+#include <utility>
 #include <stdint.h>
 
 #include <memory>
@@ -63,6 +63,14 @@ class ICamIo
          */
 	    virtual void WriteReg( uint16_t reg, uint16_t val ) = 0;
 
+         /*!
+         *  Writes a list of control registers in order.  The default implementation
+         *  issues one WriteReg per entry; interfaces that can carry several writes in
+         *  one request override this to reduce the number of transactions.
+         * \param[in] RegAndVal Register and value pairs, written in order
+         */
+        virtual void WriteRegs( const std::vector< std::pair<uint16_t,uint16_t> > & RegAndVal );
+
         /*!
          *  Writes data to a Single Request Multiple Data (SRMD) controller on the camera
          * \param[in] reg Register to write to.
@@ -114,7 +114,8 @@ static struct option const longopts[] = {
 
 int save_buffer(pslr_handle_t camhandle, int bufno, int fd, pslr_status *status, user_file_format filefmt, int jpeg_stars) {
     pslr_buffer_type imagetype;
-    uint8_t buf[65536];
+    uint8_t *buf;
+    uint32_t blksz;
     uint32_t length;
     uint32_t current;
 
@@ -136,9 +137,16 @@ int save_buffer(pslr_handle_t camhandle, int bufno, int fd, pslr_status *status,
     DPRINT("Buffer length: %d\n", length);
     current = 0;
 
+    blksz = pslr_get_download_block_size(camhandle);
+    buf = malloc(blksz);
+    if (!buf) {
+        pslr_buffer_close(camhandle);
+        return 1;
+    }
+
     while (true) {
         uint32_t bytes;
-        bytes = pslr_buffer_read(camhandle, buf, sizeof (buf));
+        bytes = pslr_buffer_read(camhandle, buf, blksz);
         if (bytes == 0) {
             break;
         }
@@ -152,21 +160,29 @@ int save_buffer(pslr_handle_t camhandle, int bufno, int fd, pslr_status *status,
         }
         current += bytes;
     }
+    free(buf);
     pslr_buffer_close(camhandle);
     return 0;
 }
 
 void save_memory(pslr_handle_t camhandle, int fd, uint32_t length) {
-    uint8_t buf[65536];
+    uint8_t *buf;
+    uint32_t blksz;
     uint32_t current;
 
     DPRINT("save memory %d\n", length);
 
+    blksz = pslr_get_download_block_size(camhandle);
+    buf = malloc(blksz);
+    if (!buf) {
+        return;
+    }
+
     current = 0;
 
     while (current<length) {
         uint32_t bytes;
-        int readsize=length-current>65536 ? 65536 : length-current;
+        uint32_t readsize=length-current>blksz ? blksz : length-current;
         bytes = pslr_fullmemory_read(camhandle, buf, current, readsize);
         if (bytes == 0) {
             break;
@@ -181,6 +197,7 @@ void save_memory(pslr_handle_t camhandle, int fd, uint32_t length) {
         }
         current += bytes;
     }
+    free(buf);
 }
 
 
@@ -54,8 +54,9 @@
 
 
 #define POLL_INTERVAL 50000 /* Number of us to wait when polling */
-#define BLKSZ 65536 /* Block size for downloads; if too big, we get
-                     * memory allocation error from sg driver */
+#define BLKSZ 65536 /* Default and minimum block size for downloads; if too
+                     * big, we get memory allocation error from sg driver */
+#define BLKSZ_MAX (1024*1024) /* Largest block we negotiate with newer cameras */
 #define BLOCK_RETRY 3 /* Number of retries, since we can occasionally
                        * get SCSI errors when downloading data */
 
@@ -81,6 +82,7 @@ static int ipslr_buffer_segment_info(ipslr_handle_t *p, pslr_buffer_segment_info
 static int ipslr_next_segment(ipslr_handle_t *p);
 static int ipslr_download(ipslr_handle_t *p, uint32_t addr, uint32_t length, uint8_t *buf);
 static int ipslr_identify(ipslr_handle_t *p);
+static void ipslr_negotiate_block_size(ipslr_handle_t *p);
 static int _ipslr_write_args(uint8_t cmd_2, ipslr_handle_t *p, int n, ...);
 #define ipslr_write_args(p,n,...) _ipslr_write_args(0,(p),(n),__VA_ARGS__)
 #define ipslr_write_args_special(p,n,...) _ipslr_write_args(4,(p),(n),__VA_ARGS__)
@@ -428,6 +430,7 @@ int pslr_connect(pslr_handle_t h) {
         DPRINT("\nUnknown Pentax camera.\n");
         return -1;
     }
+    ipslr_negotiate_block_size(p);
     CHECK(ipslr_status_full(p, &p->status));
     DPRINT("\tinit bufmask=0x%x\n", p->status.bufmask);
     if ( !p->model->old_scsi_command ) {
@@ -665,7 +668,8 @@ int pslr_get_buffer(pslr_handle_t h, int bufno, pslr_buffer_type type, int resol
 
     uint32_t bufpos = 0;
     while (true) {
-        uint32_t nextread = size - bufpos > 65536 ? 65536 : size - bufpos;
+        uint32_t blksz = pslr_get_download_block_size(h);
+        uint32_t nextread = size - bufpos > blksz ? blksz : size - bufpos;
         if (nextread == 0) {
             break;
         }
@@ -1089,8 +1093,8 @@ uint32_t pslr_buffer_read(pslr_handle_t h, uint8_t *buf, uint32_t size) {
     if (blksz > p->segments[i].length - seg_offs) {
         blksz = p->segments[i].length - seg_offs;
     }
-    if (blksz > BLKSZ) {
-        blksz = BLKSZ;
+    if (blksz > pslr_get_download_block_size(h)) {
+        blksz = pslr_get_download_block_size(h);
     }
 
 //    DPRINT("File offset %d segment: %d offset %d address 0x%x read size %d\n", p->offset,
@@ -1117,6 +1121,11 @@ uint32_t pslr_fullmemory_read(pslr_handle_t h, uint8_t *buf, uint32_t offset, ui
     return size;
 }
 
+uint32_t pslr_get_download_block_size(pslr_handle_t h) {
+    ipslr_handle_t *p = (ipslr_handle_t *) h;
+    return p->download_blksz ? p->download_blksz : BLKSZ;
+}
+
 uint32_t pslr_buffer_get_size(pslr_handle_t h) {
     ipslr_handle_t *p = (ipslr_handle_t *) h;
     uint32_t i;
@@ -1431,11 +1440,13 @@ static int ipslr_download(ipslr_handle_t *p, uint32_t addr, uint32_t length, uin
     int n;
     int retry;
     uint32_t length_start = length;
+    bool settle_each_block = !p->model || p->model->old_scsi_command;
 
     retry = 0;
     while (length > 0) {
-        if (length > BLKSZ) {
-            block = BLKSZ;
+        uint32_t blksz = pslr_get_download_block_size(p);
+        if (length > blksz) {
+            block = blksz;
         } else {
             block = length;
         }
@@ -1446,15 +1457,29 @@ static int ipslr_download(ipslr_handle_t *p, uint32_t addr, uint32_t length, uin
         get_status(p->fd);
 
         n = scsi_read(p->fd, downloadCmd, sizeof (downloadCmd), buf, block);
-        get_status(p->fd);
 
         if (n < 0) {
+            /* Drain the status of the failed transfer before trying again */
+            get_status(p->fd);
+            if (blksz > BLKSZ) {
+                /* The transport refused the larger transfer; fall back towards
+                 * the known-good block size, without spending a retry */
+                p->download_blksz = blksz / 2 > BLKSZ ? blksz / 2 : BLKSZ;
+                DPRINT("\tdownload block size reduced to %u\n", p->download_blksz);
+                continue;
+            }
             if (retry < BLOCK_RETRY) {
                 retry++;
                 continue;
             }
             return PSLR_READ_ERROR;
         }
+        /* The *ist bodies take their arguments one by one without a status
+         * wait, so settle them after every block; newer bodies wait before the
+         * next read anyway and only need it once the download is done */
+        if (settle_each_block) {
+            get_status(p->fd);
+        }
         buf += n;
         length -= n;
         addr += n;
@@ -1463,9 +1488,26 @@ static int ipslr_download(ipslr_handle_t *p, uint32_t addr, uint32_t length, uin
             progress_callback(length_start - length, length_start);
         }
     }
+    if (!settle_each_block) {
+        get_status(p->fd);
+    }
     return PSLR_OK;
 }
 
+static void ipslr_negotiate_block_size(ipslr_handle_t *p) {
+    uint32_t granted = 0;
+
+    /* The *ist bodies are only known to cope with the historical block size */
+    if (!p->model->old_scsi_command) {
+#ifndef LIBGPHOTO2
+        granted = scsi_max_transfer(p->fd, BLKSZ_MAX);
+#endif
+    }
+    granted &= ~(uint32_t) 511;
+    p->download_blksz = granted > BLKSZ ? granted : BLKSZ;
+    DPRINT("\tdownload block size: %u\n", p->download_blksz);
+}
+
 static int ipslr_identify(ipslr_handle_t *p) {
     DPRINT("[C]\t\tipslr_identify()\n");
     uint8_t idbuf[8];
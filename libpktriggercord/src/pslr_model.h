@@ -188,6 +188,7 @@ struct ipslr_handle {
     ipslr_segment_t segments[MAX_SEGMENTS];
     uint32_t segment_count;
     uint32_t offset;
+    uint32_t download_blksz;                         // negotiated download block size, 0 until connected
     uint8_t status_buffer[MAX_STATUS_BUF_SIZE];
     uint8_t settings_buffer[SETTINGS_BUFFER_SIZE];
 };
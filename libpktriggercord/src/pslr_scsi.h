@@ -89,4 +89,10 @@ pslr_result get_drive_info(char* drive_name, FDTYPE* device,
                            char* product_id, int product_id_size_max);
 
 void close_drive(FDTYPE *device);
+
+#ifndef LIBGPHOTO2
+/* Largest single data-in transfer the transport accepts, capped at 'wanted'.
+ * Returns 0 if the backend cannot tell. */
+uint32_t scsi_max_transfer(FDTYPE sg_fd, uint32_t wanted);
+#endif
 #endif
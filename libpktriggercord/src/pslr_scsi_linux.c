@@ -176,6 +176,21 @@ void close_drive(int *device) {
     close( *device );
 }
 
+uint32_t scsi_max_transfer(int sg_fd, uint32_t wanted) {
+    int size = (int) wanted;
+
+    /* Ask for a reserved buffer big enough for one block; the sg driver and the
+     * block layer both clamp it to what the host adapter can do in one go */
+    if (ioctl(sg_fd, SG_SET_RESERVED_SIZE, &size) == -1) {
+        DPRINT("\tSG_SET_RESERVED_SIZE(%u) failed\n", wanted);
+    }
+    if (ioctl(sg_fd, SG_GET_RESERVED_SIZE, &size) == -1 || size <= 0) {
+        return 0;
+    }
+    DPRINT("\tSG reserved size: %d\n", size);
+    return (uint32_t) size < wanted ? (uint32_t) size : wanted;
+}
+
 int scsi_read(int sg_fd, uint8_t *cmd, uint32_t cmdLen,
               uint8_t *buf, uint32_t bufLen) {
     sg_io_hdr_t io;
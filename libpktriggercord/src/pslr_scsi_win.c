@@ -153,6 +153,13 @@ void close_drive(int *device) {
     CloseHandle((HANDLE)*device);
 }
 
+uint32_t scsi_max_transfer(int sg_fd, uint32_t wanted) {
+    (void) sg_fd;
+    (void) wanted;
+    /* scsi_read bounces through a fixed 64k buffer */
+    return 64*1024;
+}
+
 int scsi_read(int sg_fd, uint8_t *cmd, uint32_t cmdLen,
               uint8_t *buf, uint32_t bufLen) {
     SCSI_PASS_THROUGH_WITH_BUFFER sptdwb;
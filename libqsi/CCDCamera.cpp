@@ -3721,6 +3721,24 @@ int CCCDCamera::get_MaskPixels(bool* pVal)
 	return S_OK;
 }
 
+int CCCDCamera::put_MaskPixelsMedian(bool newVal)
+{
+	if (!m_bIsConnected)
+		return Error ( "Not Connected", IID_ICamera, MAKE_HRESULT(1,FACILITY_ITF, QSI_NOTCONNECTED) );
+
+	m_QSIInterface.m_hpmMap.m_bMedian = newVal;
+	m_QSIInterface.m_hpmMap.Save();
+	return S_OK;
+}
+
+int CCCDCamera::get_MaskPixelsMedian(bool* pVal)
+{
+	if (!m_bIsConnected)
+		return Error ( "Not Connected", IID_ICamera, MAKE_HRESULT(1,FACILITY_ITF, QSI_NOTCONNECTED) );
+	*pVal = m_QSIInterface.m_hpmMap.m_bMedian;
+	return S_OK;
+}
+
 int CCCDCamera::put_PixelMask(std::vector<Pixel> pixels)
 {
 	if (!m_bIsConnected)
@@ -174,6 +174,11 @@ int HostIO_TCP::OpenEx(CameraID cID)
 
 	ioctl(m_sock, FIONBIO, &IO_BLOCK);
 	SetTimeouts(m_IOTimeouts.StandardRead, m_IOTimeouts.StandardWrite);
+
+	// Command packets are a few bytes and wait for a response, don't let Nagle hold them back
+	int NoDelay = 1;
+	if (setsockopt(m_sock, IPPROTO_TCP, TCP_NODELAY, (char *)&NoDelay, sizeof(NoDelay)) < 0)
+		m_log->Write(2, _T("TCP/IP: setsockopt TCP_NODELAY failed."));
 	m_log->Write(2, _T("TCP/IP: connect() is OK.") );
 	
 	return 0;
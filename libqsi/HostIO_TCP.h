@@ -9,6 +9,8 @@
 #else
     #include <sys/socket.h>
 	#include <sys/ioctl.h>
+	#include <netinet/in.h>
+	#include <netinet/tcp.h>
 #endif
 
 class HostIO_TCP : public IHostIO
@@ -16,12 +16,15 @@ DRC 03.23.11 Original Version
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <algorithm>
 
 #define REGMAPROOT _T("SOFTWARE/QSI/Map/")
 
 HotPixelMap::HotPixelMap(void)
 {
 	m_bEnable = false;
+	m_bMedian = false;
+	IndexValid = false;
 }
 
 HotPixelMap::HotPixelMap(std::string Serial)
@@ -33,6 +36,7 @@ HotPixelMap::HotPixelMap(std::string Serial)
 	QSI_Registry reg;
 
 	this->serial = Serial;
+	IndexValid = false;
 	std::string Root = std::string(REGMAPROOT);
 	Root += Serial;
 	Root += _T("/");
@@ -41,6 +45,11 @@ HotPixelMap::HotPixelMap(std::string Serial)
 	lResult = reg.RegQueryValueEx(Root, _T("Enable"), 0, 0, &dwEnable, dSize);
 	m_bEnable = (lResult == 0 && dwEnable != 0) ? true:false;
 
+	int dwMedian = 0;
+	dSize = 4;
+	lResult = reg.RegQueryValueEx(Root, _T("Median"), 0, 0, &dwMedian, dSize);
+	m_bMedian = (lResult == 0 && dwMedian != 0) ? true:false;
+
 	if ( m_bEnable )
 	{
 		dSize = 4;
@@ -83,6 +92,7 @@ bool HotPixelMap::Save(void)
 	reg.RegDelnode (Root);
 
 	reg.SetNumber(Root, std::string(_T("Enable")), m_bEnable?1:0);
+	reg.SetNumber(Root, std::string(_T("Median")), m_bMedian?1:0);
 	for (vi = HotMap.begin(); vi != HotMap.end(); vi++)
 	{
 		std::stringstream cnv;
@@ -102,72 +112,123 @@ bool HotPixelMap::Save(void)
 void HotPixelMap::Remap(	BYTE * Image, int RowPad, QSI_ExposureSettings Exposure,
 							QSI_DeviceDetails Details, USHORT ZeroPixel, QSILog * log)
 {
-	int pIndex;
-	std::vector<Pixel>::iterator vi;
+	std::vector<Target>::iterator ti;
 
 	if (!m_bEnable)
 		return;
-	log->Write(2, _T("Hot Pixel Remap enabled."));
 
-	for (vi = HotMap.begin(); vi != HotMap.end(); vi++)
-	{
-		log->Write(2, _T("Remap pixel: x=%d, y=%d"), (*vi).x, (*vi).y);
+	if (!IndexMatches(RowPad, Exposure, Details))
+		BuildIndex(RowPad, Exposure, Details, log);
 
-		if (FindTargetPixelIndex(*vi, RowPad, Exposure, Details, log, &pIndex))
-		{
-			log->Write(2, _T("Remap pixel: x=%d, y=%d, old value: %d, new value: %d."),
-							(*vi).x, (*vi).y, *(USHORT*)(&Image[pIndex]), ZeroPixel); 
-			*(USHORT*)(&Image[pIndex]) = ZeroPixel;
-		}
+	if (m_bMedian)
+	{
+		// Defects never feed a median, so the order of replacement does not matter
+		for (ti = Targets.begin(); ti != Targets.end(); ti++)
+			*(USHORT*)(&Image[(*ti).index]) = NeighbourMedian(Image, *ti, ZeroPixel);
 	}
+	else
+	{
+		for (ti = Targets.begin(); ti != Targets.end(); ti++)
+			*(USHORT*)(&Image[(*ti).index]) = ZeroPixel;
+	}
+
+	log->Write(2, _T("Hot Pixel Remap: %d pixels replaced with %s."), (int)Targets.size(),
+					m_bMedian ? _T("neighbour median") : _T("zero level"));
 }
 
-bool HotPixelMap::FindTargetPixelIndex(	Pixel pxIn, int RowPad, QSI_ExposureSettings Exposure,
-										QSI_DeviceDetails Details, QSILog * log, int * pIndex)
+bool HotPixelMap::IndexMatches(int RowPad, QSI_ExposureSettings & Exposure, QSI_DeviceDetails & Details)
 {
-	int iStartX;
-	int iStartY;
-	int iSizeX;
-	int iSizeY;
-	int iBinnedLocX;
-	int iBinnedLocY;
-	int iRowLen;
-	static const int BYTESPERPIXEL = 2;
+	return	IndexValid &&
+			IndexRowPad == RowPad &&
+			IndexArrayColumns == Details.ArrayColumns &&
+			IndexArrayRows == Details.ArrayRows &&
+			IndexExposure.ColumnOffset == Exposure.ColumnOffset &&
+			IndexExposure.RowOffset == Exposure.RowOffset &&
+			IndexExposure.ColumnsToRead == Exposure.ColumnsToRead &&
+			IndexExposure.RowsToRead == Exposure.RowsToRead &&
+			IndexExposure.BinFactorX == Exposure.BinFactorX &&
+			IndexExposure.BinFactorY == Exposure.BinFactorY;
+}
 
-	// Is the requested remap pixel in the array range of the camera?
-	if (pxIn.x >= Details.ArrayColumns || pxIn.y >= Details.ArrayRows)
-	{
-		log->Write(2, _T("Remap pixel: x=%d, y=%d not in CCD imager area."), pxIn.x, pxIn.y);
-		return false;
-	}
+void HotPixelMap::BuildIndex(int RowPad, QSI_ExposureSettings & Exposure, QSI_DeviceDetails & Details, QSILog * log)
+{
+	static const int BYTESPERPIXEL = 2;
+	std::vector<Pixel>::iterator vi;
 
-	// Un-Bin the parameters of the image and check if this pixel is in the requested frame
-	iStartX = Exposure.ColumnOffset * Exposure.BinFactorX;
-	iStartY = Exposure.RowOffset * Exposure.BinFactorY;
-	iSizeX =  Exposure.ColumnsToRead * Exposure.BinFactorX;
-	iSizeY =  Exposure.RowsToRead * Exposure.BinFactorY;
+	// Un-Bin the parameters of the image
+	int iStartX = Exposure.ColumnOffset * Exposure.BinFactorX;
+	int iStartY = Exposure.RowOffset * Exposure.BinFactorY;
+	int iSizeX =  Exposure.ColumnsToRead * Exposure.BinFactorX;
+	int iSizeY =  Exposure.RowsToRead * Exposure.BinFactorY;
 	// RowLen and RowPad in bytes (for CCDSoft padding)
-	// The "Row length in bytes" is Exposure.ColumnsToRead number of columns times two
-	iRowLen =  Exposure.ColumnsToRead * BYTESPERPIXEL; 
+	int iRowLen =  Exposure.ColumnsToRead * BYTESPERPIXEL;
+
+	Targets.clear();
+	SortedIndex.clear();
 
-	// Is the remapped pixel in the target area?
-	if (pxIn.x >= iStartX && pxIn.x < iStartX + iSizeX &&
-		pxIn.y >= iStartY && pxIn.y < iStartY + iSizeY )
+	for (vi = HotMap.begin(); vi != HotMap.end(); vi++)
 	{
-		// Hit on remap
-		// Now cal the binned pixel index of the hot pixel
-		iBinnedLocX = (pxIn.x / Exposure.BinFactorX) - Exposure.ColumnOffset;
-		iBinnedLocY = (pxIn.y / Exposure.BinFactorY) - Exposure.RowOffset;
-		// Calc image array index in bytes, caller will use that to replace pixel
-		*pIndex = (iBinnedLocX * BYTESPERPIXEL) + ((iRowLen + RowPad) * iBinnedLocY);
-		log->Write(2, _T("Remap pixel: x=%d, y=%d at image index: %d"), pxIn.x, pxIn.y, *pIndex);
-		return true;
+		// Skip pixels outside the imager or the requested frame
+		if ((*vi).x >= Details.ArrayColumns || (*vi).y >= Details.ArrayRows)
+			continue;
+		if ((*vi).x < iStartX || (*vi).x >= iStartX + iSizeX ||
+			(*vi).y < iStartY || (*vi).y >= iStartY + iSizeY)
+			continue;
+
+		Target target;
+		target.x = ((*vi).x / Exposure.BinFactorX) - Exposure.ColumnOffset;
+		target.y = ((*vi).y / Exposure.BinFactorY) - Exposure.RowOffset;
+		target.index = (target.x * BYTESPERPIXEL) + ((iRowLen + RowPad) * target.y);
+		Targets.push_back(target);
+		SortedIndex.push_back(target.index);
 	}
-	else
+
+	// Binning folds several defects into one pixel
+	std::sort(SortedIndex.begin(), SortedIndex.end());
+	SortedIndex.erase(std::unique(SortedIndex.begin(), SortedIndex.end()), SortedIndex.end());
+	std::sort(Targets.begin(), Targets.end(), [](const Target & a, const Target & b) { return a.index < b.index; });
+	Targets.erase(std::unique(Targets.begin(), Targets.end(), [](const Target & a, const Target & b) { return a.index == b.index; }),
+				  Targets.end());
+
+	IndexValid = true;
+	IndexRowPad = RowPad;
+	IndexRowLen = iRowLen;
+	IndexExposure = Exposure;
+	IndexArrayColumns = Details.ArrayColumns;
+	IndexArrayRows = Details.ArrayRows;
+
+	log->Write(2, _T("Hot Pixel Remap index built: %d of %d pixels in frame."), (int)Targets.size(), (int)HotMap.size());
+}
+
+USHORT HotPixelMap::NeighbourMedian(BYTE * Image, const Target & target, USHORT ZeroPixel)
+{
+	static const int BYTESPERPIXEL = 2;
+	USHORT values[8];
+	int count = 0;
+	int stride = IndexRowLen + IndexRowPad;
+
+	for (int dy = -1; dy <= 1; dy++)
 	{
-		log->Write(2, _T("Remap pixel: x=%d, y=%d not in image area."), pxIn.x, pxIn.y);
-		return false;
+		for (int dx = -1; dx <= 1; dx++)
+		{
+			int x = target.x + dx;
+			int y = target.y + dy;
+			if ((dx == 0 && dy == 0) || x < 0 || y < 0 || x >= IndexExposure.ColumnsToRead || y >= IndexExposure.RowsToRead)
+				continue;
+
+			int index = target.index + dx * BYTESPERPIXEL + dy * stride;
+			if (std::binary_search(SortedIndex.begin(), SortedIndex.end(), index))
+				continue;
+
+			values[count++] = *(USHORT*)(&Image[index]);
+		}
 	}
+
+	if (count == 0)
+		return ZeroPixel;
+
+	std::nth_element(values, values + count / 2, values + count);
+	return values[count / 2];
 }
 
 std::vector<Pixel> HotPixelMap::GetPixels(void)
@@ -178,4 +239,5 @@ std::vector<Pixel> HotPixelMap::GetPixels(void)
 void HotPixelMap::SetPixels(std::vector<Pixel> map)
 {
 	this->HotMap = map;
+	IndexValid = false;
 }
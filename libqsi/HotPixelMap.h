@@ -35,10 +35,30 @@ public:
 	std::vector<Pixel> GetPixels(void);
 	void SetPixels(std::vector<Pixel> map);
 	bool m_bEnable;
+	// Replace with the median of the good neighbours instead of the zero level
+	bool m_bMedian;
 private:
-	bool FindTargetPixelIndex(	Pixel pxIn, int RowPad, QSI_ExposureSettings Exposure, QSI_DeviceDetails Details, QSILog * log, int * pIndex);
+	// Remap target in the binned image, index in bytes
+	struct Target
+	{
+		int index;
+		int x;
+		int y;
+	};
+	bool IndexMatches(int RowPad, QSI_ExposureSettings & Exposure, QSI_DeviceDetails & Details);
+	void BuildIndex(int RowPad, QSI_ExposureSettings & Exposure, QSI_DeviceDetails & Details, QSILog * log);
+	USHORT NeighbourMedian(BYTE * Image, const Target & target, USHORT ZeroPixel);
 	std::vector<Pixel> HotMap;
 	std::string serial;
+	// Remap index, rebuilt when the exposure geometry or the map changes
+	std::vector<Target> Targets;
+	std::vector<int> SortedIndex;
+	bool IndexValid;
+	int IndexRowPad;
+	int IndexRowLen;
+	QSI_ExposureSettings IndexExposure;
+	int IndexArrayColumns;
+	int IndexArrayRows;
 };
 
 #endif
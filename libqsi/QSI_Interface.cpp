@@ -31,6 +31,7 @@ QSI_Interface::QSI_Interface ( void )
 	m_bColorProfiling = false;
 	m_bTestBayerImage = false;
 	m_bCameraStateCacheInvalid = true;
+	m_bTemperatureCacheValid = false;
 	//
 	m_bAutoZeroEnable = true;
 	m_dwAutoZeroSatThreshold = AUTOZEROSATTHRESHOLD;
@@ -263,6 +264,9 @@ int QSI_Interface::OpenCamera( CameraID cID )
 	m_log->TestForLogging();
 	m_log->Write(2, "OpenCamera by CameraID number started.");
 	
+	m_PacketWrapper.PKT_Reset();
+	m_bTemperatureCacheValid = false;
+
 	iError = m_HostCon.Open( cID );
 	if (iError != 0)
 		return iError;	
@@ -334,6 +338,8 @@ int QSI_Interface::CloseCamera ( void )
 	m_log->Write(2, "CloseCamera started");
 
 	iError = m_HostCon.Close();
+	m_PacketWrapper.PKT_Reset();
+	m_bTemperatureCacheValid = false;
 	m_log->Write(2, "CloseCamera completed. Error Code: %x", m_iError);
 
 	return iError;
@@ -393,6 +399,7 @@ int  QSI_Interface::ReadImageByRow(PVOID pvRxBuffer, int iRowsRequested, int iCo
 int QSI_Interface::CMD_InitCamera ( void )
 {
 	m_log->Write(2, "InitCamera started.");
+	m_bTemperatureCacheValid = false;
 
 	if (m_HostCon.m_HostIO == NULL)
 	{
@@ -1083,6 +1090,9 @@ int QSI_Interface::CMD_SetTemperature ( bool bCoolerOn, bool bGoToAmbient, doubl
 	PutBool(&Cmd_Pkt[CMD_GotoAmbient], bGoToAmbient);
 	Put2Bytes(&Cmd_Pkt[CMD_SetPoint],  (short) (dSetPoint * 100) );
 
+	// Cooler state changes, don't serve it from the cache
+	m_bTemperatureCacheValid = false;
+
 	// Send/receive packets
 	m_iError = m_PacketWrapper.PKT_SendPacket(m_HostCon.m_HostIO, Cmd_Pkt, Rsp_Pkt, true);
 	if( m_iError )
@@ -1118,6 +1128,7 @@ int QSI_Interface::CMD_GetTemperature ( int & iCoolerState, double & dCoolerTemp
 	const int RSP_TempAmbient  = 5;
 	const int RSP_CoolerPower  = 7;
 	const int RSP_DeviceError  = 9;
+
 	m_log->Write(2, "GetTemperature started");
 
 	if (m_HostCon.m_HostIO == NULL)
@@ -1125,7 +1136,22 @@ int QSI_Interface::CMD_GetTemperature ( int & iCoolerState, double & dCoolerTemp
 		m_log->Write(2, _T("NULL m_HostIO pointer"));
 		return ERR_PKT_NoConnection;
 	}
-	
+
+	if (m_bTemperatureCacheValid)
+	{
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		long elapsed = (now.tv_sec - m_tvTemperatureCache.tv_sec) * 1000L + (now.tv_usec - m_tvTemperatureCache.tv_usec) / 1000L;
+		if (elapsed >= 0 && elapsed < STATUSCACHEMS)
+		{
+			iCoolerState  = m_iCachedCoolerState;
+			dCoolerTemp   = m_dCachedCoolerTemp;
+			dTempAmbient  = m_dCachedTempAmbient;
+			usCoolerPower = m_usCachedCoolerPower;
+			return ALL_OK;
+		}
+	}
+
 	// Construct transmit packet header
 	Cmd_Pkt[CMD_Command] = CMD_GETTEMPERATURE;
 	Cmd_Pkt[CMD_Length]  = 0;
@@ -1168,6 +1194,13 @@ int QSI_Interface::CMD_GetTemperature ( int & iCoolerState, double & dCoolerTemp
 	dTempAmbient  = (short) Get2Bytes(&Rsp_Pkt[RSP_TempAmbient]) / 100.0;
 	usCoolerPower = (short) ( Get2Bytes(&Rsp_Pkt[RSP_CoolerPower]) / 100.0 );
 	m_log->Write(2, "GetTemperature completed OK. Cooler power: %d, Temp: %f Camera Body Temp: %f", usCoolerPower, dCoolerTemp, dTempAmbient);
+
+	m_iCachedCoolerState  = iCoolerState;
+	m_dCachedCoolerTemp   = dCoolerTemp;
+	m_dCachedTempAmbient  = dTempAmbient;
+	m_usCachedCoolerPower = usCoolerPower;
+	gettimeofday(&m_tvTemperatureCache, NULL);
+	m_bTemperatureCacheValid = true;
 	return ALL_OK;
 }
 
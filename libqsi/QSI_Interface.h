@@ -44,8 +44,10 @@ REVISION HISTORY
  *****************************************************************************************/
 
 #include <unistd.h>
+#include <sys/time.h>
 
 #define INTERFACERETRYMS 2500
+#define STATUSCACHEMS 250		// Temperature, cooler state and power are served from one response for this long
 // AltMode1 bits
 #define EXPOSUREPULSEOUTBIT 0x01
 #define MANUALSHUTTERMODE 0x02
@@ -159,6 +161,14 @@ public:
 	QSI_CCDSpecs m_CCDSpecs;
 	QSI_AdvSettings m_CameraAdvSettingsCache;	// Remember what is set on the camera.	
 private:
+	// Last GetTemperature response, callers polling several of its values share one round trip
+	bool m_bTemperatureCacheValid;
+	struct timeval m_tvTemperatureCache;
+	int m_iCachedCoolerState;
+	double m_dCachedCoolerTemp;
+	double m_dCachedTempAmbient;
+	USHORT m_usCachedCoolerPower;
+
 	////////////////////////////////////////////////////////////////////////////////////////
 	// Private methods and variables
 	int CMD_GetCCDSpecs( QSI_CCDSpecs & CCDSpecs);
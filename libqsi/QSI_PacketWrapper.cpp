@@ -20,6 +20,7 @@ QSI_PacketWrapper::QSI_PacketWrapper()
 {
 	m_log = new QSILog(_T("QSIINTERFACELOG.TXT"), _T("LOGUSBTOFILE"), _T("PACKET"));
 	m_iStatus = 0;
+	m_bQueuesUnknown = true;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -28,6 +29,12 @@ QSI_PacketWrapper::~QSI_PacketWrapper()
 	delete m_log;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+void QSI_PacketWrapper::PKT_Reset( void )
+{
+	m_bQueuesUnknown = true;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 int QSI_PacketWrapper::PKT_CheckQueues( IHostIO * con )
 {
@@ -79,10 +86,16 @@ int QSI_PacketWrapper::PKT_SendPacket( IHostIO * con, unsigned char * pvTxBuffer
 		dwBytesInPacket = 0,    // Holds # of bytes to read for Rx packet
 		dwBytesReturned = 0;  // Holds # of bytes read of Rx packet
 
-	// Make sure we're starting with clean queues
-	m_iStatus = PKT_CheckQueues(con);
-	if (m_iStatus != ALL_OK) 
-		goto SendPacketExit;
+	// Make sure we're starting with clean queues.
+	// A clean request/response exchange leaves them clean, so only check after
+	// errors or commands that stream data after their response.
+	if (m_bQueuesUnknown)
+	{
+		m_iStatus = PKT_CheckQueues(con);
+		if (m_iStatus != ALL_OK)
+			goto SendPacketExit;
+	}
+	m_bQueuesUnknown = true;
   
 	// Get command and length from Tx packet
 	ucTxCommand = *(ucTxBuffer+PKT_COMMAND);
@@ -165,21 +178,17 @@ int QSI_PacketWrapper::PKT_SendPacket( IHostIO * con, unsigned char * pvTxBuffer
 	m_log->WriteBuffer(2, ucRxBuffer, dwBytesReturned, dwBytesReturned, 256);
 	m_log->Write(2, _T("***Packet Response Read Done.***"));
 
-	// Make sure queues are clean
+	// The response was read exactly as framed, so the queues are known to be clean.
 	//
-	// if the read image command doesn't happen fast enough, or if the camera is very fast
-	// returning from a transfer image or AutoZero request, this could throw an error.
-	// This should only be done at points where the camera should be idle.
-	// To avoid a race condition with the camera this can only be done on all commands except 
-	// TransferImage and AutoZero.
+	// TransferImage and AutoZero (bPostCheckQueues false) stream data after their response,
+	// the queues cannot be checked until the camera is idle again. Leave them unknown
+	// so the next command checks them before it is sent.
 	//
-	// This is implemented in those routines in QSI_Interface by setting bPostCheckQueues false 
+	// Any error above also leaves them unknown, dirty queues are only drained on that path.
 	//
 
 	if (bPostCheckQueues)
-	{
-		m_iStatus = PKT_CheckQueues(con);
-	}
+		m_bQueuesUnknown = false;
 
 	// Common Exit routine to insure IOTimeouts get reset on errors.
 SendPacketExit:
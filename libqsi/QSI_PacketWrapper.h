@@ -27,8 +27,10 @@ public:
     int PKT_SendPacket(IHostIO *connection, unsigned char * pTBuffer , unsigned char * pRxBuffer, 
                        bool bCheckQueues, IOTimeout ioTimout = IOTimeout_Normal);
     int PKT_CheckQueues(IHostIO *connection);  // Returns number of characters in Rx & Tx queues
+    void PKT_Reset(void);                      // New connection, check the queues before the first exchange
 
 private:
     int m_iStatus;          // Stores last status received
+    bool m_bQueuesUnknown;  // Last exchange failed or may have left data behind, check before the next one
 	QSILog * m_log;
 };
@@ -0,0 +1,70 @@
+//
+// qsiremapbench.cpp
+//
+// Times the hot pixel remap of a full frame image against a synthetic
+// defect map, for both the zero level and the neighbour median replacement.
+//
+#include "HotPixelMap.h"
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <sys/time.h>
+
+static double	gettime() {
+	struct timeval	tv;
+	gettimeofday(&tv, NULL);
+	double	t = tv.tv_sec;
+	t += tv.tv_usec * 0.000001;
+	return t;
+}
+
+static void	bench(HotPixelMap & map, const char * name, int width, int height, int bin, int frames, QSILog * log) {
+	QSI_ExposureSettings	exposure;
+	QSI_DeviceDetails	details;
+	details.ArrayColumns = width;
+	details.ArrayRows = height;
+	exposure.BinFactorX = bin;
+	exposure.BinFactorY = bin;
+	exposure.ColumnsToRead = width / bin;
+	exposure.RowsToRead = height / bin;
+
+	std::vector<USHORT>	image(exposure.ColumnsToRead * exposure.RowsToRead, 1000);
+
+	double	start = gettime();
+	for (int i = 0; i < frames; i++)
+		map.Remap((BYTE *)image.data(), 0, exposure, details, 0, log);
+	double	elapsed = gettime() - start;
+
+	std::cout << name << " " << bin << "x" << bin << ": "
+		<< (elapsed * 1000.0 / frames) << " ms per frame" << std::endl;
+}
+
+int	main(int argc, char *argv[]) {
+	int	width = 4096;
+	int	height = 4096;
+	int	defects = (argc > 1) ? atoi(argv[1]) : 10000;
+	int	frames = (argc > 2) ? atoi(argv[2]) : 100;
+
+	srand(1);
+	std::vector<Pixel>	pixels;
+	for (int i = 0; i < defects; i++)
+		pixels.push_back(Pixel(rand() % width, rand() % height));
+
+	QSILog	log("QSIBENCHLOG.TXT", "LOGBENCHTOFILE", "BENCH");
+
+	HotPixelMap	map;
+	map.SetPixels(pixels);
+	map.m_bEnable = true;
+
+	std::cout << defects << " defects on " << width << "x" << height
+		<< ", " << frames << " frames" << std::endl;
+
+	for (int bin = 1; bin <= 2; bin++) {
+		map.m_bMedian = false;
+		bench(map, "zero level", width, height, bin, frames, &log);
+		map.m_bMedian = true;
+		bench(map, "median    ", width, height, bin, frames, &log);
+	}
+	return 0;
+}
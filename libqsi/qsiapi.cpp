@@ -609,6 +609,16 @@ int QSICamera::get_MaskPixels(bool* pVal)
 	return ((CCCDCamera*)pCam)->get_MaskPixels(pVal);
 }
 
+int QSICamera::put_MaskPixelsMedian(bool newVal)
+{
+	return ((CCCDCamera *)pCam)->put_MaskPixelsMedian( newVal );
+}
+
+int QSICamera::get_MaskPixelsMedian(bool* pVal)
+{
+	return ((CCCDCamera*)pCam)->get_MaskPixelsMedian(pVal);
+}
+
 int QSICamera::put_PixelMask(std::vector<Pixel> pixels )
 {
 	return ((CCCDCamera *)pCam)->put_PixelMask( pixels );
@@ -277,6 +277,8 @@ public:
 	int get_CanSetGain(bool* pVal);
 	int put_MaskPixels(bool newVal);
 	int get_MaskPixels(bool* pVal);
+	int put_MaskPixelsMedian(bool newVal);
+	int get_MaskPixelsMedian(bool* pVal);
 	int put_PixelMask(std::vector<Pixel> pixels);
 	int get_PixelMask(std::vector<Pixel> *pixels);
 	int get_FilterPositionTrim( std::vector<short> * pVal);